@@ -0,0 +1,62 @@
+#include <APDS9960_ColorSensor.h>
+#include <EEPROM.h>
+// Create an instance of the color sensor
+ADPS9960_ColorSensor sensor;
+
+// EEPROM layout: the whole calibration state is a single blob at address 0
+const int CALIBRATION_ADDRESS = 0;
+
+void setup() {
+    // Initialize serial communication at 115200 baud rate
+    Serial.begin(115200);
+
+    // Initialize the APDS9960 sensor
+    sensor.begin();
+    Serial.println("APDS9960 ready!");
+
+    // ESP32/ESP8266 need EEPROM.begin(size); AVR boards do not
+    EEPROM.begin(sizeof(ADPS9960_ColorSensor::CalibrationBlob));
+
+    // Try to restore profiles saved by a previous run
+    ADPS9960_ColorSensor::CalibrationBlob blob;
+    EEPROM.get(CALIBRATION_ADDRESS, blob);
+    if (sensor.importCalibration(blob)) {
+        Serial.print("Restored profiles: ");
+        Serial.println(sensor.getProfileCount());
+        return;
+    }
+
+    // First run: calibrate one profile per illuminant
+    Serial.println("Daylight: point sensor at white reference...");
+    delay(3000);
+    sensor.calibrate();
+    sensor.saveProfile("DAYLIGHT");
+
+    Serial.println("Switch to LED lighting, point at white reference...");
+    delay(10000);
+    sensor.calibrate();
+    sensor.saveProfile("LED_NIGHT");
+
+    // Persist everything in one write
+    sensor.exportCalibration(blob);
+    EEPROM.put(CALIBRATION_ADDRESS, blob);
+    EEPROM.commit(); // ESP32/ESP8266 only, remove on AVR
+    Serial.println("Profiles saved!");
+}
+
+void loop() {
+    // Send 'd' or 'n' over serial to switch manually (O(1), no sensor access)
+    if (Serial.available()) {
+        char command = Serial.read();
+        if (command == 'd') sensor.selectProfile("DAYLIGHT");
+        if (command == 'n') sensor.selectProfile("LED_NIGHT");
+        if (command == 'a') sensor.autoSelectProfile(); // Needs the white reference in view
+    }
+
+    Serial.print("Profile: ");
+    Serial.print(sensor.getProfileName(sensor.getActiveProfile()));
+    Serial.print(" | Color: ");
+    Serial.println(sensor.getColorHexString());
+
+    delay(1000);
+}
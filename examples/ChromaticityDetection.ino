@@ -0,0 +1,47 @@
+#include <APDS9960_ColorSensor.h>
+// Create an instance of the color sensor
+ADPS9960_ColorSensor sensor;
+
+void setup() {
+    // Initialize serial communication at 115200 baud rate
+    Serial.begin(115200);
+
+    // Initialize the APDS9960 sensor
+    sensor.begin();
+    Serial.println("APDS9960 ready!");
+    delay(1000);
+
+    // Perform sensor calibration
+    // Point sensor at a white surface during calibration for best results
+    if (!sensor.calibrate())
+        Serial.println("Error during calibration!");
+    Serial.println("Calibration completed!");
+    delay(1000);
+}
+
+void loop() {
+    // Read brightness-independent coordinates (fixed point, 4096 = 1.0)
+    // A white surface reads about 1365/1365/1365 at any light level
+    ADPS9960_ColorSensor::Chromaticity chroma{};
+    if (sensor.readChromaticity(chroma)) {
+        Serial.println("=== Chromaticity Reading ===");
+        Serial.print("r: ");
+        Serial.println(chroma.r);
+        Serial.print("g: ");
+        Serial.println(chroma.g);
+        Serial.print("b: ");
+        Serial.println(chroma.b);
+        Serial.print("Intensity: ");
+        Serial.println(chroma.intensity);
+    }
+
+    // Compare classic HSV detection with illumination-invariant detection
+    // Dim the light or cast a shadow: only the chromaticity result stays put
+    Serial.print("HSV detection:          ");
+    Serial.println(getStandardColorName(sensor.detectColor()));
+    Serial.print("Chromaticity detection: ");
+    Serial.println(getStandardColorName(sensor.detectColorChromaticity()));
+    Serial.println("============================");
+
+    delay(1000);
+}
@@ -0,0 +1,55 @@
+#include <APDS9960_ColorSensor.h>
+#include <APDS9960_ChromaticityTracker.h>
+// Create an instance of the color sensor and of the tracker
+ADPS9960_ColorSensor sensor;
+ChromaticityTracker tracker;
+
+// Samples between the integration and the reject gate (latency to compensate)
+const uint8_t GATE_DELAY_SAMPLES = 2;
+
+void setup() {
+    // Initialize serial communication at 115200 baud rate
+    Serial.begin(115200);
+
+    // Initialize the APDS9960 sensor
+    sensor.begin();
+    Serial.println("APDS9960 ready!");
+    delay(1000);
+
+    // Perform sensor calibration
+    // Point sensor at a white surface during calibration for best results
+    if (!sensor.calibrate())
+        Serial.println("Error during calibration!");
+
+    // Measure the sensor noise on a still target and derive the gains from it
+    // 5 = expected change of the color's rate of change per sample (4096 = 1.0)
+    tracker.calibrateNoise(sensor, 5.0f);
+    Serial.print("Noise: ");
+    Serial.print(tracker.getMeasurementNoise());
+    Serial.print(" | alpha: ");
+    Serial.print(tracker.getAlpha(), 3);
+    Serial.print(" | beta: ");
+    Serial.println(tracker.getBeta(), 3);
+}
+
+void loop() {
+    // Feed one sample per integration period (constant rate)
+    ADPS9960_ColorSensor::Chromaticity chroma{};
+    if (sensor.readChromaticity(chroma)) {
+        tracker.update(chroma);
+    }
+
+    // Filtered value now, and extrapolated to when the part reaches the gate
+    ADPS9960_ColorSensor::Chromaticity now{}, atGate{};
+    tracker.getEstimate(now);
+    tracker.predict(atGate, GATE_DELAY_SAMPLES);
+
+    Serial.print("measured r: ");
+    Serial.print(chroma.r);
+    Serial.print(" | filtered r: ");
+    Serial.print(now.r);
+    Serial.print(" | at gate r: ");
+    Serial.println(atGate.r);
+
+    delay(sensor.getIntegrationTimeUs() / 1000 + 1);
+}
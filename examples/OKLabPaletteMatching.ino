@@ -0,0 +1,66 @@
+#include <APDS9960_ColorSensor.h>
+// Create an instance of the color sensor
+ADPS9960_ColorSensor sensor;
+
+// Product palette defined with web colors (sRGB), converted to OKLab in setup()
+const uint32_t paletteHex[] = {0xC8102E, 0xFFB81C, 0x00843D, 0x0033A0, 0xF2F2F2};
+const char* paletteNames[] = {"Signal red", "Amber", "Racing green", "Royal blue", "Off white"};
+const uint8_t PALETTE_SIZE = 5;
+ADPS9960_ColorSensor::OKLab palette[PALETTE_SIZE];
+
+void setup() {
+    // Initialize serial communication at 115200 baud rate
+    Serial.begin(115200);
+
+    // Initialize the APDS9960 sensor
+    sensor.begin();
+    Serial.println("APDS9960 ready!");
+    delay(1000);
+
+    // Perform sensor calibration
+    // Point sensor at a white surface during calibration for best results
+    if (!sensor.calibrate())
+        Serial.println("Error during calibration!");
+    Serial.println("Calibration completed!");
+
+    // Decode sRGB palette to linear light, then convert to OKLab
+    for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+        ADPS9960_ColorSensor::RGB16 linear{};
+        linear.r = sRGBToLinear((paletteHex[i] >> 16) & 0xFF);
+        linear.g = sRGBToLinear((paletteHex[i] >> 8) & 0xFF);
+        linear.b = sRGBToLinear(paletteHex[i] & 0xFF);
+        ADPS9960_ColorSensor::convertToOKLab(linear, palette[i]);
+    }
+}
+
+void loop() {
+    ADPS9960_ColorSensor::OKLab lab{};
+    if (sensor.readColorOKLab(lab)) {
+        ADPS9960_ColorSensor::OKLCh lch{};
+        ADPS9960_ColorSensor::convertToOKLCh(lab, lch);
+
+        Serial.println("=== OKLab Reading ===");
+        Serial.print("L: ");
+        Serial.print(lch.L);
+        Serial.print(" C: ");
+        Serial.print(lch.C);
+        Serial.print(" h: ");
+        Serial.println(lch.h);
+
+        // Standard color from OKLCh hue angle
+        Serial.print("Standard color: ");
+        Serial.println(getStandardColorName(ADPS9960_ColorSensor::classifyOKLCh(lch)));
+
+        // Nearest product color (distance ~0.02 = just noticeable difference)
+        float distance = 0.0f;
+        int index = ADPS9960_ColorSensor::findNearestColor(lab, palette, PALETTE_SIZE, &distance);
+        Serial.print("Nearest palette color: ");
+        Serial.print(paletteNames[index]);
+        Serial.print(" (distance ");
+        Serial.print(distance);
+        Serial.println(")");
+        Serial.println("=====================");
+    }
+
+    delay(1000);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file APDS9960_ChromaticityTracker.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Alpha-beta tracker for chromaticity of moving targets
+ *
+ * Constant-velocity filter (steady-state Kalman) on the four
+ * chromaticity coordinates, for scanning surfaces that move under the
+ * sensor. Unlike an EMA it follows ramps without lag and can predict
+ * ahead to compensate the sensor's latency.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_CHROMATICITYTRACKER_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_CHROMATICITYTRACKER_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class ChromaticityTracker
+ * @brief Fixed-point alpha-beta filter on r/g/b chromaticity and intensity
+ *
+ * Feed one Chromaticity per sample with update(); read the filtered value
+ * with getEstimate() or a value extrapolated into the future with predict().
+ * Samples must be taken at a constant rate: velocities are per sample.
+ */
+class ChromaticityTracker {
+public:
+    static const uint8_t MAX_COAST_SAMPLES = 8;  ///< Consecutive coasts before the state stops moving
+
+    /**
+     * @brief Constructor - gains default to alpha 0.5, beta 0.1
+     */
+    ChromaticityTracker();
+
+    /**
+     * @brief Set the filter gains directly
+     * @param alpha Position gain (0.0-1.0, higher = follows measurements closer)
+     * @param beta Velocity gain (0.0-2.0, must stay below 4 - 2 * alpha for stability)
+     */
+    void setGains(float alpha, float beta);
+
+    /**
+     * @brief Derive the optimal gains from the noise levels
+     * @param measurementStdDev Sensor noise of one sample (CHROMA_SCALE units)
+     * @param accelerationStdDev Expected change of velocity per sample (CHROMA_SCALE units)
+     * @note Steady-state Kalman gains (Kalata): smooth for quiet scenes, agile for fast ones
+     */
+    void setNoise(float measurementStdDev, float accelerationStdDev);
+
+    /**
+     * @brief Measure the sensor noise on a static target and set the gains from it
+     * @param sensor Calibrated sensor to read
+     * @param accelerationStdDev Expected change of velocity per sample (CHROMA_SCALE units)
+     * @param samples Readings used for the variance (minimum 4)
+     * @param mode Chromaticity reference, as used for update()
+     * @return true on success, false on read error
+     */
+    bool calibrateNoise(ADPS9960_ColorSensor &sensor, float accelerationStdDev, uint8_t samples = 20,
+                        ADPS9960_ColorSensor::ChromaticityMode mode = ADPS9960_ColorSensor::CHROMA_BY_SUM);
+
+    /**
+     * @brief Get the position gain
+     * @return Alpha (0.0-1.0)
+     */
+    float getAlpha() const;
+
+    /**
+     * @brief Get the velocity gain
+     * @return Beta
+     */
+    float getBeta() const;
+
+    /**
+     * @brief Get the measurement noise found by calibrateNoise()
+     * @return Largest per-coordinate standard deviation (0 if not measured)
+     */
+    float getMeasurementNoise() const;
+
+    /**
+     * @brief Feed one measurement
+     * @param measured Chromaticity of the current sample
+     * @note The first measurement initializes the state with zero velocity
+     */
+    void update(const ADPS9960_ColorSensor::Chromaticity &measured);
+
+    /**
+     * @brief Feed one measurement together with the flags of its sample
+     * @param measured Chromaticity of the sample
+     * @param sampleFlags ColorSample::flags from readSample()
+     * @note Repeated results are ignored; clipped or saturated samples only
+     *       advance the prediction (coast)
+     */
+    void update(const ADPS9960_ColorSensor::Chromaticity &measured, uint8_t sampleFlags);
+
+    /**
+     * @brief Advance one sample without a measurement
+     * @note Position follows the current velocity for up to MAX_COAST_SAMPLES
+     *       consecutive coasts, then holds (velocity 0) until the next update()
+     */
+    void coast();
+
+    /**
+     * @brief Get the filtered chromaticity at the last sample
+     * @param estimate Reference receiving the estimate (zero before the first update)
+     */
+    void getEstimate(ADPS9960_ColorSensor::Chromaticity &estimate) const;
+
+    /**
+     * @brief Extrapolate the chromaticity into the future
+     * @param predicted Reference receiving position + velocity * samplesAhead
+     * @param samplesAhead Samples to look ahead (latency compensation)
+     */
+    void predict(ADPS9960_ColorSensor::Chromaticity &predicted, uint8_t samplesAhead) const;
+
+    /**
+     * @brief Forget the state; the next update() re-initializes it
+     */
+    void reset();
+
+    /**
+     * @brief Check if the tracker received a measurement since the last reset
+     * @return true if the state is valid
+     */
+    bool isInitialized() const;
+
+private:
+    static const uint8_t CHANNELS = 4;  ///< r, g, b, intensity
+
+    int32_t position[CHANNELS];  ///< Filtered coordinates (Q8)
+    int32_t velocity[CHANNELS];  ///< Change per sample (Q8)
+    uint32_t alphaQ16;           ///< Position gain (Q16)
+    uint32_t betaQ16;            ///< Velocity gain (Q16)
+    float measurementNoise;      ///< Noise found by calibrateNoise()
+    uint8_t coastCount;          ///< Consecutive coast() calls since the last measurement
+    bool initialized;            ///< State holds at least one measurement
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_CHROMATICITYTRACKER_H
@@ -13,6 +13,8 @@
 #define MANIGLIO_APDS_LIBRARY_APDS9960_COLORSENSOR_H
 
 #include "SparkFun_APDS9960.h"
+#include "APDS9960_TransferFit.h"
+#include "APDS9960_LUTFit.h"
 
 /**
  * @enum StandardColor
@@ -78,6 +80,88 @@ public:
         CALIBRATED_WITH_DEFAULTS  ///< Using default calibration values (fallback)
     };
 
+    /**
+     * @enum CalibrationCheck
+     * @brief Outcome of the calibration quality checks (first failing check)
+     */
+    enum CalibrationCheck {
+        CHECK_NOT_RUN,       ///< No calibration has been sampled yet
+        CHECK_PASSED,        ///< All checks passed
+        CHECK_SAMPLE_COUNT,  ///< Fewer than MIN_SAMPLES_PER_SECOND samples per second
+        CHECK_LOW_LIGHT,     ///< Clear or all RGB maximums below MIN_THRESHOLD
+        CHECK_SATURATION,    ///< A maximum at or above getSaturationLevel()
+        CHECK_ZERO_VALUES    ///< Clear or all RGB maximums equal to zero
+    };
+
+    /**
+     * @enum ChromaticityMode
+     * @brief Reference used to normalize channels into chromaticity coordinates
+     */
+    enum ChromaticityMode {
+        CHROMA_BY_SUM,   ///< Divide by R+G+B (white = CHROMA_SCALE / 3 per channel)
+        CHROMA_BY_CLEAR  ///< Divide by the clear channel (white = CHROMA_SCALE per channel)
+    };
+
+    /**
+     * @enum MainsFrequency
+     * @brief Mains frequency driving the flicker of the illuminant
+     */
+    enum MainsFrequency {
+        MAINS_NONE,  ///< No flicker detected (DC-powered or daylight)
+        MAINS_50HZ,  ///< 50 Hz mains (100 Hz flicker)
+        MAINS_60HZ,  ///< 60 Hz mains (120 Hz flicker)
+        MAINS_ANY    ///< Unknown: use settings that reject both
+    };
+
+    /**
+     * @enum BusError
+     * @brief Cause of the last failed bus transaction
+     * @note Values 1-5 match the codes of Wire.endTransmission()
+     */
+    enum BusError {
+        BUS_OK = 0,            ///< Last transaction succeeded
+        BUS_DATA_TOO_LONG = 1, ///< Transmit buffer overflow
+        BUS_NACK_ADDRESS = 2,  ///< No acknowledge of the address (sensor absent or unpowered)
+        BUS_NACK_DATA = 3,     ///< No acknowledge of a data byte
+        BUS_ARBITRATION = 4,   ///< Arbitration lost or other bus error (e.g. SDA held low)
+        BUS_TIMEOUT = 5,       ///< Bus timeout (SCL held low)
+        BUS_SHORT_READ,        ///< Fewer bytes received than requested
+        BUS_DRIVER_ERROR       ///< A SparkFun driver call failed (cause not reported)
+    };
+
+    /**
+     * @enum ChannelMask
+     * @brief Channels requested from readChannels() (bit mask, same bits as saturatedMask)
+     */
+    enum ChannelMask {
+        CHANNEL_CLEAR = 0x01,  ///< Clear (ambient) channel
+        CHANNEL_RED = 0x02,    ///< Red channel
+        CHANNEL_GREEN = 0x04,  ///< Green channel
+        CHANNEL_BLUE = 0x08,   ///< Blue channel
+        CHANNEL_RGB = 0x0E,    ///< Red, green and blue
+        CHANNEL_ALL = 0x0F     ///< All four channels
+    };
+
+    /**
+     * @enum SampleFlag
+     * @brief Quality flags of a ColorSample (bit mask)
+     */
+    enum SampleFlag {
+        SAMPLE_FRESH = 0x01,             ///< New integration (AVALID was set), not a repeated result
+        SAMPLE_ANALOG_SATURATED = 0x02,  ///< Clear photodiode saturated (CPSAT)
+        SAMPLE_CLIPPED = 0x04,           ///< At least one channel at digital full scale
+        SAMPLE_AVERAGED = 0x08           ///< Decimated from several integrations
+    };
+
+    /**
+     * @enum ColorEncoding
+     * @brief Transfer function applied to 8-bit RGB outputs
+     */
+    enum ColorEncoding {
+        ENCODING_LINEAR,  ///< Linear sensor ratios (default, unchanged behavior)
+        ENCODING_SRGB     ///< sRGB gamma encoding for displays, LED strips and web colors
+    };
+
     // Calibration constants - can be made configurable if needed
     static const int DEFAULT_SAMPLING_TIME = 5;        ///< Default calibration duration in seconds
     static const int MAX_SAMPLING_TIME = 10;           ///< Maximum allowed calibration time
@@ -85,6 +169,39 @@ public:
     static const uint16_t MIN_THRESHOLD = 10;          ///< Minimum sensor reading to avoid dark conditions
     static const uint16_t SATURATION_THRESHOLD = 65000;///< Maximum value before sensor saturation
     static const uint16_t DEFAULT_MAX_VALUE = 1000;    ///< Default maximum value for normalization
+    static const uint16_t CHROMA_SCALE = 4096;         ///< Fixed-point unit of chromaticity coordinates (1.0)
+    static const uint8_t MIN_LUT_GRID_SIZE = 2;        ///< Smallest 3D LUT (2x2x2 nodes)
+    static const uint8_t MAX_LUT_GRID_SIZE = 33;       ///< Largest 3D LUT (33x33x33 nodes)
+
+    // Exposure constants (APDS9960 datasheet)
+    static const uint8_t GAIN_COUNT = 4;                ///< Number of AGAIN settings (AGAIN_1X..AGAIN_64X)
+    static const uint16_t INTEGRATION_CYCLE_US = 2780;  ///< Duration of one ALS integration cycle
+    static const uint16_t COUNTS_PER_CYCLE = 1025;      ///< Full-scale counts added per integration cycle
+
+    // Calibration profile constants
+    static const uint8_t MAX_PROFILES = 4;              ///< Stored illuminant profiles
+    static const uint8_t PROFILE_NAME_LENGTH = 12;      ///< Profile name buffer, including terminator
+    static const uint16_t CALIBRATION_BLOB_MAGIC = 0xA960; ///< Identifies an exported CalibrationBlob
+    static const uint8_t CALIBRATION_BLOB_VERSION = 4;  ///< Layout version of CalibrationBlob
+    static const uint8_t MIN_TRANSFER_TARGETS = TRANSFER_FIT_MIN_TARGETS; ///< Reference targets needed to fit a transfer matrix
+    static const uint16_t MIN_LUT_PATCHES = LUT_FIT_MIN_PATCHES; ///< Reference patches needed to fit a correction LUT
+
+    // Flicker rejection constants
+    static const uint8_t FLICKER_CYCLES_50HZ = 18;      ///< 50.04 ms = 5 flicker periods at 50 Hz (and 6 at 60 Hz)
+    static const uint8_t FLICKER_CYCLES_60HZ = 3;       ///< 8.34 ms = 1 flicker period at 60 Hz
+    static const uint16_t FLICKER_PERIOD_50HZ_US = 10000; ///< Flicker period (half mains period) at 50 Hz
+    static const uint16_t FLICKER_PERIOD_60HZ_US = 8333;  ///< Flicker period (half mains period) at 60 Hz
+
+    // Oversampling constants
+    static const uint8_t MAX_OVERSAMPLING = 64;         ///< Largest number of integrations per reading
+
+    // HDR constants
+    static const uint8_t MAX_HDR_EXPOSURES = 4;         ///< Largest number of exposures merged per HDR sample
+
+    // Bus recovery constants
+    static const uint8_t BUS_CLEAR_PULSES = 9;          ///< SCL pulses that release any slave holding SDA
+    static const uint8_t DEFAULT_RECOVERY_RETRIES = 4;  ///< Recovery attempts before giving up
+    static const uint16_t DEFAULT_MAX_BACKOFF_MS = 64;  ///< Upper bound of the retry delay
 
     /**
      * @brief Constructor - initializes sensor object with uncalibrated state
@@ -132,6 +249,183 @@ public:
      */
     void setDefaultCalibration();
 
+    /**
+     * @struct CalibrationData
+     * @brief White reference together with the exposure it was measured at
+     */
+    struct CalibrationData {
+        uint16_t maxAmbient;  ///< White reference, clear channel
+        uint16_t maxRed;      ///< White reference, red channel
+        uint16_t maxGreen;    ///< White reference, green channel
+        uint16_t maxBlue;     ///< White reference, blue channel
+        uint8_t gain;         ///< AGAIN active during calibration (AGAIN_1X..AGAIN_64X)
+        uint8_t atime;        ///< ATIME register value active during calibration
+    };
+
+    /**
+     * @struct ChannelStats
+     * @brief Statistics of one channel over the calibration samples
+     */
+    struct ChannelStats {
+        float mean;    ///< Average raw value
+        float stddev;  ///< Sample standard deviation (noise)
+        float snr;     ///< Signal-to-noise ratio (mean / stddev, 0 if stddev is 0)
+        uint16_t min;  ///< Smallest raw value
+        uint16_t max;  ///< Largest raw value (used as white reference)
+    };
+
+    /**
+     * @struct CalibrationReport
+     * @brief Quality metrics of the last calibrate() run
+     */
+    struct CalibrationReport {
+        uint16_t sampleCount;       ///< Successful samples collected
+        uint16_t requiredSamples;   ///< Samples needed to pass CHECK_SAMPLE_COUNT
+        uint16_t readErrors;        ///< Failed sensor reads
+        uint16_t saturationEvents;  ///< Samples with a channel at or above getSaturationLevel()
+        float sampleRate;           ///< Achieved samples per second
+        ChannelStats ambient;       ///< Clear channel statistics
+        ChannelStats red;           ///< Red channel statistics
+        ChannelStats green;         ///< Green channel statistics
+        ChannelStats blue;          ///< Blue channel statistics
+        CalibrationCheck result;    ///< CHECK_PASSED or the first failing check
+    };
+
+    /**
+     * @struct OversamplingReport
+     * @brief Cost and benefit of the last oversampled reading
+     */
+    struct OversamplingReport {
+        uint8_t samples;          ///< Integrations accumulated
+        float effectiveBitsGain;  ///< Resolution gained, 0.5 * log2(samples) for white noise
+        float snr;                ///< Estimated clear-channel SNR of the decimated value
+        uint32_t latencyUs;       ///< Time spent collecting the integrations
+    };
+
+    /**
+     * @struct RecoveryReport
+     * @brief Bus errors and recoveries since begin()
+     */
+    struct RecoveryReport {
+        uint16_t busErrors;         ///< Failed sensor reads that triggered a recovery
+        uint16_t recoveries;        ///< Recoveries that brought the sensor back
+        uint16_t failedRecoveries;  ///< Recoveries that gave up
+        uint16_t busClears;         ///< SCL bus-clear sequences sent
+        uint16_t reinitializations; ///< Sensor re-initializations from the register shadow
+        uint8_t lastAttempts;       ///< Attempts used by the last recovery
+        BusError lastError;         ///< Cause that triggered the last recovery
+        uint32_t lastRecoveryUs;    ///< Duration of the last recovery
+        uint32_t maxRecoveryUs;     ///< Longest recovery
+    };
+
+    /**
+     * @struct EnergyModel
+     * @brief Supply and current figures used to estimate energy
+     * @note Defaults: APDS-9960 datasheet typical values at 3.3 V, 4.7 kOhm
+     *       pull-ups at 100 kHz, and a generic 10 mA MCU
+     */
+    struct EnergyModel {
+        float supplyVoltage;       ///< Sensor, bus and MCU supply (V)
+        float activeCurrentUa;     ///< Sensor current while integrating (uA)
+        float waitCurrentUa;       ///< Sensor current in the wait state (uA)
+        float ledCurrentMa;        ///< LED current while pulsing (mA)
+        float busEnergyPerByteUj;  ///< Pull-up losses of one bus byte (uJ)
+        float mcuAwakeCurrentMa;   ///< MCU current while inside library reads (mA)
+        float sleepCurrentUa;      ///< Sensor current with PON cleared (uA)
+    };
+
+    /**
+     * @struct EnergyReport
+     * @brief Running energy totals since begin() or the last reset
+     * @note The energies are kept as integer picojoules and converted to
+     *       float when the report is read, so long runs do not lose charge
+     */
+    struct EnergyReport {
+        float sensorUj;            ///< Sensor supply (integration and wait states)
+        float ledUj;               ///< LED pulses
+        float busUj;               ///< I2C pull-up losses
+        float mcuUj;               ///< MCU awake inside library reads
+        float totalUj;             ///< Sum of the above
+        float averageCurrentUa;    ///< totalUj as a mean current over elapsedMs
+        uint64_t elapsedMs;        ///< Time covered by the totals
+        uint64_t mcuAwakeUs;       ///< Time spent inside library reads
+        uint64_t ledOnUs;          ///< Time the LED was pulsing
+        uint64_t busBytes;         ///< Bus bytes charged
+        uint32_t classifications;  ///< detectColor*() calls with a valid reading
+    };
+
+    /**
+     * @struct ExposureSetting
+     * @brief One gain / integration time combination
+     */
+    struct ExposureSetting {
+        uint8_t gain;   ///< AGAIN_1X..AGAIN_64X
+        uint8_t atime;  ///< ATIME register value
+    };
+
+    /**
+     * @struct HDRColor
+     * @brief Extended-range sample merged from several exposures
+     *
+     * Channels are expressed in counts of the current exposure (set with
+     * setGain()/setIntegrationTime()) with 8 fractional bits, so values
+     * above 65535 (highlights) and below one count (dark targets) survive.
+     */
+    struct HDRColor {
+        uint32_t ambient;        ///< Clear channel (Q24.8 counts)
+        uint32_t red;            ///< Red channel (Q24.8 counts)
+        uint32_t green;          ///< Green channel (Q24.8 counts)
+        uint32_t blue;           ///< Blue channel (Q24.8 counts)
+        uint8_t exposureUsed;    ///< Exposure index per channel, 2 bits each (C, R, G, B from bit 0)
+        uint8_t saturatedMask;   ///< Channels saturated in every exposure (bit 0 = C ... bit 3 = B)
+        uint32_t acquisitionUs;  ///< Time spent on all exposures
+    };
+
+    /**
+     * @struct TransferMatrix
+     * @brief Per-unit 3x3 transform from this sensor's RGB into the canonical device space
+     *
+     * Row-major coefficients in Q3.12 (CHROMA_SCALE = 1.0, range about -8 to +8):
+     * canonical[i] = sum(m[i * 3 + j] * measured[j]) / CHROMA_SCALE
+     */
+    struct TransferMatrix {
+        int16_t m[9];  ///< Row-major coefficients, identity = CHROMA_SCALE on the diagonal
+    };
+
+    /**
+     * @struct CalibrationProfile
+     * @brief Named calibration for one illuminant (e.g. "DAYLIGHT", "LED_NIGHT")
+     */
+    struct CalibrationProfile {
+        char name[PROFILE_NAME_LENGTH];  ///< Null-terminated profile name
+        CalibrationData data;            ///< White reference and its exposure
+        uint16_t signature[3];           ///< R/G/B of the scene relative to clear (CHROMA_SCALE), for auto selection
+        uint8_t status;                  ///< CalibrationStatus the reference was saved with
+        uint8_t transferEnabled;         ///< 1 if transfer was applied when saved
+        TransferMatrix transfer;         ///< Transfer matrix fitted under this illuminant
+    };
+
+    /**
+     * @struct CalibrationBlob
+     * @brief Complete calibration state, ready to be written to EEPROM/flash
+     * @note Fill with exportCalibration(), restore with importCalibration()
+     */
+    struct CalibrationBlob {
+        uint16_t magic;                             ///< CALIBRATION_BLOB_MAGIC
+        uint8_t version;                            ///< CALIBRATION_BLOB_VERSION
+        uint8_t status;                             ///< CalibrationStatus of the current calibration
+        CalibrationData current;                    ///< Calibration in use
+        uint16_t gainRatios[GAIN_COUNT][4];         ///< Gain factors relative to 1x per channel (C, R, G, B; Q8.8)
+        uint8_t profileCount;                       ///< Valid entries in profiles
+        int8_t activeProfile;                       ///< Selected profile, -1 if none
+        CalibrationProfile profiles[MAX_PROFILES];  ///< Stored illuminant profiles
+        TransferMatrix transfer;                    ///< Unit-to-canonical transfer matrix
+        uint8_t transferEnabled;                    ///< 1 if transfer is applied
+        uint8_t lutGridSize;                        ///< Nodes per axis of the correction LUT in use, 0 if none
+        uint16_t lutChecksum;                       ///< Fletcher-16 of the LUT nodes, identifies the unit's table
+        uint16_t checksum;                          ///< Fletcher-16 of all preceding bytes
+    };
+
     /**
      * @struct RawColor
      * @brief Structure for raw 16-bit color sensor data
@@ -143,6 +437,42 @@ public:
         uint16_t blue;     ///< Blue channel raw value (0-65535)
     };
 
+    /**
+     * @struct ColorSample
+     * @brief Raw sample with quality metadata, packed into 16 bytes
+     */
+    struct ColorSample {
+        uint16_t ambient;       ///< Clear channel raw value
+        uint16_t red;           ///< Red channel raw value
+        uint16_t green;         ///< Green channel raw value
+        uint16_t blue;          ///< Blue channel raw value
+        uint32_t timestampUs;   ///< micros() when the sample was read
+        uint8_t flags;          ///< SampleFlag bits
+        uint8_t saturatedMask;  ///< Clipped channels (bit 0 = C, 1 = R, 2 = G, 3 = B)
+        uint8_t gain;           ///< AGAIN of the sample
+        uint8_t atime;          ///< ATIME of the sample
+    };
+
+    /**
+     * @brief Switches the illumination LED for differential capture
+     * @param on true to light the target, false to switch the LED off
+     * @param context Pointer passed to setIllumination()
+     */
+    typedef void (*IlluminationCallback)(bool on, void *context);
+
+    /**
+     * @struct DifferentialReport
+     * @brief The two integrations behind the last differential reading
+     */
+    struct DifferentialReport {
+        RawColor lit;               ///< Integration with the LED on
+        RawColor ambient;           ///< Integration with the LED off
+        uint32_t skewUs;            ///< Time between the completions of the two integrations
+        uint32_t ledOnUs;           ///< Time the LED was on for the pair
+        uint8_t litSaturatedMask;   ///< Channels clipped with the LED on (bit 0 = C, 1 = R, 2 = G, 3 = B)
+        uint8_t ambientShare;       ///< Ambient as a share of the lit clear channel (0-255)
+    };
+
     /**
      * @struct RGB
      * @brief Structure for normalized 8-bit RGB values
@@ -153,6 +483,16 @@ public:
         uint8_t b;  ///< Blue channel (0-255)
     };
 
+    /**
+     * @struct RGB16
+     * @brief Structure for normalized 16-bit RGB values (full calibrated resolution)
+     */
+    struct RGB16 {
+        uint16_t r;  ///< Red channel (0-65535)
+        uint16_t g;  ///< Green channel (0-65535)
+        uint16_t b;  ///< Blue channel (0-65535)
+    };
+
     /**
      * @struct HSV
      * @brief Represents a color in the HSV (Hue, Saturation, Value) color space
@@ -163,6 +503,42 @@ public:
         float v;  ///< Value/Brightness (0.0-1.0)
     };
 
+    /**
+     * @struct OKLab
+     * @brief Color in the perceptually uniform OKLab space
+     * @note Euclidean distance between two OKLab colors approximates perceived difference
+     */
+    struct OKLab {
+        float L;  ///< Perceptual lightness (0.0-1.0, calibrated white = 1.0)
+        float a;  ///< Green (-) to red (+) axis
+        float b;  ///< Blue (-) to yellow (+) axis
+    };
+
+    /**
+     * @struct OKLCh
+     * @brief Polar form of OKLab (lightness, chroma, hue angle)
+     */
+    struct OKLCh {
+        float L;  ///< Perceptual lightness (0.0-1.0)
+        float C;  ///< Chroma (0.0 = neutral, ~0.3 = vivid)
+        float h;  ///< Hue angle (0-360 degrees)
+    };
+
+    /**
+     * @struct Chromaticity
+     * @brief Brightness-independent color coordinates in CHROMA_SCALE fixed point
+     *
+     * Channels are white-balanced with the calibration maximums before being
+     * divided by the mode reference, so a change in illuminance leaves r/g/b
+     * unchanged. Only intensity follows the light level.
+     */
+    struct Chromaticity {
+        uint16_t r;          ///< Red coordinate
+        uint16_t g;          ///< Green coordinate
+        uint16_t b;          ///< Blue coordinate
+        uint16_t intensity;  ///< Clear channel relative to calibration (CHROMA_SCALE = calibrated white)
+    };
+
     /**
      * @brief Read raw 16-bit color data from sensor
      * @param raw Reference to RawColor struct to fill
@@ -170,41 +546,130 @@ public:
      */
     bool readRawData(RawColor &raw);
 
+    /**
+     * @brief Read only the requested channels in one burst
+     * @param raw Reference receiving the requested channels (others set to 0)
+     * @param channelMask ChannelMask bits to read
+     * @return true if read successful, false on bus error or empty mask
+     * @note Plain register read: no averaging, no white balance adaptation
+     */
+    bool readChannels(RawColor &raw, uint8_t channelMask);
+
+    /**
+     * @brief Stop the ALS so that startIntegration() can start it with one write
+     * @return true on success, false on bus error
+     * @note Lets several sensors be prepared first and started close together
+     */
+    bool holdIntegration();
+
+    /**
+     * @brief Start an integration now
+     * @return true on success, false on bus error
+     * @note One register write after holdIntegration(); without it, the
+     *       running integration is aborted first
+     */
+    bool startIntegration();
+
+    /**
+     * @brief Wait until the ALS has completed an integration (AVALID)
+     * @return true when fresh data is available, false on timeout or bus error
+     * @note After startIntegration() this covers the wait state (WEN) as well
+     */
+    bool waitForValidData();
+
+    /**
+     * @brief Get the bytes moved on the bus by this library's transactions
+     * @return Address, register and data bytes since the last reset
+     * @note Transactions inside the SparkFun driver (init, gain) are not counted
+     */
+    uint32_t getBusByteCount() const;
+
+    /**
+     * @brief Reset the bus byte counter
+     */
+    void resetBusByteCount();
+
+    /**
+     * @brief Read a raw sample together with its quality flags
+     * @param sample Reference to ColorSample struct to populate
+     * @return true if read successful, false on sensor read error
+     * @note One extra register read (STATUS) compared to readRawData()
+     */
+    bool readSample(ColorSample &sample);
+
+    /**
+     * @brief Check if a sample is fit for filters and classifiers
+     * @param sample Sample from readSample()
+     * @return true if fresh and neither clipped nor analog saturated
+     */
+    static bool isSampleUsable(const ColorSample &sample);
+
+    /**
+     * @brief Get the clipped-channel mask of the last reading
+     * @return Bit mask (bit 0 = C, 1 = R, 2 = G, 3 = B), 0 if all channels are in range
+     * @note detect*() methods return UNKNOWN when their sample was clipped
+     */
+    uint8_t getLastSaturatedMask() const;
+
     /**
      * @brief Read normalized RGB values (0-255 range)
      * @param r Reference to store red value
      * @param g Reference to store green value
      * @param b Reference to store blue value
+     * @param encoding Output transfer function (default: linear)
      * @return true if read successful, false otherwise
      * @note Automatically calibrates with defaults if not yet calibrated
      */
-    bool readRGB(uint8_t &r, uint8_t &g, uint8_t &b);
+    bool readRGB(uint8_t &r, uint8_t &g, uint8_t &b,
+                 ColorEncoding encoding = ENCODING_LINEAR);
 
     /**
      * @brief Read color as 24-bit hexadecimal value
+     * @param encoding Output transfer function (default: linear)
      * @return Color in 0xRRGGBB format, 0x000000 on error
      */
-    uint32_t readColorHex();
+    uint32_t readColorHex(ColorEncoding encoding = ENCODING_LINEAR);
 
     /**
      * @brief Read normalized RGB values into struct
      * @param rgb Reference to RGB struct to fill
+     * @param encoding Output transfer function (default: linear)
+     * @return true if read successful, false otherwise
+     */
+    bool readRGB(RGB &rgb, ColorEncoding encoding = ENCODING_LINEAR);
+
+    /**
+     * @brief Read normalized RGB values with 16 bits per channel (0-65535 range)
+     * @param rgb Reference to RGB16 struct to fill
      * @return true if read successful, false otherwise
+     * @note Keeps the full sensor resolution that readRGB() truncates to 8 bits
+     * @note Automatically calibrates with defaults if not yet calibrated
+     */
+    bool readRGB16(RGB16 &rgb);
+
+    /**
+     * @brief Normalize a raw reading the way readRGB16() does
+     * @param raw Raw sensor data (e.g. a ColorSample or a recording)
+     * @param rgb Reference to RGB16 struct to fill
+     * @note Applies the white reference, transfer matrix and correction LUT
+     *       without reading the sensor
      */
-    bool readRGB(RGB &rgb);
+    void normalizeRaw(const RawColor &raw, RGB16 &rgb) const;
 
     /**
      * @brief Read color as hexadecimal with error checking
      * @param hexColor Reference to store hex color value
+     * @param encoding Output transfer function (default: linear)
      * @return true if read successful, false otherwise
      */
-    bool readColorHex(uint32_t &hexColor);
+    bool readColorHex(uint32_t &hexColor, ColorEncoding encoding = ENCODING_LINEAR);
 
     /**
      * @brief Get color as formatted hex string
+     * @param encoding Output transfer function (default: linear)
      * @return String in "#RRGGBB" format (e.g., "#FF0000" for red)
      */
-    String getColorHexString();
+    String getColorHexString(ColorEncoding encoding = ENCODING_LINEAR);
 
     /**
      * @brief Reads the current color as HSV from the sensor
@@ -215,6 +680,180 @@ public:
      */
     bool readColorHSV(HSV &hsvColor);
 
+    /**
+     * @brief Convert a 16-bit RGB color to HSV
+     * @param rgb Source color (e.g. from readRGB16())
+     * @param hsvColor Reference to HSV struct to fill
+     */
+    static void convertToHSV(const RGB16 &rgb, HSV &hsvColor);
+
+    /**
+     * @brief Classify an HSV color into the closest standard color
+     * @param hsvColor Color to classify
+     * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
+     * @return StandardColor enum of matching color, UNKNOWN if no match
+     * @note Same rules as detectColor(), without reading the sensor
+     */
+    static StandardColor classifyHSV(const HSV &hsvColor, float tolerance = 0.15f);
+
+    /**
+     * @brief Read the current color in OKLab space
+     * @param lab Reference to OKLab struct to fill
+     * @return true if read successful, false otherwise
+     * @note Automatically calibrates with defaults if not yet calibrated
+     */
+    bool readColorOKLab(OKLab &lab);
+
+    /**
+     * @brief Convert a linear 16-bit RGB color to OKLab
+     * @param rgb Source color (calibrated linear, e.g. from readRGB16())
+     * @param lab Reference to OKLab struct to fill
+     * @note Uses a fast cube root (relative error below 2e-6)
+     */
+    static void convertToOKLab(const RGB16 &rgb, OKLab &lab);
+
+    /**
+     * @brief Convert an OKLab color to its polar OKLCh form
+     * @param lab Source color
+     * @param lch Reference to OKLCh struct to fill
+     */
+    static void convertToOKLCh(const OKLab &lab, OKLCh &lch);
+
+    /**
+     * @brief Classify an OKLCh color into the closest standard color
+     * @param lch Color to classify
+     * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
+     * @return StandardColor enum of matching color, UNKNOWN if no match
+     * @note Perceptually even alternative to classifyHSV()
+     */
+    static StandardColor classifyOKLCh(const OKLCh &lch, float tolerance = 0.15f);
+
+    /**
+     * @brief Detect the closest standard color using OKLCh hue angles
+     * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
+     * @return StandardColor enum of detected color, UNKNOWN if no match, error or clipped sample
+     */
+    StandardColor detectColorOKLCh(float tolerance = 0.15f);
+
+    /**
+     * @brief Find the palette entry nearest to a color in OKLab space
+     * @param lab Color to match
+     * @param palette Array of reference colors
+     * @param paletteSize Number of entries in palette
+     * @param distance Optional pointer receiving the OKLab distance to the match
+     * @return Index of the nearest entry, -1 if the palette is empty
+     */
+    static int findNearestColor(const OKLab &lab, const OKLab *palette,
+                                uint8_t paletteSize, float *distance = nullptr);
+
+    /**
+     * @brief Enable 3D LUT color correction on the 16-bit RGB path
+     * @param lut Node table of gridSize^3 RGB triplets (0-65535), blue index fastest
+     * @param gridSize Nodes per axis (MIN_LUT_GRID_SIZE-MAX_LUT_GRID_SIZE, e.g. 9 or 17)
+     * @param inProgmem true if lut was declared PROGMEM (AVR flash)
+     * @return true if the LUT was accepted, false on null pointer, bad size, or
+     *         a table other than the one recorded in the last imported blob
+     * @note The table is not copied and must outlive its use
+     * @note Applies to readRGB16() and everything built on it (HSV, OKLab, sRGB)
+     */
+    bool setColorCorrectionLUT(const uint16_t *lut, uint8_t gridSize, bool inProgmem = false);
+
+    /**
+     * @brief Disable 3D LUT color correction
+     */
+    void clearColorCorrectionLUT();
+
+    /**
+     * @brief Apply a 3D LUT to a color using tetrahedral interpolation
+     * @param lut Node table (see setColorCorrectionLUT())
+     * @param gridSize Nodes per axis
+     * @param inProgmem true if lut was declared PROGMEM
+     * @param rgb Color to correct in place
+     * @note Integer arithmetic only: 4 node fetches and 9 multiplications
+     */
+    static void applyColorCorrectionLUT(const uint16_t *lut, uint8_t gridSize,
+                                        bool inProgmem, RGB16 &rgb);
+
+    /**
+     * @brief Fit a per-unit correction LUT from reference patches
+     * @param measured Patches as measured by this unit (measureTransferTarget())
+     * @param reference The true values of the same patches
+     * @param count Number of patches (at least MIN_LUT_PATCHES)
+     * @param gridSize Nodes per axis (MIN_LUT_GRID_SIZE-MAX_LUT_GRID_SIZE)
+     * @param lut Array of gridSize^3 * 3 receiving the node table
+     * @return true on success, false on null pointers, too few patches or bad size
+     * @note Wraps fitCorrectionLUT(); on a host, include APDS9960_LUTFit.h
+     *       and build src/APDS9960_LUTFit.cpp alone, without Arduino headers
+     */
+    static bool fitColorCorrectionLUT(const RGB16 *measured, const RGB16 *reference, uint16_t count,
+                                      uint8_t gridSize, uint16_t *lut);
+
+    /**
+     * @brief Get the checksum identifying a LUT, as stored in CalibrationBlob
+     * @param lut Node table
+     * @param gridSize Nodes per axis
+     * @param inProgmem true if lut was declared PROGMEM
+     * @return Fletcher-16 of the node values (low byte first)
+     */
+    static uint16_t getColorCorrectionLUTChecksum(const uint16_t *lut, uint8_t gridSize,
+                                                  bool inProgmem = false);
+
+    /**
+     * @brief Measure a reference target for fleet characterization
+     * @param measured Reference receiving the averaged white-balanced RGB16,
+     *                 before transfer matrix and LUT correction
+     * @param samples Readings averaged, one per integration period (0 is treated as 1)
+     * @return true if at least one reading succeeded, false otherwise
+     */
+    bool measureTransferTarget(RGB16 &measured, uint8_t samples = 8);
+
+    /**
+     * @brief Fit a transfer matrix by least squares over reference targets
+     * @param measured Targets as measured by this unit (measureTransferTarget())
+     * @param canonical The same targets in the canonical device space
+     * @param count Number of targets (at least MIN_TRANSFER_TARGETS)
+     * @param matrix Reference receiving the fitted matrix
+     * @return true on success, false if too few or degenerate targets, or a
+     *         coefficient outside the Q3.12 range
+     * @note Wraps fitTransferCoefficients(); on a host, include APDS9960_TransferFit.h
+     *       and build src/APDS9960_TransferFit.cpp alone, without Arduino headers
+     */
+    static bool fitTransferMatrix(const RGB16 *measured, const RGB16 *canonical,
+                                  uint8_t count, TransferMatrix &matrix);
+
+    /**
+     * @brief Enable the transfer into the canonical device space
+     * @param matrix Unit transfer matrix (copied)
+     * @note Applies to readRGB16() and everything built on it (HSV, OKLab, sRGB),
+     *       before the 3D LUT
+     */
+    void setTransferMatrix(const TransferMatrix &matrix);
+
+    /**
+     * @brief Disable the transfer into the canonical device space
+     */
+    void clearTransferMatrix();
+
+    /**
+     * @brief Check if a transfer matrix is applied
+     * @return true if readings are reported in the canonical device space
+     */
+    bool hasTransferMatrix() const;
+
+    /**
+     * @brief Get the current transfer matrix
+     * @return Reference to the matrix (identity if none was set)
+     */
+    const TransferMatrix &getTransferMatrix() const;
+
+    /**
+     * @brief Apply a transfer matrix to a color
+     * @param matrix Transfer matrix
+     * @param rgb Color to transform in place (clamped to 0-65535)
+     * @note Integer arithmetic only: 9 multiplications
+     */
+    static void applyTransferMatrix(const TransferMatrix &matrix, RGB16 &rgb);
+
     /**
      * @brief Check if current color matches custom HSV ranges
      * @param hMin Minimum hue value (0-360)
@@ -223,7 +862,8 @@ public:
      * @param sMax Maximum saturation (0.0-1.0)
      * @param vMin Minimum value/brightness (0.0-1.0)
      * @param vMax Maximum value/brightness (0.0-1.0)
-     * @return true if color is within specified ranges, false otherwise
+     * @return true if color is within specified ranges, false otherwise (also on
+     *         read error or clipped channel)
      */
     bool isColorInRange(float hMin, float hMax, 
                        float sMin, float sMax, 
@@ -233,24 +873,565 @@ public:
      * @brief Check if current color matches a standard predefined color
      * @param color StandardColor enum value to check against
      * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
-     * @return true if color matches the standard, false otherwise
+     * @return true if color matches the standard, false otherwise (also on
+     *         read error or clipped channel)
      */
     bool isStandardColor(StandardColor color, float tolerance = 0.15f);
 
     /**
      * @brief Detect and return the closest matching standard color
      * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
-     * @return StandardColor enum of detected color, UNKNOWN if no match or error
+     * @return StandardColor enum of detected color, UNKNOWN if no match, error or clipped sample
      * @note Checks colors in priority order: BLACK, WHITE, then chromatic colors
      */
     StandardColor detectColor(float tolerance = 0.15f);
 
+    /**
+     * @brief Read brightness-independent chromaticity coordinates
+     * @param chroma Reference to Chromaticity struct to fill
+     * @param mode Normalization reference (default: channel sum)
+     * @return true if read successful, false otherwise
+     * @note Automatically calibrates with defaults if not yet calibrated
+     */
+    bool readChromaticity(Chromaticity &chroma, ChromaticityMode mode = CHROMA_BY_SUM);
+
+    /**
+     * @brief Convert a raw reading into chromaticity coordinates
+     * @param raw Raw sensor data (e.g. from readRawData() or a recording)
+     * @param chroma Reference to Chromaticity struct to fill
+     * @param mode Normalization reference (default: channel sum)
+     * @note Integer-only; uses the current calibration maximums
+     */
+    void toChromaticity(const RawColor &raw, Chromaticity &chroma,
+                        ChromaticityMode mode = CHROMA_BY_SUM) const;
+
+    /**
+     * @brief Detect a standard color in chromaticity space
+     * @param tolerance Optional tolerance factor (0.0-1.0, default: 0.15)
+     * @return StandardColor enum of detected color, UNKNOWN if no match, error or clipped sample
+     * @note Chromatic colors are matched on hue and saturation only, so the
+     *       result does not change with illuminance. WHITE and BLACK still
+     *       depend on intensity.
+     */
+    StandardColor detectColorChromaticity(float tolerance = 0.15f);
+
+    /**
+     * @brief Set the analog gain of the color channels
+     * @param gain AGAIN_1X, AGAIN_4X, AGAIN_16X or AGAIN_64X
+     * @return true if the sensor accepted the setting, false otherwise
+     * @note Calibration is rescaled to the new gain, no recalibration needed
+     */
+    bool setGain(uint8_t gain);
+
+    /**
+     * @brief Get the current analog gain
+     * @return AGAIN_1X..AGAIN_64X
+     */
+    uint8_t getGain() const;
+
+    /**
+     * @brief Set the ALS integration time
+     * @param atime ATIME register value; integration lasts (256 - atime) * 2.78 ms
+     * @return true if the sensor accepted the setting, false otherwise
+     * @note Calibration is rescaled to the new integration time, no recalibration needed
+     */
+    bool setIntegrationTime(uint8_t atime);
+
+    /**
+     * @brief Get the current ATIME register value
+     * @return ATIME (0-255)
+     */
+    uint8_t getIntegrationTime() const;
+
+    /**
+     * @brief Get the current integration time in microseconds
+     * @return (256 - ATIME) * INTEGRATION_CYCLE_US
+     */
+    uint32_t getIntegrationTimeUs() const;
+
+    /**
+     * @brief Set the idle time of the sensor between integrations (WTIME)
+     * @param waitUs Wait in microseconds (0 disables the wait state, maximum 8.54 s)
+     * @return true if the sensor accepted the setting, false otherwise
+     * @note Rounded to 2.78 ms steps, or 33.4 ms steps above 712 ms (WLONG)
+     */
+    bool setWaitTime(uint32_t waitUs);
+
+    /**
+     * @brief Get the wait time between integrations
+     * @return Programmed wait in microseconds (0 if disabled)
+     */
+    uint32_t getWaitTimeUs() const;
+
+    /**
+     * @brief Get the time between two fresh results
+     * @return Integration time plus wait time in microseconds
+     */
+    uint32_t getSamplePeriodUs() const;
+
+    /**
+     * @brief Get the largest count a channel can reach at the current ATIME
+     * @return min(65535, (256 - ATIME) * COUNTS_PER_CYCLE)
+     */
+    uint16_t getFullScale() const;
+
+    /**
+     * @brief Get the count at or above which a channel is treated as clipped
+     * @return Full scale at the current ATIME minus a quarter cycle, at most SATURATION_THRESHOLD
+     * @note The single clipping definition behind saturated masks, calibration
+     *       checks and the white balance tracker
+     */
+    uint16_t getSaturationLevel() const;
+
+    /**
+     * @brief Measure the real ratios between the four gain settings
+     * @param samplesPerGain Readings averaged at each gain (default: 8)
+     * @return true if every clear-channel ratio was measured, false if nominal values were kept
+     * @note Measures C, R, G and B separately; a color channel too weak to
+     *       measure takes the clear channel's ratio
+     * @note Point the sensor at a stable, moderately lit target; takes about
+     *       4 * (samplesPerGain + 1) integration periods
+     */
+    bool calibrateGainRatios(uint8_t samplesPerGain = 8);
+
+    /**
+     * @brief Get the gain factor of a setting relative to AGAIN_1X
+     * @param gain AGAIN_1X..AGAIN_64X
+     * @param channel 0 = clear (default), 1 = red, 2 = green, 3 = blue
+     * @return Measured (or nominal 1/4/16/64) factor, 0 for invalid gain or channel
+     */
+    float getGainRatio(uint8_t gain, uint8_t channel = 0) const;
+
+    /**
+     * @brief Get the calibration white reference and its exposure
+     * @return Reference to the stored CalibrationData
+     */
+    const CalibrationData &getCalibrationData() const;
+
+    /**
+     * @brief Get the quality report of the last calibrate() run
+     * @return Reference to the report (result is CHECK_NOT_RUN before any calibration)
+     * @note Use report.result == CHECK_PASSED to gate automatic start-up
+     */
+    const CalibrationReport &getCalibrationReport() const;
+
+    /**
+     * @brief Get human-readable name of a calibration check result
+     * @param check CalibrationCheck enum value
+     * @return Constant string with the check name
+     */
+    static const char *getCalibrationCheckName(CalibrationCheck check);
+
+    /**
+     * @brief Enable or disable continuous white-balance adaptation
+     * @param enable true to track the white point from the sample stream
+     * @note Only bright, near-neutral samples update the white reference;
+     *       the first update clears the active profile (getActiveProfile() = -1)
+     */
+    void enableAdaptiveWhiteBalance(bool enable);
+
+    /**
+     * @brief Configure the speed of white-balance adaptation
+     * @param timeConstantShift EMA weight 1/2^shift per accepted sample (default: 8)
+     * @param maxStepShift Largest change per sample, 1/2^shift of the reference (default: 10)
+     */
+    void setWhiteBalanceAdaptation(uint8_t timeConstantShift, uint8_t maxStepShift);
+
+    /**
+     * @brief Freeze or resume white-balance adaptation
+     * @param frozen true to hold the current white reference (e.g. while a
+     *               large neutral part passes the sensor)
+     */
+    void freezeWhiteBalance(bool frozen);
+
+    /**
+     * @brief Check if adaptive white balance is enabled and not frozen
+     * @return true if samples currently update the white reference
+     */
+    bool isWhiteBalanceAdapting() const;
+
+    /**
+     * @brief Store the current calibration and transfer matrix as a named profile
+     * @param name Profile name (truncated to PROFILE_NAME_LENGTH - 1 characters)
+     * @param captureSignature If true, reads the sensor to record the scene
+     *                         signature used by autoSelectProfile()
+     * @return Profile index, -1 if not calibrated or all slots are used
+     * @note A profile with the same name is overwritten
+     */
+    int8_t saveProfile(const char *name, bool captureSignature = true);
+
+    /**
+     * @brief Activate a stored profile (O(1), no sensor access)
+     * @param index Profile index (0 to getProfileCount() - 1)
+     * @return true if selected, false for invalid index
+     * @note The calibration status and transfer matrix become the ones saved with the profile
+     */
+    bool selectProfile(uint8_t index);
+
+    /**
+     * @brief Activate a stored profile by name
+     * @param name Profile name
+     * @return true if found and selected, false otherwise
+     */
+    bool selectProfile(const char *name);
+
+    /**
+     * @brief Find a stored profile by name
+     * @param name Profile name
+     * @return Profile index, -1 if not found
+     */
+    int8_t findProfile(const char *name) const;
+
+    /**
+     * @brief Delete a stored profile
+     * @param index Profile index
+     * @return true if removed, false for invalid index
+     * @note Later profiles move down by one index
+     */
+    bool removeProfile(uint8_t index);
+
+    /**
+     * @brief Get the number of stored profiles
+     * @return 0 to MAX_PROFILES
+     */
+    uint8_t getProfileCount() const;
+
+    /**
+     * @brief Get the name of a stored profile
+     * @param index Profile index
+     * @return Profile name, empty string for invalid index
+     */
+    const char *getProfileName(uint8_t index) const;
+
+    /**
+     * @brief Get the index of the active profile
+     * @return Profile index, -1 if the calibration in use is not a stored profile
+     */
+    int8_t getActiveProfile() const;
+
+    /**
+     * @brief Select the profile whose scene signature best matches the current light
+     * @return Selected profile index, -1 if no profile has a signature or read error
+     * @note Point the sensor at the same reference surface used when saving profiles.
+     *       With differential capture the signature comes from the LED-off integration.
+     */
+    int8_t autoSelectProfile();
+
+    /**
+     * @brief Copy the complete calibration state into a storable blob
+     * @param blob Reference to CalibrationBlob to fill (checksum included)
+     */
+    void exportCalibration(CalibrationBlob &blob) const;
+
+    /**
+     * @brief Restore calibration state from a blob
+     * @param blob Blob previously filled by exportCalibration()
+     * @return true if restored, false on bad magic, version or checksum
+     */
+    bool importCalibration(const CalibrationBlob &blob);
+
+    /**
+     * @brief Synchronize the integration time to the mains flicker
+     * @param mains Mains frequency (MAINS_ANY rejects both 50 and 60 Hz)
+     * @return true on success, false on bus error
+     * @note Rounds the current integration time to the nearest whole number
+     *       of flicker periods (MAINS_NONE only disables phase averaging)
+     */
+    bool enableFlickerRejection(MainsFrequency mains = MAINS_ANY);
+
+    /**
+     * @brief Get the mains frequency used for flicker rejection
+     * @return MainsFrequency set by enableFlickerRejection() (MAINS_NONE by default)
+     */
+    MainsFrequency getMainsFrequency() const;
+
+    /**
+     * @brief Detect the mains frequency from the flicker of the light on the target
+     * @param samples Readings per probe, at phases spread over 50 ms (minimum 4)
+     * @return MAINS_50HZ, MAINS_60HZ, MAINS_NONE if no flicker, MAINS_ANY if undecided
+     *         or on read error
+     * @note Takes about samples * 100 ms; integration time is restored afterwards
+     */
+    MainsFrequency detectMainsFrequency(uint8_t samples = 12);
+
+    /**
+     * @brief Measure the flicker ripple left at the current integration time
+     * @param ripple Reference receiving the clear channel peak-to-peak / mean (0.01 = 1%)
+     * @param samples Readings at phases spread over 50 ms (minimum 2; raised to a count
+     *                coprime with 30 so no phase repeats at 50 or 60 Hz)
+     * @return true if measured, false on read error or dark target
+     */
+    bool measureFlickerRipple(float &ripple, uint8_t samples = 12);
+
+    /**
+     * @brief Average every reading over integrations started at spread mains phases
+     * @param phases Integrations per reading (0 or 1 disables)
+     * @note Each reading then takes about phases integration periods
+     */
+    void setFlickerAveraging(uint8_t phases);
+
+    /**
+     * @brief Average a fixed number of fresh integrations per reading
+     * @param samples Integrations per reading (clamped to MAX_OVERSAMPLING, 0 or 1 disables)
+     * @note Each reading then takes about samples integration periods
+     */
+    void setOversampling(uint8_t samples);
+
+    /**
+     * @brief Average fresh integrations until a target SNR is reached
+     * @param snr Clear-channel SNR of the decimated value to reach (0 disables)
+     * @param maxSamples Latency bound in integrations (4-MAX_OVERSAMPLING)
+     */
+    void setOversamplingTargetSNR(float snr, uint8_t maxSamples = MAX_OVERSAMPLING);
+
+    /**
+     * @brief Get the cost and benefit of the last oversampled reading
+     * @return Reference to the report (samples is 0 before the first one)
+     */
+    const OversamplingReport &getOversamplingReport() const;
+
+    /**
+     * @brief Set the exposures merged by readHDR()
+     * @param exposures Array of 2 to MAX_HDR_EXPOSURES settings (copied)
+     * @param count Number of settings
+     * @return true if accepted, false on bad count or gain
+     */
+    bool setHDRExposures(const ExposureSetting *exposures, uint8_t count);
+
+    /**
+     * @brief Get the dynamic range gained by the HDR exposures
+     * @return Ratio of the most to the least sensitive exposure (1.0 if none set)
+     */
+    float getHDRDynamicRangeGain() const;
+
+    /**
+     * @brief Acquire one extended-range sample from back-to-back exposures
+     * @param hdr Reference receiving the merged sample
+     * @return true on success, false if no exposures are set, on read error or
+     *         if the current exposure could not be restored
+     * @note Takes the sum of all integration times; the current exposure is
+     *       restored afterwards. If that fails, every following read retries
+     *       the restore first and fails until it succeeds
+     */
+    bool readHDR(HDRColor &hdr);
+
+    /**
+     * @brief Normalize an HDR sample against the calibration white reference
+     * @param hdr Sample from readHDR()
+     * @param rgb Reference receiving 0-65535 values (highlights clamp at white)
+     * @note Keeps the fractional resolution of dark targets
+     */
+    void normalizeHDR(const HDRColor &hdr, RGB16 &rgb) const;
+
+    /**
+     * @brief Set the function that switches the illumination LED
+     * @param callback Function called with true/false to switch the LED (nullptr disables)
+     * @param context Pointer handed back to the callback
+     * @param settleUs Delay after switching before the integration starts
+     */
+    void setIllumination(IlluminationCallback callback, void *context = nullptr, uint16_t settleUs = 0);
+
+    /**
+     * @brief Cancel ambient light with paired LED-on/LED-off integrations
+     * @param enabled true: every reading is lit minus ambient (needs setIllumination())
+     * @note Each reading then takes two integration periods; the white
+     *       reference must come from calibrateDifferential()
+     */
+    void setDifferentialCapture(bool enabled);
+
+    /**
+     * @brief Check if readings are differential
+     * @return true if differential capture is enabled and an LED callback is set
+     */
+    bool isDifferentialCapture() const;
+
+    /**
+     * @brief Calibrate the white reference from the LED reflection of a white target
+     * @param pairs LED-on/LED-off pairs to average (minimum 1)
+     * @return true on success, false without LED callback, on read error or if
+     *         the LED adds less than MIN_THRESHOLD counts
+     * @note Ambient light may change during the calibration
+     */
+    bool calibrateDifferential(uint8_t pairs = 8);
+
+    /**
+     * @brief Get the two integrations behind the last differential reading
+     * @return Reference to the report
+     */
+    const DifferentialReport &getDifferentialReport() const;
+
+    /**
+     * @brief Recover automatically from failed sensor reads
+     * @param sdaPin SDA pin for the bus-clear sequence (-1: no bus clear)
+     * @param sclPin SCL pin for the bus-clear sequence (-1: no bus clear)
+     * @param maxRetries Recovery attempts per failed read (minimum 1)
+     * @param maxBackoffMs Upper bound of the doubling delay between attempts
+     * @note The white reference is kept: the exposure is restored from the shadow
+     */
+    void enableBusRecovery(int8_t sdaPin, int8_t sclPin, uint8_t maxRetries = DEFAULT_RECOVERY_RETRIES,
+                           uint16_t maxBackoffMs = DEFAULT_MAX_BACKOFF_MS);
+
+    /**
+     * @brief Stop recovering from failed reads (they return false directly)
+     */
+    void disableBusRecovery();
+
+    /**
+     * @brief Bring the bus and the sensor back after an error
+     * @return true if the sensor responds with the configured exposure
+     * @note Called automatically by failed reads once enableBusRecovery() is set
+     */
+    bool recoverBus();
+
+    /**
+     * @brief Get the cause of the last failed bus transaction
+     * @return BusError (BUS_OK if the last transaction succeeded)
+     */
+    BusError getLastBusError() const;
+
+    /**
+     * @brief Get the bus error and recovery statistics
+     * @return Reference to the report
+     */
+    const RecoveryReport &getRecoveryReport() const;
+
+    /**
+     * @brief Replace the figures used by the energy model
+     * @param model Supply voltage and currents
+     * @note Totals accumulated so far keep the previous figures
+     */
+    void setEnergyModel(const EnergyModel &model);
+
+    /**
+     * @brief Get the figures used by the energy model
+     * @return Reference to the model
+     */
+    const EnergyModel &getEnergyModel() const;
+
+    /**
+     * @brief Bring the energy totals up to date and return them
+     * @return Reference to the report
+     * @note Totals advance on every read; call at least once per 70 minutes
+     *       when idle (micros() wrap)
+     */
+    const EnergyReport &getEnergyReport();
+
+    /**
+     * @brief Restart the energy totals from now
+     */
+    void resetEnergyReport();
+
+    /**
+     * @brief Get human-readable name of a bus error
+     * @param error Error to name
+     * @return String representation of the error
+     */
+    static const char *getBusErrorName(BusError error);
+
 private:
+    // APDS9960 register map (subset used by this library)
+    static const uint8_t I2C_ADDRESS = 0x39;   ///< Fixed 7-bit I2C address
+    static const uint8_t REG_ENABLE = 0x80;    ///< Power and function enable
+    static const uint8_t REG_ATIME = 0x81;     ///< ALS integration time
+    static const uint8_t REG_WTIME = 0x83;     ///< Wait time between ALS cycles
+    static const uint8_t REG_CONFIG1 = 0x8D;   ///< Configuration 1 (WLONG)
+    static const uint8_t REG_CONTROL = 0x8F;   ///< LED drive and gain control
+    static const uint8_t REG_STATUS = 0x93;    ///< Device status
+    static const uint8_t REG_CDATAL = 0x94;    ///< First color data register (C, R, G, B low/high)
+    static const uint8_t ENABLE_PON = 0x01;    ///< Power on bit of REG_ENABLE
+    static const uint8_t ENABLE_AEN = 0x02;    ///< ALS enable bit of REG_ENABLE
+    static const uint8_t ENABLE_WEN = 0x08;    ///< Wait enable bit of REG_ENABLE
+    static const uint8_t CONFIG1_WLONG = 0x02; ///< Wait x12 bit of REG_CONFIG1
+    static const uint8_t STATUS_AVALID = 0x01; ///< ALS data valid bit of REG_STATUS
+    static const uint8_t STATUS_CPSAT = 0x80;  ///< Clear photodiode saturation bit of REG_STATUS
+    static const uint8_t REG_CICLEAR = 0xE6;   ///< Clear channel interrupt clear (address-only command)
+
+    CalibrationData calibration;          ///< White reference at its calibration exposure
+    uint16_t gainRatios[GAIN_COUNT][4];   ///< Gain factors relative to 1x per channel (C, R, G, B; Q8.8)
+    uint8_t currentGain;                  ///< Shadow of the AGAIN setting
+    uint8_t currentATime;                 ///< Shadow of the ATIME register
+    uint8_t currentWTime;                 ///< Shadow of the WTIME register
+    bool currentWaitLong;                 ///< Shadow of the WLONG bit
+    bool waitEnabled;                     ///< Shadow of the WEN bit
+    uint8_t enableShadow;                 ///< ENABLE as last written or read (PON/AEN drive the energy model)
+    uint8_t heldEnable;                   ///< ENABLE saved by holdIntegration() (0 = not held)
+
+    bool whiteBalanceAdaptive;            ///< Adaptive white balance enabled
+    bool whiteBalanceFrozen;              ///< Adaptation temporarily held
+    uint8_t wbTimeConstantShift;          ///< EMA weight 1/2^shift
+    uint8_t wbMaxStepShift;               ///< Step bound 1/2^shift of the reference
+    uint32_t wbState[4];                  ///< Filtered white reference C/R/G/B (Q24.8)
+
+    MainsFrequency mainsFrequency;        ///< Mains frequency for flicker rejection
+    uint8_t flickerPhases;                ///< Integrations averaged per reading (0/1 = off)
+
+    uint8_t oversampleCount;              ///< Fixed integrations per reading (0/1 = off)
+    float oversampleTargetSNR;            ///< SNR to reach in adaptive mode (0 = fixed count)
+    uint8_t oversampleMaxSamples;         ///< Integration bound in adaptive mode
+    bool oversampleValid;                 ///< Last readRawData() was oversampled
+    uint32_t oversampleMeanQ8[4];         ///< Last decimated C/R/G/B with 8 fractional bits
+    OversamplingReport oversamplingReport; ///< Cost and benefit of the last oversampled reading
+
+    ExposureSetting hdrExposures[MAX_HDR_EXPOSURES]; ///< Exposures merged by readHDR()
+    uint8_t hdrExposureCount;             ///< Valid entries in hdrExposures (0 = none)
+    bool exposureRestorePending;          ///< Sensor may still hold an HDR exposure
+    bool exposureSettling;                ///< Data registers may still hold a temporary exposure
+
+    IlluminationCallback illuminationCallback; ///< Switches the LED for differential capture
+    void *illuminationContext;            ///< Pointer handed to the callback
+    uint16_t illuminationSettleUs;        ///< LED settling time before an integration
+    bool differentialCapture;             ///< Readings are lit minus ambient
+    bool differentialLitFirst;            ///< Order of the next pair (alternates)
+    DifferentialReport differentialReport; ///< Integrations behind the last differential reading
+
+    uint8_t lastSaturatedMask;            ///< Clipped channels of the last readRawData()
+
+    BusError lastBusError;                ///< Cause of the last failed transaction
+    bool busRecoveryEnabled;              ///< Failed reads trigger recoverBus()
+    bool busRecoveryActive;               ///< recoverBus() is running (no nesting)
+    int8_t busSdaPin;                     ///< SDA pin for the bus clear (-1 = none)
+    int8_t busSclPin;                     ///< SCL pin for the bus clear (-1 = none)
+    uint8_t busMaxRetries;                ///< Recovery attempts per failed read
+    uint16_t busMaxBackoffMs;             ///< Upper bound of the retry delay
+    RecoveryReport recoveryReport;        ///< Bus error and recovery statistics
+    uint32_t busByteCount;                ///< Bytes moved by this library's transactions
+
+    EnergyModel energyModel;              ///< Figures of the energy model
+    EnergyReport energyReport;            ///< Running energy totals
+    bool energyTracking;                  ///< begin() was called, the sensor draws current
+    uint32_t energyLastUs;                ///< micros() of the last accounting
+    uint32_t energyLastBusBytes;          ///< busByteCount at the last accounting
+    uint32_t energyAwakeUs;               ///< MCU awake time not yet charged
+    uint32_t energyLedOnUs;               ///< LED on time not yet charged
+    uint64_t energySensorPj;              ///< Sensor supply charged so far
+    uint64_t energyLedPj;                 ///< LED energy charged so far
+    uint64_t energyBusPj;                 ///< Bus energy charged so far
+    uint64_t energyMcuPj;                 ///< MCU energy charged so far
+    uint32_t energyActiveNw;              ///< Sensor power while integrating (from energyModel)
+    uint32_t energyWaitNw;                ///< Sensor power in the wait state (from energyModel)
+    uint32_t energySleepNw;               ///< Sensor power with PON cleared (from energyModel)
+    uint32_t energyLedNw;                 ///< LED power (from energyModel)
+    uint32_t energyMcuNw;                 ///< MCU awake power (from energyModel)
+    uint32_t energyBytePj;                ///< Energy of one bus byte (from energyModel)
+
+    CalibrationProfile profiles[MAX_PROFILES]; ///< Stored illuminant profiles
+    uint8_t profileCount;                 ///< Valid entries in profiles
+    int8_t activeProfile;                 ///< Selected profile, -1 if none
+
     CalibrationStatus calibrationStatus;  ///< Current calibration state
-    uint16_t max_ambient;                 ///< Maximum ambient light during calibration
-    uint16_t max_red;                     ///< Maximum red value during calibration
-    uint16_t max_green;                   ///< Maximum green value during calibration
-    uint16_t max_blue;                    ///< Maximum blue value during calibration
+    CalibrationReport calibrationReport;  ///< Quality metrics of the last calibration
+    uint16_t max_ambient;                 ///< Clear white reference at the current exposure
+    uint16_t max_red;                     ///< Red white reference at the current exposure
+    uint16_t max_green;                   ///< Green white reference at the current exposure
+    uint16_t max_blue;                    ///< Blue white reference at the current exposure
+
+    TransferMatrix transferMatrix;        ///< Unit-to-canonical transfer matrix
+    bool transferEnabled;                 ///< transferMatrix is applied on the 16-bit path
+    const uint16_t *correctionLUT;        ///< Optional 3D correction LUT (nullptr = disabled)
+    uint8_t correctionLUTSize;            ///< Nodes per axis of correctionLUT
+    bool correctionLUTInProgmem;          ///< correctionLUT lives in AVR flash
+    uint8_t expectedLUTSize;              ///< LUT size recorded in the last imported blob (0 = any)
+    uint16_t expectedLUTChecksum;         ///< LUT checksum recorded in the last imported blob
 
     SparkFun_APDS9960 sensor;  ///< Underlying sensor object from SparkFun library
 
@@ -265,9 +1446,212 @@ private:
      * @brief Validate collected calibration data
      * @param samples Number of samples collected
      * @param minSamples Minimum required samples
-     * @return true if data meets quality criteria, false otherwise
+     * @return CHECK_PASSED if data meets quality criteria, otherwise the failing check
+     */
+    CalibrationCheck validateCalibrationData(int samples, int minSamples) const;
+
+    /**
+     * @brief Apply default calibration if the sensor was never calibrated
+     */
+    void ensureCalibrated();
+
+    /**
+     * @brief Store the current max values as white reference for the current exposure
+     */
+    void storeCalibrationReference();
+
+    /**
+     * @brief Rescale the white reference to the current gain and integration time
+     * @note O(1): called whenever gain, ATIME or calibration change
+     */
+    void updateActiveCalibration();
+
+    /**
+     * @brief Update the white reference from one sample (adaptive white balance)
+     * @param raw Freshly read sample
+     */
+    void adaptWhiteBalance(const RawColor &raw);
+
+    /**
+     * @brief Re-seed the white-balance filter from the active white reference
+     */
+    void resetWhiteBalanceTracking();
+
+    /**
+     * @brief Read the sensor and compute the signature of the ambient light
+     * @param signature Array of 3 values receiving the signature
+     * @return true on success, false on sensor read error
+     */
+    bool readSceneSignature(uint16_t signature[3]);
+
+    /**
+     * @brief Compute the scene signature (R/G/B relative to clear) of a sample
+     * @param raw Sample to describe
+     * @param signature Array of 3 values receiving the signature
+     */
+    static void computeSignature(const RawColor &raw, uint16_t signature[3]);
+
+    /**
+     * @brief Read raw data, fetching only the channels the caller consumes
+     * @param raw Reference to RawColor struct to populate
+     * @param channelMask ChannelMask bits needed (averaging paths read all)
+     * @return true if read successful, false otherwise
+     */
+    bool readRawChannels(RawColor &raw, uint8_t channelMask);
+
+    /**
+     * @brief Read channels without any processing
+     * @param raw Reference to RawColor struct to populate
+     * @param channelMask ChannelMask bits to read
+     * @return true if all requested channels were read
+     */
+    bool readSensorChannels(RawColor &raw, uint8_t channelMask = CHANNEL_ALL);
+
+    /**
+     * @brief Read channels once in a single burst
+     * @param raw Reference to RawColor struct to populate
+     * @param channelMask ChannelMask bits to read (not 0)
+     * @return true if all requested channels were read
+     */
+    bool readChannelRegisters(RawColor &raw, uint8_t channelMask);
+
+    /**
+     * @brief Release a bus held low by a slave (9 SCL pulses and a STOP)
+     * @return true if SDA is released afterwards
+     */
+    bool clearBus();
+
+    /**
+     * @brief Re-initialize the sensor and re-apply the register shadow
+     * @return true if all registers were written
+     */
+    bool reinitializeSensor();
+
+    /**
+     * @brief Record the result of Wire.endTransmission()
+     * @param result Return value of endTransmission()
+     * @return true if the transaction succeeded
      */
-    bool validateCalibrationData(int samples, int minSamples) const;
+    bool recordBusResult(uint8_t result);
+
+    /**
+     * @brief Charge the energy used since the last accounting to the totals
+     */
+    void accountEnergy();
+
+    /**
+     * @brief Update the ENABLE shadow, charging the time spent in the old state first
+     * @param enable ENABLE value now in the sensor
+     */
+    void trackEnable(uint8_t enable);
+
+    /**
+     * @brief Convert the figures of energyModel to the integer rates used by accountEnergy()
+     */
+    void updateEnergyRates();
+
+    /**
+     * @brief Take one LED-on and one LED-off integration and subtract them
+     * @param reflectance Reference receiving lit minus ambient (clamped at 0)
+     * @return true on success, false on bus error
+     */
+    bool readDifferential(RawColor &reflectance);
+
+    /**
+     * @brief Switch the LED and read one integration started after the switch
+     * @param ledOn LED state during the integration
+     * @param raw Reference receiving the channels
+     * @param doneUs Reference receiving micros() when the integration was seen complete
+     * @return true on success, false on bus error or timeout
+     */
+    bool captureIlluminated(bool ledOn, RawColor &raw, unsigned long &doneUs);
+
+    /**
+     * @brief Accumulate fresh integrations and decimate them into one reading
+     * @param raw Reference receiving the rounded channel averages
+     * @return true on success, false on read error
+     */
+    bool readOversampled(RawColor &raw);
+
+    /**
+     * @brief Normalize the last oversampled reading with its fractional bits
+     * @param rgb Reference to RGB16 struct to populate
+     */
+    void normalizeOversampled(RGB16 &rgb) const;
+
+    /**
+     * @brief Apply the transfer matrix and the correction LUT, if set
+     * @param rgb Normalized color, corrected in place
+     */
+    void applyCorrections(RGB16 &rgb) const;
+
+    /**
+     * @brief Normalize a Q24.8 count to the 16-bit RGB range
+     * @param valueQ8 Count with 8 fractional bits
+     * @param maxValue Maximum value from calibration
+     * @return valueQ8 * 65535 / (maxValue * 256), clamped (0 if maxValue is 0)
+     */
+    static uint16_t normalizeQ8ToRGB16(uint32_t valueQ8, uint16_t maxValue);
+
+    /**
+     * @brief Program the shadow gain and ATIME again after a temporary exposure
+     * @return true if the sensor holds the current exposure again
+     */
+    bool restoreExposure();
+
+    /**
+     * @brief Make sure the next data read comes from the current exposure
+     * @return true if the data registers hold counts at the current exposure
+     */
+    bool settleExposure();
+
+    /**
+     * @brief Restart the ALS integration so the next one starts now
+     * @return true on success, false on bus error
+     */
+    bool restartIntegration();
+
+    /**
+     * @brief Average integrations started at evenly spread phases of a period
+     * @param phases Number of integrations
+     * @param periodUs Period whose phases are covered
+     * @param average Reference receiving the channel averages
+     * @param clearMin Reference receiving the smallest clear reading
+     * @param clearMax Reference receiving the largest clear reading
+     * @return true if all integrations were read
+     */
+    bool samplePhases(uint8_t phases, uint32_t periodUs, RawColor &average,
+                      uint16_t &clearMin, uint16_t &clearMax);
+
+    /**
+     * @brief Get the count at or above which a channel is treated as clipped at an ATIME
+     * @param atime ATIME register value
+     * @return Full scale minus a quarter cycle, at most SATURATION_THRESHOLD
+     */
+    static uint16_t getSaturationLevel(uint8_t atime);
+
+    /**
+     * @brief Send an address-only special function command
+     * @param command Command register address
+     * @return true if the sensor acknowledged the command
+     */
+    bool writeCommand(uint8_t command);
+
+    /**
+     * @brief Write one sensor register
+     * @param reg Register address
+     * @param value Value to write
+     * @return true if the sensor acknowledged the write
+     */
+    bool writeRegister(uint8_t reg, uint8_t value);
+
+    /**
+     * @brief Read one sensor register
+     * @param reg Register address
+     * @param value Reference receiving the register content
+     * @return true if the read succeeded
+     */
+    bool readRegister(uint8_t reg, uint8_t &value);
 };
 
 /**
@@ -279,4 +1663,29 @@ private:
  */
 uint8_t normalizeToRGB(uint16_t rawValue, uint16_t maxValue);
 
+/**
+ * @brief Normalize a 16-bit raw value to the full 16-bit RGB range
+ * @param rawValue Raw sensor reading (0-65535)
+ * @param maxValue Maximum value from calibration
+ * @return Normalized value (0-65535)
+ * @note Handles overflow protection and division by zero
+ */
+uint16_t normalizeToRGB16(uint16_t rawValue, uint16_t maxValue);
+
+/**
+ * @brief Encode a linear 16-bit channel value to 8-bit sRGB
+ * @param linearValue Linear channel value (0-65535)
+ * @return sRGB-encoded value (0-255)
+ * @note Table lookup in flash, no floating point
+ */
+uint8_t linearToSRGB(uint16_t linearValue);
+
+/**
+ * @brief Decode an 8-bit sRGB value to linear 16-bit
+ * @param srgbValue sRGB-encoded value (0-255)
+ * @return Linear channel value (0-65535)
+ * @note Use it to express palettes defined in sRGB in sensor space
+ */
+uint16_t sRGBToLinear(uint8_t srgbValue);
+
 #endif //MANIGLIO_APDS_LIBRARY_APDS9960_COLORSENSOR_H
\ No newline at end of file
@@ -0,0 +1,198 @@
+/**
+ * @file APDS9960_HealthMonitor.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Health monitor for the sample stream of an APDS9960 color sensor
+ *
+ * Watches the samples from readSample() for the failure modes that do not
+ * show up as bus errors: frozen values (e.g. after an ESD event), dead
+ * channels, abnormal noise and drift of the white reference. Each sample
+ * costs a handful of integer operations per channel and no buffers.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_HEALTHMONITOR_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_HEALTHMONITOR_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class SensorHealthMonitor
+ * @brief O(1) anomaly detection on ColorSample streams
+ *
+ * Call configure() after calibration, then feed every sample to update()
+ * and, whenever the sensor looks at the white reference, to
+ * updateReference(). getState() reports the most severe anomaly; an
+ * optional callback fires on every state change.
+ */
+class SensorHealthMonitor {
+public:
+    /**
+     * @enum HealthState
+     * @brief Sensor condition, in increasing order of severity
+     */
+    enum HealthState {
+        HEALTH_UNKNOWN,  ///< Not configured or still warming up
+        HEALTH_OK,       ///< No anomaly detected
+        HEALTH_DRIFT,    ///< White reference moved away from calibration
+        HEALTH_NOISY,    ///< Noise well above the calibration noise
+        HEALTH_DROPOUT,  ///< Channel reads zero while the clear channel sees light
+        HEALTH_STUCK     ///< Channel frozen, or no new integration for too long
+    };
+
+    /**
+     * @brief Callback invoked on every state change
+     * @param state New state
+     * @param channelMask Affected channels (bit 0 = C, 1 = R, 2 = G, 3 = B)
+     * @param context Pointer passed to setCallback()
+     */
+    typedef void (*HealthCallback)(HealthState state, uint8_t channelMask, void *context);
+
+    // Default limits
+    static const uint8_t DEFAULT_STUCK_SAMPLES = 32;    ///< Identical fresh samples that mean frozen
+    static const uint8_t DROPOUT_SAMPLES = 8;           ///< Consecutive zero readings that mean dead
+    static const uint8_t STALE_INTEGRATIONS = 4;        ///< Sample periods without fresh data that mean stopped
+    static const uint8_t NOISE_WARMUP_SAMPLES = 32;     ///< Fresh samples before the noise estimate is used
+    static const uint16_t DROPOUT_MIN_SIGNAL = 64;      ///< Counts above which no other channel reads zero
+
+    /**
+     * @brief Constructor - unconfigured, default limits, no callback
+     */
+    SensorHealthMonitor();
+
+    /**
+     * @brief Take the expected noise, white reference and sample period from a calibrated sensor
+     * @param sensor Sensor after calibrate() (or a restored profile)
+     * @note Noise is checked only if the calibration report holds statistics
+     */
+    void configure(const ADPS9960_ColorSensor &sensor);
+
+    /**
+     * @brief Set the time between two fresh samples
+     * @param periodUs Sample period, e.g. getSamplePeriodUs() after changing WTIME
+     * @note The stale check never uses less than the integration time of the sample
+     */
+    void setSamplePeriod(uint32_t periodUs);
+
+    /**
+     * @brief Set the anomaly limits
+     * @param stuckCount Identical fresh samples that mean frozen (minimum 2)
+     * @param noiseMultiple Noise above calibration stddev * multiple is abnormal (0 disables)
+     * @param driftRatio Relative white reference drift that is reported (0 disables)
+     */
+    void setLimits(uint8_t stuckCount, float noiseMultiple = 4.0f, float driftRatio = 0.05f);
+
+    /**
+     * @brief Set the function called on state changes
+     * @param function Function to call (nullptr disables)
+     * @param context Pointer handed back to the callback
+     */
+    void setCallback(HealthCallback function, void *context = nullptr);
+
+    /**
+     * @brief Feed one sample of the normal stream
+     * @param sample Sample from readSample()
+     * @return Current state
+     */
+    HealthState update(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Feed one sample taken on the white reference
+     * @param sample Sample from readSample() at the calibration exposure
+     * @return Current state
+     * @note Samples at another gain or ATIME are ignored
+     */
+    HealthState updateReference(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Get the most severe anomaly
+     * @return Current HealthState
+     */
+    HealthState getState() const;
+
+    /**
+     * @brief Get the channels behind the current state
+     * @return Bit mask (bit 0 = C, 1 = R, 2 = G, 3 = B)
+     */
+    uint8_t getChannelMask() const;
+
+    /**
+     * @brief Check if classification results can be trusted
+     * @return true in HEALTH_OK (and HEALTH_DRIFT, which recalibration fixes)
+     */
+    bool isHealthy() const;
+
+    /**
+     * @brief Get the measured noise of a channel
+     * @param channel 0 = C, 1 = R, 2 = G, 3 = B
+     * @return Standard deviation in counts (0 before enough samples)
+     */
+    float getNoise(uint8_t channel) const;
+
+    /**
+     * @brief Get the drift of the white reference for a channel
+     * @param channel 0 = C, 1 = R, 2 = G, 3 = B
+     * @return (reference - calibration) / calibration (0 without reference samples)
+     */
+    float getDrift(uint8_t channel) const;
+
+    /**
+     * @brief Get human-readable name of a health state
+     * @param state State to name
+     * @return String representation of the state
+     */
+    static const char *getStateName(HealthState state);
+
+    /**
+     * @brief Forget the sample history (keeps configuration and limits)
+     */
+    void reset();
+
+private:
+    static const uint8_t CHANNELS = 4;  ///< C, R, G, B
+
+    // Configuration
+    bool configured;                      ///< configure() was called
+    uint16_t whiteReference[CHANNELS];    ///< Calibration white reference
+    float calibrationNoise[CHANNELS];     ///< Calibration stddev per channel
+    uint32_t noiseLimitQ8[CHANNELS];      ///< Variance limit (Q8 counts^2, 0 = off)
+    int32_t noiseClamp[CHANNELS];         ///< Largest difference fed to the variance (counts)
+    uint8_t calibrationGain;              ///< Exposure of the calibration
+    uint8_t calibrationATime;             ///< Exposure of the calibration
+    uint32_t samplePeriodUs;              ///< Expected time between fresh samples
+    uint8_t stuckSamples;                 ///< Stuck limit
+    float noiseFactor;                    ///< Noise limit relative to calibration
+    float driftLimit;                     ///< Relative drift limit
+    HealthCallback callback;              ///< State change callback
+    void *callbackContext;                ///< Pointer handed to the callback
+
+    // Per-channel history
+    uint16_t lastValue[CHANNELS];         ///< Previous fresh value
+    uint8_t repeatCount[CHANNELS];        ///< Consecutive identical fresh values
+    uint8_t zeroCount[CHANNELS];          ///< Consecutive zeros under light
+    uint32_t varianceQ8[CHANNELS];        ///< EWMA of half the squared difference (Q8)
+    int32_t referenceQ8[CHANNELS];        ///< EWMA of the white reference samples (Q8)
+    uint32_t lastFreshUs;                 ///< Timestamp of the last fresh sample
+    uint8_t freshCount;                   ///< Fresh samples seen (saturates at 255)
+    uint8_t referenceCount;               ///< Reference samples seen (saturates at 255)
+
+    // Result
+    uint8_t stuckMask;                    ///< Frozen channels (0x0F if the sensor stopped)
+    uint8_t dropoutMask;                  ///< Dead channels
+    uint8_t noiseMask;                    ///< Noisy channels
+    uint8_t driftMask;                    ///< Drifted channels
+    HealthState state;                    ///< Current state
+    uint8_t channelMask;                  ///< Channels behind the state
+
+    /**
+     * @brief Recompute the variance limits and difference clamps from noiseFactor
+     */
+    void updateNoiseLimits();
+
+    /**
+     * @brief Derive the state from the history and notify on change
+     * @return New state
+     */
+    HealthState evaluate();
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_HEALTHMONITOR_H
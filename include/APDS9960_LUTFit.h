@@ -0,0 +1,38 @@
+/**
+ * @file APDS9960_LUTFit.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Fit of a per-unit 3D correction LUT, without Arduino dependencies
+ *
+ * A unit is characterized on reference patches whose true values are
+ * known: each patch gives one measured color and one reference color.
+ * The fit turns these scattered pairs into the node table used by
+ * ADPS9960_ColorSensor::setColorCorrectionLUT(). Like the transfer matrix
+ * fit, it only depends on <stdint.h>, so it runs on the device (through
+ * ADPS9960_ColorSensor::fitColorCorrectionLUT()) and on a host that fits
+ * units from logged measurements.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_LUTFIT_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_LUTFIT_H
+
+#include <stdint.h>
+
+/// Reference patches needed to fit a correction LUT
+static const uint16_t LUT_FIT_MIN_PATCHES = 8;
+
+/**
+ * @brief Fit a 3D correction LUT from measured/reference patch pairs
+ * @param measured Patches as measured by the unit, count x {r, g, b} (0-65535),
+ *                 the layout of an ADPS9960_ColorSensor::RGB16 array
+ * @param reference The true values of the same patches, same layout
+ * @param count Number of patches (at least LUT_FIT_MIN_PATCHES)
+ * @param gridSize Nodes per axis (2-33)
+ * @param lut Array of gridSize^3 * 3 receiving the node table, blue index fastest
+ *            (unchanged on failure)
+ * @return true on success, false on null pointers, too few patches or bad size
+ */
+bool fitCorrectionLUT(const uint16_t *measured, const uint16_t *reference, uint16_t count,
+                      uint8_t gridSize, uint16_t *lut);
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_LUTFIT_H
@@ -0,0 +1,111 @@
+/**
+ * @file APDS9960_MultiSensor.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Synchronized capture from several APDS9960 color sensors
+ *
+ * All APDS9960 share the fixed address 0x39, so several sensors sit behind
+ * an I2C multiplexer (e.g. TCA9548A) and a callback selects the channel of
+ * each one. Reading them one after the other with readRGB() lets every
+ * sensor see a moving part at a different moment; SynchronizedCapture
+ * starts their integrations back to back with one register write each and
+ * reads every result once its integration is complete.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_MULTISENSOR_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_MULTISENSOR_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class SynchronizedCapture
+ * @brief Multi-view samples from integrations started as close together as the bus allows
+ *
+ * Register each sensor (already begun and calibrated) with addSensor(),
+ * set the bus select callback, then call capture() once per part.
+ */
+class SynchronizedCapture {
+public:
+    static const uint8_t MAX_SENSORS = 8;  ///< Channels of a TCA9548A
+
+    /**
+     * @brief Routes the bus to one sensor
+     * @param index Sensor index in the order of addSensor()
+     * @param context Pointer passed to setBusSelect()
+     * @return true on success, false if the multiplexer did not answer
+     */
+    typedef bool (*BusSelectCallback)(uint8_t index, void *context);
+
+    /**
+     * @struct SensorView
+     * @brief One sensor's part of a multi-view sample
+     */
+    struct SensorView {
+        ADPS9960_ColorSensor::RawColor raw;       ///< Channels of the integration
+        ADPS9960_ColorSensor::Chromaticity chroma; ///< Chromaticity against the sensor's own calibration
+        uint32_t startOffsetUs;                   ///< Integration start after the first sensor's
+        uint8_t saturatedMask;                    ///< Clipped channels (bit 0 = C, 1 = R, 2 = G, 3 = B)
+    };
+
+    /**
+     * @struct MultiViewSample
+     * @brief Synchronized readings of all sensors, fused into one
+     */
+    struct MultiViewSample {
+        SensorView views[MAX_SENSORS];            ///< Per-sensor readings, in addSensor() order
+        ADPS9960_ColorSensor::Chromaticity fused; ///< Mean chromaticity of the valid, unclipped views
+        uint32_t timestampUs;                     ///< micros() at the first integration start
+        uint32_t skewUs;                          ///< Last integration start after the first
+        uint32_t cycleUs;                         ///< Duration of capture()
+        uint8_t count;                            ///< Sensors in the sample
+        uint8_t validMask;                        ///< Views read successfully (bit i = sensor i)
+    };
+
+    /**
+     * @brief Constructor - no sensors, no bus select callback
+     */
+    SynchronizedCapture();
+
+    /**
+     * @brief Add a sensor to the capture
+     * @param sensor Sensor object (must outlive the capture)
+     * @return true if added, false if MAX_SENSORS are registered
+     */
+    bool addSensor(ADPS9960_ColorSensor &sensor);
+
+    /**
+     * @brief Set the function that routes the bus to a sensor
+     * @param callback Multiplexer select function (nullptr: single sensor, no multiplexer)
+     * @param context Pointer handed back to the callback
+     */
+    void setBusSelect(BusSelectCallback callback, void *context = nullptr);
+
+    /**
+     * @brief Capture one synchronized multi-view sample
+     * @param sample Reference receiving the views and the fused result
+     * @return true if every view was read, false if any failed (see validMask)
+     * @note Takes the longest integration time plus the bus time of all sensors
+     */
+    bool capture(MultiViewSample &sample);
+
+    /**
+     * @brief Get the number of registered sensors
+     * @return Sensor count
+     */
+    uint8_t getSensorCount() const;
+
+private:
+    ADPS9960_ColorSensor *sensors[MAX_SENSORS]; ///< Registered sensors
+    uint8_t sensorCount;                        ///< Valid entries in sensors
+    BusSelectCallback busSelect;                ///< Multiplexer select function
+    void *busSelectContext;                     ///< Pointer handed to the callback
+
+    /**
+     * @brief Route the bus to a sensor
+     * @param index Sensor index
+     * @return true on success (always without callback)
+     */
+    bool select(uint8_t index);
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_MULTISENSOR_H
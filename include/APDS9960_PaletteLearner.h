@@ -0,0 +1,132 @@
+/**
+ * @file APDS9960_PaletteLearner.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Online discovery of the colors present in a sample stream
+ *
+ * For products whose colors are not known in advance, PaletteLearner
+ * clusters the live stream in OKLab, where distance follows perceived
+ * difference: a sample joins the nearest cluster within a radius and
+ * moves its centroid (sequential k-means), or opens a new cluster (leader
+ * clustering). Clusters that drift together are merged. The centroids
+ * export as a palette for findNearestColor().
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_PALETTELEARNER_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_PALETTELEARNER_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class PaletteLearner
+ * @brief Fixed-memory streaming clustering in OKLab
+ *
+ * Feed samples with update() while the product mix passes the sensor,
+ * then call exportPalette() and classify with
+ * ADPS9960_ColorSensor::findNearestColor(). Memory is fixed (MAX_CLUSTERS
+ * clusters); a sample costs one distance per cluster.
+ */
+class PaletteLearner {
+public:
+    static const uint8_t MAX_CLUSTERS = 16;     ///< Clusters kept at most
+    static const uint8_t MERGE_INTERVAL = 32;   ///< Samples between two merge passes
+    static const uint16_t DEFAULT_MAX_WEIGHT = 64; ///< Samples after which a centroid keeps tracking drift
+
+    /**
+     * @struct Cluster
+     * @brief One discovered color
+     */
+    struct Cluster {
+        ADPS9960_ColorSensor::OKLab centroid; ///< Mean color of the members
+        float spread;                         ///< Mean distance of the members to the centroid
+        uint16_t samples;                     ///< Members (halved with all others when it saturates)
+    };
+
+    /**
+     * @brief Constructor - radius 0.06, merge distance 0.03, no clusters
+     * @param colorSensor Calibrated sensor whose white reference normalizes the samples
+     */
+    explicit PaletteLearner(const ADPS9960_ColorSensor &colorSensor);
+
+    /**
+     * @brief Set the cluster distances
+     * @param radius OKLab distance beyond which a sample opens a new cluster
+     * @param mergeDistance Centroids closer than this are merged (below radius)
+     * @note About 0.02 is a just noticeable difference in OKLab
+     */
+    void setDistances(float radius, float mergeDistance);
+
+    /**
+     * @brief Set how long centroids keep adapting
+     * @param weight A centroid moves by at least 1/weight of each new member (minimum 1)
+     */
+    void setMaxWeight(uint16_t weight);
+
+    /**
+     * @brief Feed one sample
+     * @param sample Sample from readSample() or a recording
+     * @return Index of the cluster that took the sample, -1 if the sample was skipped
+     * @note Repeated, clipped and saturated samples are skipped
+     */
+    int8_t update(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Feed one color already converted to OKLab
+     * @param lab Color to cluster
+     * @return Index of the cluster that took the color
+     */
+    int8_t updateLab(const ADPS9960_ColorSensor::OKLab &lab);
+
+    /**
+     * @brief Get the number of clusters
+     * @return Clusters discovered so far (at most MAX_CLUSTERS)
+     */
+    uint8_t getClusterCount() const;
+
+    /**
+     * @brief Get one cluster
+     * @param index 0 to getClusterCount() - 1
+     * @return Reference to the cluster
+     * @note Indices change when clusters are merged or replaced
+     */
+    const Cluster &getCluster(uint8_t index) const;
+
+    /**
+     * @brief Export the centroids as a palette, most frequent first
+     * @param palette Array receiving the centroids
+     * @param maxEntries Size of palette
+     * @param minShare Clusters with a smaller share of all members are left out
+     *        (band edges, transitions, noise)
+     * @return Number of entries written
+     */
+    uint8_t exportPalette(ADPS9960_ColorSensor::OKLab *palette, uint8_t maxEntries,
+                          float minShare = 0.01f) const;
+
+    /**
+     * @brief Get the samples clustered since the last reset
+     * @return Sample count
+     */
+    uint32_t getSampleCount() const;
+
+    /**
+     * @brief Forget all clusters (keeps the settings)
+     */
+    void reset();
+
+private:
+    const ADPS9960_ColorSensor &sensor; ///< Source of the white reference
+    float radius2;                      ///< Squared new-cluster distance
+    float merge2;                       ///< Squared merge distance
+    uint16_t maxWeight;                 ///< Bound of the running-mean weight
+    Cluster clusters[MAX_CLUSTERS];     ///< Discovered colors
+    uint8_t clusterCount;               ///< Valid entries in clusters
+    uint8_t sinceMerge;                 ///< Samples since the last merge pass
+    uint32_t sampleCount;               ///< Samples since reset
+
+    /**
+     * @brief Merge every pair of clusters closer than the merge distance
+     */
+    void mergeClusters();
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_PALETTELEARNER_H
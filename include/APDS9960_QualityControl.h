@@ -0,0 +1,202 @@
+/**
+ * @file APDS9960_QualityControl.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Statistical process control of part colors against a golden sample
+ *
+ * Compares every part with a golden reference in OKLab. The tolerance
+ * applies to the color difference (DeltaE, the OKLab distance); the
+ * statistics run on the distance standardized by the golden noise of each
+ * axis, since lightness is usually noisier than a and b:
+ *
+ * - a single part beyond the tolerance or the 3-sigma limit is an outlier;
+ * - an EWMA chart catches small sustained shifts of the mean distance;
+ * - a one-sided CUSUM chart catches slow drift that stays inside every
+ *   single-part limit.
+ *
+ * The golden distribution is kept as its mean color and per-axis noise,
+ * and all statistics are updated in constant time in about 120 bytes of RAM.
+ * The noise must be the spread of good parts, not of repeated readings of
+ * one part: teach with one reading each of several known-good parts, or
+ * add the known part-to-part spread with setProcessSigma().
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_QUALITYCONTROL_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_QUALITYCONTROL_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class ColorQualityControl
+ * @brief Golden-sample DeltaE inspection with EWMA and CUSUM drift charts
+ *
+ * Teach the golden sample with addGoldenSample() and finishGolden() (or
+ * restore it with setGolden()), then call inspect() once per part. Feed
+ * addGoldenSample() one reading of each of at least MIN_GOLDEN_SAMPLES
+ * known-good parts: readings of a single part give only the sensor noise,
+ * and every normal part would then raise alarms.
+ */
+class ColorQualityControl {
+public:
+    static const uint8_t MIN_GOLDEN_SAMPLES = 8;  ///< Golden samples needed by finishGolden()
+
+    /**
+     * @enum QualityAlarm
+     * @brief Alarm bits of an inspection
+     */
+    enum QualityAlarm {
+        QC_OK = 0x00,                ///< Part and process in control
+        QC_OUT_OF_TOLERANCE = 0x01,  ///< DeltaE above the specified tolerance
+        QC_OUTLIER = 0x02,           ///< Standardized distance beyond its 3-sigma limit
+        QC_EWMA_SHIFT = 0x04,        ///< EWMA of the standardized distance above its control limit
+        QC_CUSUM_DRIFT = 0x08,       ///< CUSUM of the standardized distance above its decision interval
+        QC_NOT_READY = 0x80          ///< No golden reference, or the sample could not be used
+    };
+
+    /**
+     * @struct Golden
+     * @brief Golden reference distribution (store it to skip teaching)
+     */
+    struct Golden {
+        ADPS9960_ColorSensor::OKLab mean; ///< Mean color of the golden sample
+        float sigma[3];                   ///< Noise of each OKLab axis (L, a, b)
+        uint16_t samples;                 ///< Readings the reference was taught with
+    };
+
+    /**
+     * @struct Inspection
+     * @brief Result of one part
+     */
+    struct Inspection {
+        float deltaE;     ///< OKLab distance to the golden mean
+        float distance;   ///< Distance to the golden mean with each axis in golden sigmas
+        float ewma;       ///< EWMA of distance after this part
+        float cusum;      ///< Upper CUSUM after this part (in standard deviations of distance)
+        uint32_t part;    ///< Parts inspected since the charts were reset
+        uint8_t alarms;   ///< QualityAlarm bits
+    };
+
+    /**
+     * @brief Constructor - no golden sample, EWMA lambda 0.2 at 3 sigma, CUSUM k 0.5 h 5
+     * @param colorSensor Calibrated sensor whose white reference normalizes the samples
+     */
+    explicit ColorQualityControl(const ADPS9960_ColorSensor &colorSensor);
+
+    /**
+     * @brief Add one reading of the golden sample
+     * @param sample Sample from readSample() of one known-good part
+     * @return true if the sample was used (fresh and unclipped)
+     */
+    bool addGoldenSample(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Add one golden reading already converted to OKLab
+     * @param lab Golden color
+     */
+    void addGoldenLab(const ADPS9960_ColorSensor::OKLab &lab);
+
+    /**
+     * @brief Freeze the golden reference and reset the charts
+     * @return true if at least MIN_GOLDEN_SAMPLES were added
+     */
+    bool finishGolden();
+
+    /**
+     * @brief Restore a stored golden reference and reset the charts
+     * @param reference Reference from getGolden()
+     */
+    void setGolden(const Golden &reference);
+
+    /**
+     * @brief Set the part-to-part spread that teaching did not see
+     * @param sigma OKLab standard deviation per axis of good parts (0 = taught noise only)
+     * @note Added in quadrature to the golden sigma; needed when the golden was taught on a single part
+     */
+    void setProcessSigma(float sigma);
+
+    /**
+     * @brief Get the golden reference
+     * @return Reference (samples is 0 before finishGolden())
+     */
+    const Golden &getGolden() const;
+
+    /**
+     * @brief Set the specified color tolerance
+     * @param deltaE Largest acceptable OKLab distance (0 disables; about 0.02 is just noticeable)
+     */
+    void setTolerance(float deltaE);
+
+    /**
+     * @brief Set the EWMA chart
+     * @param weight Weight of the newest part (0.05-1.0; small values catch smaller shifts later)
+     * @param limitSigmas Control limit in sigmas of the EWMA
+     */
+    void setEwma(float weight, float limitSigmas = 3.0f);
+
+    /**
+     * @brief Set the CUSUM chart
+     * @param slack Allowance k in standard deviations of the distance (half the shift to detect)
+     * @param decisionInterval Alarm threshold h in standard deviations of the distance
+     */
+    void setCusum(float slack, float decisionInterval);
+
+    /**
+     * @brief Inspect one part
+     * @param sample Sample from readSample() (averaged or single)
+     * @param result Reference receiving the inspection
+     * @return QualityAlarm bits (QC_OK if the part and the process are in control)
+     */
+    uint8_t inspect(const ADPS9960_ColorSensor::ColorSample &sample, Inspection &result);
+
+    /**
+     * @brief Inspect one part already converted to OKLab
+     * @param lab Part color
+     * @param result Reference receiving the inspection
+     * @return QualityAlarm bits
+     */
+    uint8_t inspectLab(const ADPS9960_ColorSensor::OKLab &lab, Inspection &result);
+
+    /**
+     * @brief Get the direction of the process drift
+     * @param offset Reference receiving the EWMA of part - golden per OKLab axis
+     * @note dL < 0: parts got darker; da/db: towards red/yellow when positive
+     */
+    void getDrift(ADPS9960_ColorSensor::OKLab &offset) const;
+
+    /**
+     * @brief Restart the EWMA and CUSUM charts (e.g. after a process correction)
+     */
+    void resetCharts();
+
+private:
+    const ADPS9960_ColorSensor &sensor; ///< Source of the white reference
+    Golden golden;                      ///< Golden reference
+    float processSigma;                 ///< Part-to-part spread added to the golden sigma
+    float toleranceDeltaE;              ///< Specified tolerance (0 = off)
+    float lambda;                       ///< EWMA weight
+    float ewmaLimitSigmas;              ///< EWMA limit
+    float cusumSlack;                   ///< CUSUM allowance k
+    float cusumDecision;                ///< CUSUM threshold h
+
+    // Golden teaching (Welford)
+    uint16_t teachCount;                ///< Golden readings added
+    float teachMean[3];                 ///< Running mean L, a, b
+    float teachM2[3];                   ///< Running sum of squared deviations
+
+    // Standardization, derived from golden.sigma and processSigma
+    float axisScale[3];                 ///< 1 / golden noise per axis
+
+    // Charts
+    float ewma;                         ///< EWMA of the standardized distance
+    float ewmaStart;                    ///< (1 - lambda)^(2 * parts), for the start-up limit
+    float cusum;                        ///< Upper CUSUM (sigmas)
+    float drift[3];                     ///< EWMA of part - golden per axis
+    uint32_t parts;                     ///< Parts since the charts were reset
+
+    /**
+     * @brief Derive the per-axis standardization from golden.sigma
+     */
+    void updateLimits();
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_QUALITYCONTROL_H
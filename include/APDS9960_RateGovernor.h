@@ -0,0 +1,126 @@
+/**
+ * @file APDS9960_RateGovernor.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Adaptive sample-rate governor for APDS9960 color sensors
+ *
+ * Samples a static scene slowly and a changing one at full rate: the
+ * sample period drops to the ceiling rate as soon as brightness or color
+ * change faster than a threshold, and doubles back towards the floor rate
+ * while the signal stays stable. The period can drive the sensor's wait
+ * time (WTIME), the MCU polling loop, or both.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_RATEGOVERNOR_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_RATEGOVERNOR_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class SampleRateGovernor
+ * @brief Change-driven sample period with exponential back-off
+ *
+ * Feed every sample to update() and wait the returned period before the
+ * next one, or call apply() to let the sensor pace itself with WTIME.
+ */
+class SampleRateGovernor {
+public:
+    static const uint8_t DEFAULT_STABLE_SAMPLES = 4;  ///< Stable samples before each doubling
+
+    /**
+     * @brief Constructor - 1 Hz floor, 10 Hz ceiling, 5% brightness and 1% color thresholds
+     */
+    SampleRateGovernor();
+
+    /**
+     * @brief Set the slowest and fastest sample rates
+     * @param floorHz Rate of a stable scene (slower rates are clamped to about 0.11 Hz)
+     * @param ceilingHz Rate while the signal changes (at least floorHz)
+     * @note The ceiling is bounded by the integration time of the sensor
+     */
+    void setRateLimits(float floorHz, float ceilingHz);
+
+    /**
+     * @brief Set the change per sample that counts as activity
+     * @param brightnessChange Relative change of the clear channel (0.05 = 5%)
+     * @param colorChange Change of an R/G/B share of R+G+B (0.01 = 1 point)
+     */
+    void setThresholds(float brightnessChange, float colorChange);
+
+    /**
+     * @brief Set how quickly the rate backs off
+     * @param samplesPerDoubling Stable samples before each doubling of the period (minimum 1)
+     */
+    void setBackoff(uint8_t samplesPerDoubling);
+
+    /**
+     * @brief Feed one sample and get the period until the next one
+     * @param sample Sample from readSample() (repeated samples are ignored)
+     * @return Sample period in microseconds
+     */
+    uint32_t update(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Pace the sensor with its wait time to the current period
+     * @param sensor Sensor to program
+     * @return true on success or if nothing changed, false on bus error
+     * @note Writes only when the period changed since the last apply()
+     */
+    bool apply(ADPS9960_ColorSensor &sensor);
+
+    /**
+     * @brief Get the current sample period
+     * @return Period in microseconds
+     */
+    uint32_t getPeriodUs() const;
+
+    /**
+     * @brief Check if the governor runs at the ceiling rate
+     * @return true while the signal changes
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Get the achieved sample rate since the last reset
+     * @return Fresh samples per second (0 before two samples)
+     */
+    float getAverageRate() const;
+
+    /**
+     * @brief Get the fresh samples seen since the last reset
+     * @return Sample count
+     */
+    uint32_t getSampleCount() const;
+
+    /**
+     * @brief Get how often a change raised the rate to the ceiling
+     * @return Activity events since the last reset
+     */
+    uint32_t getEventCount() const;
+
+    /**
+     * @brief Forget the signal history and statistics; restart at the ceiling rate
+     */
+    void reset();
+
+private:
+    uint32_t minPeriodUs;            ///< Period at the ceiling rate
+    uint32_t maxPeriodUs;            ///< Period at the floor rate
+    uint32_t periodUs;               ///< Current period
+    uint32_t appliedPeriodUs;        ///< Period last written by apply() (0 = never)
+    uint16_t brightnessThresholdQ12; ///< Relative clear change (Q12)
+    uint16_t colorThresholdQ12;      ///< R/G/B share change (Q12)
+    uint8_t stableSamples;           ///< Stable samples before each doubling
+    uint8_t stableCount;             ///< Stable samples since the last change of period
+
+    bool hasLast;                    ///< lastClear/lastShare hold a sample
+    uint16_t lastClear;              ///< Clear channel of the previous sample
+    uint16_t lastShare[3];           ///< R/G/B shares of the previous sample (Q12)
+    uint32_t lastTimestampUs;        ///< Timestamp of the previous sample
+
+    uint32_t sampleCount;            ///< Fresh samples since reset
+    uint32_t eventCount;             ///< Activity events since reset
+    uint64_t elapsedUs;              ///< Time covered by the samples since reset
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_RATEGOVERNOR_H
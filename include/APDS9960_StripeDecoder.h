@@ -0,0 +1,151 @@
+/**
+ * @file APDS9960_StripeDecoder.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Streaming decoder for sequences of color bands (color barcodes)
+ *
+ * Turns the sample stream of a sensor watching painted bands pass by into
+ * symbol sequences: every fresh sample is classified like detectColor(),
+ * runs of the same class form bands, a class change must persist for a
+ * few samples before it opens a new band (hysteresis), and a stretch of
+ * background ends the sequence. Each band and sequence carries the share
+ * of its samples that agreed with the decoded symbol as confidence.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_STRIPEDECODER_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_STRIPEDECODER_H
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @class StripeDecoder
+ * @brief Run-length segmentation of classified samples into band sequences
+ *
+ * Feed every sample from readSample() (live or replayed) to update(); when
+ * it returns true, getSequence() holds the decoded bands. Run the sensor
+ * with the shortest integration time that still separates the colors: a
+ * band must last at least minBandSamples integrations to be seen.
+ */
+class StripeDecoder {
+public:
+    static const uint8_t MAX_BANDS = 16;              ///< Bands per sequence
+    static const uint8_t DEFAULT_MIN_BAND_SAMPLES = 2; ///< Samples that make a band
+    static const uint8_t DEFAULT_SWITCH_SAMPLES = 2;   ///< Samples of a new class that end a band
+    static const uint8_t DEFAULT_END_SAMPLES = 8;      ///< Background samples that end a sequence
+
+    /**
+     * @struct Band
+     * @brief One decoded color band
+     */
+    struct Band {
+        StandardColor symbol;   ///< Color of the band
+        uint8_t confidence;     ///< Samples agreeing with the symbol (0-255 = 0-100%)
+        uint16_t samples;       ///< Samples in the band
+        uint32_t startUs;       ///< Timestamp of the first sample of the band
+        uint32_t durationUs;    ///< Time from the first to the last sample of the band
+    };
+
+    /**
+     * @struct Sequence
+     * @brief Bands between two stretches of background
+     */
+    struct Sequence {
+        Band bands[MAX_BANDS];  ///< Bands in order of passage
+        uint8_t length;         ///< Valid entries in bands
+        bool truncated;         ///< More than MAX_BANDS bands were seen
+        float confidence;       ///< Confidence of the weakest band (0.0-1.0)
+        uint32_t startUs;       ///< Timestamp of the first sample of the first band
+        uint32_t durationUs;    ///< Time from the first to the last band sample
+    };
+
+    /**
+     * @brief Constructor
+     * @param colorSensor Calibrated sensor whose white reference classifies the samples
+     * @param classTolerance Classification tolerance, as for detectColor()
+     */
+    explicit StripeDecoder(const ADPS9960_ColorSensor &colorSensor, float classTolerance = 0.15f);
+
+    /**
+     * @brief Set the segmentation limits
+     * @param minBand Samples a band needs to be kept (minimum 1)
+     * @param switchAfter Consecutive samples of another class that end a band (minimum 1)
+     * @param endAfter Consecutive background samples that end a sequence (minimum 1)
+     */
+    void setSegmentation(uint8_t minBand, uint8_t switchAfter, uint8_t endAfter);
+
+    /**
+     * @brief Set the class seen between sequences
+     * @param symbol Class that is not a symbol (default BLACK; UNKNOWN samples count as background too)
+     */
+    void setBackground(StandardColor symbol);
+
+    /**
+     * @brief Feed one sample
+     * @param sample Sample from readSample() or a recording
+     * @return true when a sequence was completed (read it with getSequence())
+     * @note Repeated, clipped and saturated samples are skipped
+     */
+    bool update(const ADPS9960_ColorSensor::ColorSample &sample);
+
+    /**
+     * @brief Feed one already classified sample
+     * @param symbol Class of the sample
+     * @param timestampUs Time of the sample
+     * @return true when a sequence was completed
+     */
+    bool updateSymbol(StandardColor symbol, uint32_t timestampUs);
+
+    /**
+     * @brief End the sequence in progress, e.g. when the part has left
+     * @return true if a sequence with at least one band was completed
+     */
+    bool flush();
+
+    /**
+     * @brief Get the last completed sequence
+     * @return Reference to the sequence
+     */
+    const Sequence &getSequence() const;
+
+    /**
+     * @brief Drop the sequence in progress
+     */
+    void reset();
+
+private:
+    const ADPS9960_ColorSensor &sensor; ///< Source of the white reference
+    float tolerance;                    ///< Classification tolerance
+    StandardColor background;           ///< Class between sequences
+    uint8_t minBandSamples;             ///< Samples a band needs
+    uint8_t switchSamples;              ///< Samples of a new class that end a band
+    uint8_t endSamples;                 ///< Background samples that end a sequence
+
+    // Band in progress
+    StandardColor bandSymbol;           ///< Class of the open band (background if none)
+    uint16_t bandSamples;               ///< Samples in the open band
+    uint16_t bandAgreeing;              ///< Samples of the open band with its class
+    uint32_t bandStartUs;               ///< First sample of the open band
+    uint32_t bandLastUs;                ///< Last sample of the open band with its class
+
+    // Candidate for the next band
+    StandardColor candidateSymbol;      ///< Class of the pending change
+    uint8_t candidateSamples;           ///< Consecutive samples of the pending change
+    uint32_t candidateStartUs;          ///< First sample of the pending change
+    bool separated;                     ///< A kept background band or nothing precedes the open band
+
+    Sequence building;                  ///< Sequence in progress
+    Sequence completed;                 ///< Last completed sequence
+
+    /**
+     * @brief Close the open band and append it to the sequence if long enough
+     */
+    void closeBand();
+
+    /**
+     * @brief Complete the sequence in progress
+     * @return true if it held at least one band
+     */
+    bool completeSequence();
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_STRIPEDECODER_H
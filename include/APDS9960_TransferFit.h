@@ -0,0 +1,40 @@
+/**
+ * @file APDS9960_TransferFit.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Least-squares fit of the fleet transfer matrix, without Arduino dependencies
+ *
+ * Fleet characterization measures the same reference targets on every
+ * unit and fits a 3x3 matrix that maps each unit onto the canonical
+ * device space. The fit needs no sensor, so it lives in a header that
+ * only depends on <stdint.h>: the same code runs on the device (through
+ * ADPS9960_ColorSensor::fitTransferMatrix()) and on a host that fits
+ * units from logged measurements.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_APDS9960_TRANSFERFIT_H
+#define MANIGLIO_APDS_LIBRARY_APDS9960_TRANSFERFIT_H
+
+#include <stdint.h>
+
+/// Reference targets needed to fit a transfer matrix
+static const uint8_t TRANSFER_FIT_MIN_TARGETS = 3;
+
+/// Fixed-point unit of the fitted coefficients (Q3.12, 1.0)
+static const int16_t TRANSFER_FIT_SCALE = 4096;
+
+/**
+ * @brief Fit a 3x3 transfer matrix by least squares over reference targets
+ * @param measured Targets as measured by the unit, count x {r, g, b} (0-65535),
+ *                 the layout of an ADPS9960_ColorSensor::RGB16 array
+ * @param canonical The same targets in the canonical device space, same layout
+ * @param count Number of targets (at least TRANSFER_FIT_MIN_TARGETS)
+ * @param coefficients Array of 9 receiving the row-major matrix in Q3.12
+ *                     (unchanged on failure)
+ * @return true on success, false if too few or degenerate targets, or a
+ *         coefficient outside the Q3.12 range
+ */
+bool fitTransferCoefficients(const uint16_t *measured, const uint16_t *canonical,
+                             uint8_t count, int16_t coefficients[9]);
+
+#endif //MANIGLIO_APDS_LIBRARY_APDS9960_TRANSFERFIT_H
@@ -0,0 +1,299 @@
+/**
+ * @file APDS9960_ChromaticityTracker.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the ChromaticityTracker class
+ *
+ * Per coordinate, each sample costs two 32x32 multiplications and a few
+ * additions in fixed point:
+ *
+ *   predicted = position + velocity
+ *   residual  = measured - predicted
+ *   position  = predicted + alpha * residual
+ *   velocity  = velocity + beta * residual
+ *
+ * An EMA (beta = 0) needs one multiplication but trails a ramp by
+ * (1 - alpha) / alpha samples; the velocity term removes that lag. After a
+ * step the alpha-beta filter overshoots slightly and settles in a few
+ * samples, where an EMA approaches exponentially.
+ */
+
+#include "APDS9960_ChromaticityTracker.h"
+
+/**
+ * @brief Constructor - gains default to alpha 0.5, beta 0.1
+ */
+ChromaticityTracker::ChromaticityTracker()
+    : position{0, 0, 0, 0},
+      velocity{0, 0, 0, 0},
+      alphaQ16(32768),
+      betaQ16(6554),
+      measurementNoise(0.0f),
+      coastCount(0),
+      initialized(false) {
+}
+
+/**
+ * @brief Set the filter gains directly
+ * @param alpha Position gain (clamped to 0.0-1.0)
+ * @param beta Velocity gain (clamped to 0.0-2.0)
+ */
+void ChromaticityTracker::setGains(float alpha, float beta) {
+    if (alpha < 0.0f) alpha = 0.0f;
+    if (alpha > 1.0f) alpha = 1.0f;
+    if (beta < 0.0f) beta = 0.0f;
+    if (beta > 2.0f) beta = 2.0f;
+
+    alphaQ16 = static_cast<uint32_t>(alpha * 65536.0f + 0.5f);
+    betaQ16 = static_cast<uint32_t>(beta * 65536.0f + 0.5f);
+}
+
+/**
+ * @brief Derive the optimal gains from the noise levels
+ *
+ * Kalata's steady-state solution for the constant-velocity model with the
+ * tracking index lambda = accelerationStdDev / measurementStdDev
+ * (one sample as time unit):
+ *
+ *   r     = (4 + lambda - sqrt(8 * lambda + lambda^2)) / 4
+ *   alpha = 1 - r^2
+ *   beta  = 2 * (2 - alpha) - 4 * sqrt(1 - alpha)
+ *
+ * @param measurementStdDev Sensor noise of one sample (CHROMA_SCALE units)
+ * @param accelerationStdDev Expected change of velocity per sample (CHROMA_SCALE units)
+ *
+ * @note A zero measurement noise selects alpha = 1 (no filtering)
+ */
+void ChromaticityTracker::setNoise(float measurementStdDev, float accelerationStdDev) {
+    if (measurementStdDev <= 0.0f) {
+        setGains(1.0f, 0.0f);
+        return;
+    }
+    if (accelerationStdDev < 0.0f) {
+        accelerationStdDev = 0.0f;
+    }
+
+    const float lambda = accelerationStdDev / measurementStdDev;
+    const float r = (4.0f + lambda - sqrtf(8.0f * lambda + lambda * lambda)) / 4.0f;
+    const float alpha = 1.0f - r * r;
+    const float beta = 2.0f * (2.0f - alpha) - 4.0f * sqrtf(1.0f - alpha);
+    setGains(alpha, beta);
+}
+
+/**
+ * @brief Measure the sensor noise on a static target and set the gains from it
+ *
+ * Reads chromaticity samples, computes the standard deviation of each
+ * coordinate (Welford) and uses the largest as measurement noise.
+ *
+ * @param sensor Calibrated sensor to read
+ * @param accelerationStdDev Expected change of velocity per sample
+ * @param samples Readings used for the variance (minimum 4)
+ * @param mode Chromaticity reference, as used for update()
+ * @return true on success, false on read error
+ *
+ * @note Keep the target still: any movement is counted as noise
+ */
+bool ChromaticityTracker::calibrateNoise(ADPS9960_ColorSensor &sensor, float accelerationStdDev,
+                                         uint8_t samples, ADPS9960_ColorSensor::ChromaticityMode mode) {
+    if (samples < 4) {
+        samples = 4;
+    }
+
+    const unsigned long periodMs = sensor.getSamplePeriodUs() / 1000UL + 1;
+    float mean[CHANNELS] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float m2[CHANNELS] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (uint8_t n = 1; n <= samples; n++) {
+        ADPS9960_ColorSensor::Chromaticity chroma{};
+        if (!sensor.readChromaticity(chroma, mode)) {
+            return false;
+        }
+
+        const uint16_t values[CHANNELS] = {chroma.r, chroma.g, chroma.b, chroma.intensity};
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            const float x = static_cast<float>(values[c]);
+            const float delta = x - mean[c];
+            mean[c] += delta / n;
+            m2[c] += delta * (x - mean[c]);
+        }
+        delay(periodMs); // Next integration
+    }
+
+    float largest = 0.0f;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const float variance = m2[c] / (samples - 1);
+        if (variance > largest) largest = variance;
+    }
+
+    measurementNoise = sqrtf(largest);
+    setNoise(measurementNoise, accelerationStdDev);
+    return true;
+}
+
+/**
+ * @brief Get the position gain
+ * @return Alpha (0.0-1.0)
+ */
+float ChromaticityTracker::getAlpha() const {
+    return static_cast<float>(alphaQ16) / 65536.0f;
+}
+
+/**
+ * @brief Get the velocity gain
+ * @return Beta
+ */
+float ChromaticityTracker::getBeta() const {
+    return static_cast<float>(betaQ16) / 65536.0f;
+}
+
+/**
+ * @brief Get the measurement noise found by calibrateNoise()
+ * @return Largest per-coordinate standard deviation (0 if not measured)
+ */
+float ChromaticityTracker::getMeasurementNoise() const {
+    return measurementNoise;
+}
+
+/**
+ * @brief Feed one measurement
+ *
+ * Positions are Q8 (< 2^24) and residuals stay within +/-2^25, so the
+ * gain products are formed in 64 bits and shifted back.
+ *
+ * @param measured Chromaticity of the current sample
+ */
+void ChromaticityTracker::update(const ADPS9960_ColorSensor::Chromaticity &measured) {
+    const uint16_t values[CHANNELS] = {measured.r, measured.g, measured.b, measured.intensity};
+    coastCount = 0;
+
+    if (!initialized) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            position[c] = static_cast<int32_t>(values[c]) << 8;
+            velocity[c] = 0;
+        }
+        initialized = true;
+        return;
+    }
+
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const int32_t predicted = position[c] + velocity[c];
+        const int32_t residual = (static_cast<int32_t>(values[c]) << 8) - predicted;
+
+        position[c] = predicted + static_cast<int32_t>((static_cast<int64_t>(residual) * alphaQ16) >> 16);
+        velocity[c] += static_cast<int32_t>((static_cast<int64_t>(residual) * betaQ16) >> 16);
+    }
+}
+
+/**
+ * @brief Feed one measurement together with the flags of its sample
+ *
+ * A repeated result carries no new information and would shrink the
+ * velocity, so it is dropped. A clipped or saturated sample marks a real
+ * time step with an unreliable value, so the state coasts on its velocity.
+ *
+ * @param measured Chromaticity of the sample
+ * @param sampleFlags ColorSample::flags from readSample()
+ */
+void ChromaticityTracker::update(const ADPS9960_ColorSensor::Chromaticity &measured,
+                                 uint8_t sampleFlags) {
+    if (!(sampleFlags & ADPS9960_ColorSensor::SAMPLE_FRESH)) {
+        return;
+    }
+    if (sampleFlags & (ADPS9960_ColorSensor::SAMPLE_CLIPPED | ADPS9960_ColorSensor::SAMPLE_ANALOG_SATURATED)) {
+        coast();
+        return;
+    }
+    update(measured);
+}
+
+/**
+ * @brief Advance one sample without a measurement
+ *
+ * Extrapolation is only trusted for a few samples: after
+ * MAX_COAST_SAMPLES consecutive coasts the velocity is dropped and the
+ * position holds. Positions stay clamped to the coordinate range, so a
+ * long run of clipped samples cannot overflow the Q8 state.
+ */
+void ChromaticityTracker::coast() {
+    if (!initialized) {
+        return;
+    }
+    if (coastCount >= MAX_COAST_SAMPLES) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            velocity[c] = 0;
+        }
+        return;
+    }
+    coastCount++;
+
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const int32_t next = position[c] + velocity[c];
+        position[c] = next < 0 ? 0 : (next > (65535L << 8) ? (65535L << 8) : next);
+    }
+}
+
+/**
+ * @brief Convert a Q8 state value to a clamped 16-bit coordinate
+ * @param valueQ8 State value
+ * @return Rounded value, clamped to 0-65535
+ */
+static uint16_t toCoordinate(int32_t valueQ8) {
+    const int32_t value = (valueQ8 + 128) >> 8;
+    if (value < 0) return 0;
+    if (value > 65535L) return 65535;
+    return static_cast<uint16_t>(value);
+}
+
+/**
+ * @brief Get the filtered chromaticity at the last sample
+ * @param estimate Reference receiving the estimate
+ */
+void ChromaticityTracker::getEstimate(ADPS9960_ColorSensor::Chromaticity &estimate) const {
+    predict(estimate, 0);
+}
+
+/**
+ * @brief Extrapolate the chromaticity into the future
+ *
+ * Compensates the latency between the integration and the use of its
+ * result, e.g. one integration period plus processing for a reject gate
+ * placed after the sensor.
+ *
+ * @param predicted Reference receiving position + velocity * samplesAhead
+ * @param samplesAhead Samples to look ahead (0 = current estimate)
+ */
+void ChromaticityTracker::predict(ADPS9960_ColorSensor::Chromaticity &predicted,
+                                  uint8_t samplesAhead) const {
+    int32_t values[CHANNELS];
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const int64_t value = static_cast<int64_t>(position[c]) +
+                              static_cast<int64_t>(velocity[c]) * samplesAhead;
+        values[c] = value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : static_cast<int32_t>(value));
+    }
+
+    predicted.r = toCoordinate(values[0]);
+    predicted.g = toCoordinate(values[1]);
+    predicted.b = toCoordinate(values[2]);
+    predicted.intensity = toCoordinate(values[3]);
+}
+
+/**
+ * @brief Forget the state; the next update() re-initializes it
+ */
+void ChromaticityTracker::reset() {
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        position[c] = 0;
+        velocity[c] = 0;
+    }
+    coastCount = 0;
+    initialized = false;
+}
+
+/**
+ * @brief Check if the tracker received a measurement since the last reset
+ * @return true if the state is valid
+ */
+bool ChromaticityTracker::isInitialized() const {
+    return initialized;
+}
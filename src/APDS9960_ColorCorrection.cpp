@@ -0,0 +1,207 @@
+/**
+ * @file APDS9960_ColorCorrection.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief 3D LUT color correction for the APDS9960_ColorSensor class
+ *
+ * Per-channel scaling cannot undo the non-linear mismatch between the
+ * sensor's spectral response and the eye's. A 3D LUT samples the full
+ * correction on a regular grid of RGB nodes; values between nodes are
+ * found by tetrahedral interpolation, which needs only 4 of the 8
+ * surrounding nodes and keeps neutral colors on the gray axis.
+ *
+ * LUT layout: gridSize^3 nodes, each an {r, g, b} triplet of uint16_t.
+ * Node (ri, gi, bi) starts at index ((ri * gridSize + gi) * gridSize + bi) * 3,
+ * and covers input value i * 65535 / (gridSize - 1) on each axis.
+ * An identity LUT stores each node's own coordinates.
+ *
+ * A per-unit LUT is fitted from reference patches (fitColorCorrectionLUT())
+ * and is too large for the CalibrationBlob, so the blob records its size
+ * and checksum instead. After importCalibration() only that table is
+ * accepted, which keeps the LUT of one unit off another.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @brief Read one LUT entry from RAM or AVR flash
+ * @param lut Node table
+ * @param index Element index
+ * @param inProgmem true if lut was declared PROGMEM
+ * @return Stored value
+ */
+static int32_t readLUTValue(const uint16_t *lut, uint32_t index, bool inProgmem) {
+    if (inProgmem) {
+        return static_cast<int32_t>(pgm_read_word(&lut[index]));
+    }
+    return static_cast<int32_t>(lut[index]);
+}
+
+/**
+ * @brief Enable 3D LUT color correction on the 16-bit RGB path
+ *
+ * The table is referenced, not copied: a 17x17x17 LUT is 29 KB, so it is
+ * meant to stay in flash (const data) or in a buffer owned by the caller.
+ *
+ * @param lut Node table (see file header for layout)
+ * @param gridSize Nodes per axis (2-33)
+ * @param inProgmem true if lut was declared PROGMEM on AVR
+ * @return true if accepted, false if lut is null or gridSize is out of range
+ *
+ * @note On failure the previous LUT setting is left unchanged
+ * @note After importCalibration() of a blob that recorded a LUT, only that
+ *       table (same size and checksum) is accepted
+ */
+bool ADPS9960_ColorSensor::setColorCorrectionLUT(const uint16_t *lut, uint8_t gridSize,
+                                                 bool inProgmem) {
+    if (lut == nullptr || gridSize < MIN_LUT_GRID_SIZE || gridSize > MAX_LUT_GRID_SIZE) {
+        return false;
+    }
+    if (expectedLUTSize != 0 &&
+        (gridSize != expectedLUTSize || getColorCorrectionLUTChecksum(lut, gridSize, inProgmem) != expectedLUTChecksum)) {
+        return false;
+    }
+
+    correctionLUT = lut;
+    correctionLUTSize = gridSize;
+    correctionLUTInProgmem = inProgmem;
+    return true;
+}
+
+/**
+ * @brief Disable 3D LUT color correction
+ */
+void ADPS9960_ColorSensor::clearColorCorrectionLUT() {
+    correctionLUT = nullptr;
+    correctionLUTSize = 0;
+    correctionLUTInProgmem = false;
+}
+
+/**
+ * @brief Fit a per-unit correction LUT from reference patches
+ *
+ * Thin wrapper around fitCorrectionLUT() (APDS9960_LUTFit.h), which holds
+ * the fit without any Arduino dependency.
+ *
+ * @param measured Patches as measured by this unit
+ * @param reference The true values of the same patches
+ * @param count Number of patches (at least MIN_LUT_PATCHES)
+ * @param gridSize Nodes per axis
+ * @param lut Array of gridSize^3 * 3 receiving the node table (unchanged on failure)
+ * @return true on success, false otherwise
+ */
+bool ADPS9960_ColorSensor::fitColorCorrectionLUT(const RGB16 *measured, const RGB16 *reference,
+                                                 uint16_t count, uint8_t gridSize, uint16_t *lut) {
+    static_assert(sizeof(RGB16) == 3 * sizeof(uint16_t), "RGB16 must be three packed channels");
+    return fitCorrectionLUT(reinterpret_cast<const uint16_t *>(measured),
+                            reinterpret_cast<const uint16_t *>(reference), count, gridSize, lut);
+}
+
+/**
+ * @brief Get the checksum identifying a LUT
+ *
+ * Fletcher-16 over the node values, low byte first, so the result does
+ * not depend on the endianness or the memory the table lives in.
+ *
+ * @param lut Node table
+ * @param gridSize Nodes per axis
+ * @param inProgmem true if lut was declared PROGMEM
+ * @return 16-bit checksum (0 for a null table)
+ */
+uint16_t ADPS9960_ColorSensor::getColorCorrectionLUTChecksum(const uint16_t *lut, uint8_t gridSize,
+                                                             bool inProgmem) {
+    if (lut == nullptr) {
+        return 0;
+    }
+    const uint32_t length = static_cast<uint32_t>(gridSize) * gridSize * gridSize * 3;
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        const int32_t value = readLUTValue(lut, i, inProgmem);
+        sum1 = (sum1 + (value & 0xFF)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+        sum1 = (sum1 + (value >> 8)) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return static_cast<uint16_t>((sum2 << 8) | sum1);
+}
+
+/**
+ * @brief Apply a 3D LUT to a color using tetrahedral interpolation
+ *
+ * Algorithm (integer only):
+ * 1. Locate the cell: position = value * (gridSize - 1), cell = position >> 16,
+ *    fraction = low 16 bits (reduced to 15 bits so products fit in int32_t)
+ * 2. Sort the three fractions to pick one of the 6 tetrahedra of the cell
+ * 3. Walk from node c000 to c111 along the sorted axes, adding each edge
+ *    difference weighted by its fraction
+ *
+ * @param lut Node table
+ * @param gridSize Nodes per axis (2-33)
+ * @param inProgmem true if lut was declared PROGMEM
+ * @param rgb Color to correct in place (output clamped to 0-65535)
+ */
+void ADPS9960_ColorSensor::applyColorCorrectionLUT(const uint16_t *lut, uint8_t gridSize,
+                                                   bool inProgmem, RGB16 &rgb) {
+    const uint32_t cells = static_cast<uint32_t>(gridSize) - 1;
+
+    // Step 1: cell index and 15-bit fraction per axis
+    const uint32_t pr = static_cast<uint32_t>(rgb.r) * cells;
+    const uint32_t pg = static_cast<uint32_t>(rgb.g) * cells;
+    const uint32_t pb = static_cast<uint32_t>(rgb.b) * cells;
+    const uint32_t ir = pr >> 16, ig = pg >> 16, ib = pb >> 16;
+    const int32_t fr = static_cast<int32_t>((pr & 0xFFFFUL) >> 1);
+    const int32_t fg = static_cast<int32_t>((pg & 0xFFFFUL) >> 1);
+    const int32_t fb = static_cast<int32_t>((pb & 0xFFFFUL) >> 1);
+
+    // Element offsets of one step along each axis
+    const uint32_t stepB = 3;
+    const uint32_t stepG = static_cast<uint32_t>(gridSize) * 3;
+    const uint32_t stepR = static_cast<uint32_t>(gridSize) * stepG;
+    const uint32_t base = ir * stepR + ig * stepG + ib * stepB;
+
+    // Step 2: order the axes by decreasing fraction
+    uint32_t step1, step2;
+    int32_t f1, f2, f3;
+    if (fr >= fg) {
+        if (fg >= fb) {             // r >= g >= b
+            step1 = stepR; step2 = stepR + stepG; f1 = fr; f2 = fg; f3 = fb;
+        } else if (fr >= fb) {      // r >= b > g
+            step1 = stepR; step2 = stepR + stepB; f1 = fr; f2 = fb; f3 = fg;
+        } else {                    // b > r >= g
+            step1 = stepB; step2 = stepB + stepR; f1 = fb; f2 = fr; f3 = fg;
+        }
+    } else {
+        if (fr >= fb) {             // g > r >= b
+            step1 = stepG; step2 = stepG + stepR; f1 = fg; f2 = fr; f3 = fb;
+        } else if (fg >= fb) {      // g >= b > r
+            step1 = stepG; step2 = stepG + stepB; f1 = fg; f2 = fb; f3 = fr;
+        } else {                    // b > g > r
+            step1 = stepB; step2 = stepB + stepG; f1 = fb; f2 = fg; f3 = fr;
+        }
+    }
+    const uint32_t step3 = stepR + stepG + stepB;
+
+    // Step 3: interpolate each output channel along the tetrahedron edges
+    uint16_t out[3];
+    for (uint8_t c = 0; c < 3; c++) {
+        const int32_t v0 = readLUTValue(lut, base + c, inProgmem);
+        const int32_t v1 = readLUTValue(lut, base + step1 + c, inProgmem);
+        const int32_t v2 = readLUTValue(lut, base + step2 + c, inProgmem);
+        const int32_t v3 = readLUTValue(lut, base + step3 + c, inProgmem);
+
+        // Each |difference| <= 65535 and fraction < 2^15: products fit in int32_t
+        int32_t value = v0;
+        value += ((v1 - v0) * f1 + 16384) >> 15;
+        value += ((v2 - v1) * f2 + 16384) >> 15;
+        value += ((v3 - v2) * f3 + 16384) >> 15;
+
+        if (value < 0) value = 0;
+        if (value > 65535) value = 65535;
+        out[c] = static_cast<uint16_t>(value);
+    }
+
+    rgb.r = out[0];
+    rgb.g = out[1];
+    rgb.b = out[2];
+}
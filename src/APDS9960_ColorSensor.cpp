@@ -6,6 +6,7 @@
  */
 
 #include "APDS9960_ColorSensor.h"
+#include <Wire.h>
 #include <SparkFun_APDS9960.h>
 
 /**
@@ -37,18 +38,150 @@ const char* getStandardColorName(StandardColor color) {
     }
 }
 
+/**
+ * @struct ChromaticRange
+ * @brief Hue band and minimum saturation/value of a chromatic standard color
+ *
+ * Bands are semi-open [hMin, hMax); hMin > hMax marks the band wrapping
+ * around 0/360 degrees. Thresholds are integer percentages so the same
+ * table serves both the float HSV path and the integer chromaticity path.
+ */
+struct ChromaticRange {
+    uint16_t hMin;          ///< Lower hue bound (degrees, inclusive)
+    uint16_t hMax;          ///< Upper hue bound (degrees, exclusive)
+    uint8_t sMinPercent;    ///< Minimum saturation (%)
+    uint8_t vMinPercent;    ///< Minimum value/brightness (%)
+    StandardColor color;    ///< Color reported for this band
+};
+
+/// Chromatic standard colors in detection priority order (no overlap)
+static const ChromaticRange CHROMATIC_RANGES[] = {
+    {340,  20, 50, 30, StandardColor::RED},
+    { 20,  50, 50, 40, StandardColor::ORANGE},
+    { 50,  80, 50, 50, StandardColor::YELLOW},
+    { 80, 165, 40, 30, StandardColor::GREEN},
+    {165, 210, 40, 40, StandardColor::CYAN},
+    {210, 265, 40, 30, StandardColor::BLUE},
+    {265, 295, 40, 30, StandardColor::PURPLE},
+    {295, 340, 50, 40, StandardColor::MAGENTA},
+};
+
+/**
+ * @brief Check whether an integer hue falls inside a chromatic band
+ *
+ * Hue is truncated to whole degrees by the caller. Since every band bound
+ * is an integer, truncation gives the same result as the float comparison.
+ *
+ * @param hue Hue in whole degrees (0-359)
+ * @param range Band to test
+ * @return true if hue is in [hMin, hMax), honoring wrap-around
+ */
+static bool isHueInBand(uint16_t hue, const ChromaticRange &range) {
+    if (range.hMin <= range.hMax) {
+        return hue >= range.hMin && hue < range.hMax;
+    }
+    return hue >= range.hMin || hue < range.hMax;
+}
+
+/**
+ * @brief Integer division rounding toward negative infinity
+ * @param numerator Dividend (any sign)
+ * @param denominator Divisor (must be positive)
+ * @return floor(numerator / denominator)
+ */
+static int32_t floorDiv(int32_t numerator, int32_t denominator) {
+    if (numerator >= 0) {
+        return numerator / denominator;
+    }
+    return -((-numerator + denominator - 1) / denominator);
+}
+
 /**
  * @brief Constructor - initializes all calibration values to zero
  * 
  * Sets the sensor to NOT_CALIBRATED state. All color channel maximums
  * are initialized to zero, requiring calibration before accurate readings.
+ * Gain ratios start at the nominal 1/4/16/64 and the exposure shadow at the
+ * SparkFun defaults until begin() reads the real registers.
  */
 ADPS9960_ColorSensor::ADPS9960_ColorSensor()
-    : calibrationStatus(NOT_CALIBRATED),
+    : calibration{0, 0, 0, 0, AGAIN_4X, DEFAULT_ATIME},
+      gainRatios{{256, 256, 256, 256}, {1024, 1024, 1024, 1024}, {4096, 4096, 4096, 4096},
+                 {16384, 16384, 16384, 16384}},
+      currentGain(AGAIN_4X),
+      currentATime(DEFAULT_ATIME),
+      currentWTime(255),
+      currentWaitLong(false),
+      waitEnabled(false),
+      enableShadow(0),
+      heldEnable(0),
+      whiteBalanceAdaptive(false),
+      whiteBalanceFrozen(false),
+      wbTimeConstantShift(8),
+      wbMaxStepShift(10),
+      wbState{0, 0, 0, 0},
+      mainsFrequency(MAINS_NONE),
+      flickerPhases(0),
+      oversampleCount(0),
+      oversampleTargetSNR(0.0f),
+      oversampleMaxSamples(MAX_OVERSAMPLING),
+      oversampleValid(false),
+      oversampleMeanQ8{0, 0, 0, 0},
+      oversamplingReport{},
+      hdrExposures{},
+      hdrExposureCount(0),
+      exposureRestorePending(false),
+      exposureSettling(false),
+      illuminationCallback(nullptr),
+      illuminationContext(nullptr),
+      illuminationSettleUs(0),
+      differentialCapture(false),
+      differentialLitFirst(true),
+      differentialReport{},
+      lastSaturatedMask(0),
+      lastBusError(BUS_OK),
+      busRecoveryEnabled(false),
+      busRecoveryActive(false),
+      busSdaPin(-1),
+      busSclPin(-1),
+      busMaxRetries(DEFAULT_RECOVERY_RETRIES),
+      busMaxBackoffMs(DEFAULT_MAX_BACKOFF_MS),
+      recoveryReport{},
+      busByteCount(0),
+      energyModel{3.3f, 200.0f, 38.0f, 100.0f, 0.2f, 10.0f, 1.0f},
+      energyReport{},
+      energyTracking(false),
+      energyLastUs(0),
+      energyLastBusBytes(0),
+      energyAwakeUs(0),
+      energyLedOnUs(0),
+      energySensorPj(0),
+      energyLedPj(0),
+      energyBusPj(0),
+      energyMcuPj(0),
+      energyActiveNw(0),
+      energyWaitNw(0),
+      energySleepNw(0),
+      energyLedNw(0),
+      energyMcuNw(0),
+      energyBytePj(0),
+      profiles{},
+      profileCount(0),
+      activeProfile(-1),
+      calibrationStatus(NOT_CALIBRATED),
+      calibrationReport{},
       max_ambient(0),
       max_red(0),
       max_green(0),
-      max_blue(0) {
+      max_blue(0),
+      transferMatrix{{CHROMA_SCALE, 0, 0, 0, CHROMA_SCALE, 0, 0, 0, CHROMA_SCALE}},
+      transferEnabled(false),
+      correctionLUT(nullptr),
+      correctionLUTSize(0),
+      correctionLUTInProgmem(false),
+      expectedLUTSize(0),
+      expectedLUTChecksum(0) {
+    updateEnergyRates();
 }
 
 /**
@@ -65,15 +198,26 @@ ADPS9960_ColorSensor::ADPS9960_ColorSensor()
  */
 bool ADPS9960_ColorSensor::begin() {
     this->sensor = SparkFun_APDS9960();
+    energyTracking = true;
+    resetEnergyReport();
 
     // Initialize sensor hardware (may fail but still configure registers)
     sensor.init();
     delay(100); // Allow sensor to stabilize after init
 
     // Enable light sensing (no interrupts)
-    sensor.enableLightSensor(false);
+    if (sensor.enableLightSensor(false)) {
+        trackEnable(ENABLE_PON | ENABLE_AEN); // init() cleared ENABLE, the driver set PON and AEN
+    }
     delay(50);  // Give time for light sensor to start
 
+    // Mirror the exposure configured by the SparkFun driver
+    const uint8_t gain = sensor.getAmbientLightGain();
+    if (gain < GAIN_COUNT) {
+        currentGain = gain;
+    }
+    readRegister(REG_ATIME, currentATime);
+
     // Verify sensor is actually working by attempting a read
     uint16_t ambientTest;
     return sensor.readAmbientLight(ambientTest);
@@ -110,7 +254,11 @@ bool ADPS9960_ColorSensor::calibrate(int samplingTimeSeconds, bool useDefaultsOn
     // Perform the actual calibration routine
     bool success = performCalibration(samplingTimeSeconds);
 
+    // A fresh calibration no longer matches any stored profile
+    activeProfile = -1;
+
     if (success) {
+        storeCalibrationReference();
         calibrationStatus = CALIBRATED_OK;
         return true;
     }
@@ -139,6 +287,10 @@ bool ADPS9960_ColorSensor::calibrate(int samplingTimeSeconds, bool useDefaultsOn
  * At least MIN_SAMPLES_PER_SECOND * samplingTimeSeconds samples must
  * be successfully collected for calibration to be valid.
  * 
+ * While sampling, per-channel statistics, the achieved sample rate and
+ * saturation events are accumulated into the calibration report with
+ * Welford's online algorithm (constant memory, no sample buffer).
+ * 
  * @param samplingTimeSeconds Duration of sampling period
  * @return true if calibration data is valid, false otherwise
  */
@@ -155,6 +307,14 @@ bool ADPS9960_ColorSensor::performCalibration(int samplingTimeSeconds) {
     int samples = 0;
     const int minSamples = samplingTimeSeconds * MIN_SAMPLES_PER_SECOND;
 
+    // Running statistics (Welford): no sample buffer needed
+    CalibrationReport &report = calibrationReport;
+    report = CalibrationReport{};
+    report.requiredSamples = static_cast<uint16_t>(minSamples);
+    ChannelStats *stats[4] = {&report.ambient, &report.red, &report.green, &report.blue};
+    float m2[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const uint16_t saturationLevel = getSaturationLevel();
+
     // Sampling phase - collect maximum values over time
     while (millis() - startTime < samplingTimeSeconds * 1000) {
         uint16_t temp_ambient, temp_red, temp_green, temp_blue;
@@ -171,13 +331,42 @@ bool ADPS9960_ColorSensor::performCalibration(int samplingTimeSeconds) {
             if (temp_blue > max_blue) max_blue = temp_blue;
 
             samples++;
+
+            // Update per-channel mean, variance, min and max incrementally
+            const uint16_t values[4] = {temp_ambient, temp_red, temp_green, temp_blue};
+            bool saturated = false;
+            for (uint8_t c = 0; c < 4; c++) {
+                ChannelStats &channel = *stats[c];
+                const float x = static_cast<float>(values[c]);
+                const float delta = x - channel.mean;
+                channel.mean += delta / static_cast<float>(samples);
+                m2[c] += delta * (x - channel.mean);
+
+                if (samples == 1 || values[c] < channel.min) channel.min = values[c];
+                if (values[c] > channel.max) channel.max = values[c];
+                if (values[c] >= saturationLevel) saturated = true;
+            }
+            if (saturated) report.saturationEvents++;
+        } else {
+            report.readErrors++;
         }
 
         delay(100); // Prevent sensor saturation and allow processing time
     }
 
+    // Finalize report
+    const unsigned long elapsed = millis() - startTime;
+    report.sampleCount = static_cast<uint16_t>(samples);
+    report.sampleRate = elapsed > 0 ? (samples * 1000.0f) / static_cast<float>(elapsed) : 0.0f;
+    for (uint8_t c = 0; c < 4; c++) {
+        ChannelStats &channel = *stats[c];
+        channel.stddev = samples > 1 ? sqrtf(m2[c] / static_cast<float>(samples - 1)) : 0.0f;
+        channel.snr = channel.stddev > 0.0f ? channel.mean / channel.stddev : 0.0f;
+    }
+
     // Validate that collected data meets quality requirements
-    return validateCalibrationData(samples, minSamples);
+    report.result = validateCalibrationData(samples, minSamples);
+    return report.result == CHECK_PASSED;
 }
 
 /**
@@ -195,7 +384,8 @@ bool ADPS9960_ColorSensor::performCalibration(int samplingTimeSeconds) {
  *   - Prevents calibration in dark/covered conditions
  * 
  * Criterion 3: Saturation Check
- *   - No channel should exceed SATURATION_THRESHOLD
+ *   - No channel may reach getSaturationLevel() (the clipping level of the
+ *     current ATIME, at most SATURATION_THRESHOLD)
  *   - Prevents calibration with overexposed sensor
  * 
  * Criterion 4: Non-Zero Values
@@ -204,40 +394,41 @@ bool ADPS9960_ColorSensor::performCalibration(int samplingTimeSeconds) {
  * 
  * @param samples Number of successful samples collected
  * @param minSamples Minimum required samples for validity
- * @return true if all criteria pass, false otherwise
+ * @return CHECK_PASSED if all criteria pass, otherwise the first failing check
  */
-bool ADPS9960_ColorSensor::validateCalibrationData(int samples, int minSamples) const {
+ADPS9960_ColorSensor::CalibrationCheck ADPS9960_ColorSensor::validateCalibrationData(int samples, int minSamples) const {
     // Criterion 1: Insufficient sample count
     if (samples < minSamples) {
-        return false;
+        return CHECK_SAMPLE_COUNT;
     }
 
     // Criterion 2: Values too low (sensor covered or not functioning)
     if (max_ambient < MIN_THRESHOLD) {
-        return false;
+        return CHECK_LOW_LIGHT;
     }
 
     // At least one RGB channel must exceed minimum threshold
     if (max_red < MIN_THRESHOLD &&
         max_green < MIN_THRESHOLD &&
         max_blue < MIN_THRESHOLD) {
-        return false;
+        return CHECK_LOW_LIGHT;
     }
 
     // Criterion 3: Saturated values (too much light or sensor malfunction)
-    if (max_ambient > SATURATION_THRESHOLD ||
-        max_red > SATURATION_THRESHOLD ||
-        max_green > SATURATION_THRESHOLD ||
-        max_blue > SATURATION_THRESHOLD) {
-        return false;
+    const uint16_t saturationLevel = getSaturationLevel();
+    if (max_ambient >= saturationLevel ||
+        max_red >= saturationLevel ||
+        max_green >= saturationLevel ||
+        max_blue >= saturationLevel) {
+        return CHECK_SATURATION;
     }
 
     // Criterion 4: Verify values aren't all zero (sanity check)
     if (max_ambient == 0 || (max_red == 0 && max_green == 0 && max_blue == 0)) {
-        return false;
+        return CHECK_ZERO_VALUES;
     }
 
-    return true;
+    return CHECK_PASSED;
 }
 
 /**
@@ -248,12 +439,67 @@ bool ADPS9960_ColorSensor::validateCalibrationData(int samples, int minSamples)
  * proper calibration isn't possible or for testing purposes.
  * 
  * @note This does NOT change calibrationStatus - call from calibrate()
+ * @note Defaults are recorded as valid for the current gain and ATIME
  */
 void ADPS9960_ColorSensor::setDefaultCalibration() {
     max_ambient = DEFAULT_MAX_VALUE;
     max_red = DEFAULT_MAX_VALUE;
     max_green = DEFAULT_MAX_VALUE;
     max_blue = DEFAULT_MAX_VALUE;
+    storeCalibrationReference();
+}
+
+/**
+ * @brief Apply default calibration if the sensor was never calibrated
+ *
+ * Fail-safe used by every normalized read path so that readings are
+ * meaningful even when calibrate() was never called.
+ */
+void ADPS9960_ColorSensor::ensureCalibrated() {
+    if (calibrationStatus == NOT_CALIBRATED) {
+        setDefaultCalibration();
+        calibrationStatus = CALIBRATED_WITH_DEFAULTS;
+    }
+}
+
+/**
+ * @brief Get the quality report of the last calibrate() run
+ *
+ * Contains sample count and rate, per-channel mean/stddev/SNR/min/max,
+ * read errors, saturation events and the first failing validation check,
+ * explaining why a calibration fell back to CALIBRATED_WITH_DEFAULTS.
+ *
+ * @return Reference to the report of the last calibration
+ *
+ * @note Saturation events use getSaturationLevel(), the clipping level of
+ *       the current ATIME, which can be lower than SATURATION_THRESHOLD
+ */
+const ADPS9960_ColorSensor::CalibrationReport &ADPS9960_ColorSensor::getCalibrationReport() const {
+    return calibrationReport;
+}
+
+/**
+ * @brief Get human-readable name of a calibration check result
+ * @param check CalibrationCheck enum value
+ * @return String representation ("CHECK_PASSED", "CHECK_LOW_LIGHT", ...)
+ */
+const char *ADPS9960_ColorSensor::getCalibrationCheckName(CalibrationCheck check) {
+    switch (check) {
+        case CHECK_NOT_RUN:
+            return "CHECK_NOT_RUN";
+        case CHECK_PASSED:
+            return "CHECK_PASSED";
+        case CHECK_SAMPLE_COUNT:
+            return "CHECK_SAMPLE_COUNT";
+        case CHECK_LOW_LIGHT:
+            return "CHECK_LOW_LIGHT";
+        case CHECK_SATURATION:
+            return "CHECK_SATURATION";
+        case CHECK_ZERO_VALUES:
+            return "CHECK_ZERO_VALUES";
+        default:
+            return "UNKNOWN";
+    }
 }
 
 /**
@@ -309,17 +555,261 @@ const char *ADPS9960_ColorSensor::getCalibrationStatusName() const {
  * 
  * @note Does not require calibration
  * @note Values are not normalized
+ * @note Updates the white reference when adaptive white balance is enabled
+ * @note Returns LED-on minus LED-off integrations when differential capture is set,
+ *       otherwise averages integrations at spread mains phases when flicker averaging
+ *       is set, otherwise fresh integrations when oversampling is set
  */
 bool ADPS9960_ColorSensor::readRawData(RawColor &raw) {
-    // Read all raw values from sensor - fail fast on any error
-    if (!sensor.readAmbientLight(raw.ambient)) return false;
-    if (!sensor.readRedLight(raw.red)) return false;
-    if (!sensor.readGreenLight(raw.green)) return false;
-    if (!sensor.readBlueLight(raw.blue)) return false;
+    return readRawChannels(raw, CHANNEL_ALL);
+}
+
+/**
+ * @brief Read raw data, fetching only the channels the caller consumes
+ *
+ * Shared body of readRawData() and the RGB paths. The plain read fetches
+ * the requested channels in one burst; averaging and white balance
+ * adaptation need all four and read them regardless of the mask.
+ *
+ * @param raw Reference to RawColor struct to populate
+ * @param channelMask ChannelMask bits needed by the caller
+ * @return true if read successful, false otherwise
+ */
+bool ADPS9960_ColorSensor::readRawChannels(RawColor &raw, uint8_t channelMask) {
+    const unsigned long startUs = micros();
+    oversampleValid = false;
+    if (!settleExposure()) {
+        return false;
+    }
+    if (whiteBalanceAdaptive && !whiteBalanceFrozen) {
+        channelMask = CHANNEL_ALL; // The white point tracker uses every channel
+    }
+
+    bool success;
+    if (isDifferentialCapture()) {
+        // Differential capture: LED-on minus LED-off integration
+        success = readDifferential(raw);
+    } else if (flickerPhases > 1) {
+        // Flicker averaging: one reading from several phase-shifted integrations
+        const uint32_t periodUs = mainsFrequency == MAINS_60HZ ? FLICKER_PERIOD_60HZ_US
+                                : mainsFrequency == MAINS_50HZ ? FLICKER_PERIOD_50HZ_US
+                                                               : 5UL * FLICKER_PERIOD_50HZ_US;
+        uint16_t clearMin, clearMax;
+        success = samplePhases(flickerPhases, periodUs, raw, clearMin, clearMax);
+    } else if (oversampleCount > 1 || oversampleTargetSNR > 0.0f) {
+        // Oversampling: decimate several fresh integrations into one reading
+        success = readOversampled(raw);
+    } else {
+        success = readSensorChannels(raw, channelMask);
+    }
+
+    // Charge the MCU time and the bus traffic of this read
+    energyAwakeUs += micros() - startUs;
+    accountEnergy();
+    if (!success) {
+        return false;
+    }
+
+    // Flag clipped channels (free: comparisons only)
+    const uint16_t saturation = getSaturationLevel(currentATime);
+    lastSaturatedMask = static_cast<uint8_t>((raw.ambient >= saturation ? 0x01 : 0) |
+                                             (raw.red >= saturation ? 0x02 : 0) |
+                                             (raw.green >= saturation ? 0x04 : 0) |
+                                             (raw.blue >= saturation ? 0x08 : 0));
+    if (isDifferentialCapture()) {
+        lastSaturatedMask |= differentialReport.litSaturatedMask; // The difference hides clipping
+    }
+
+    // Feed the sample stream to the white point tracker
+    if (whiteBalanceAdaptive && !whiteBalanceFrozen) {
+        adaptWhiteBalance(raw);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read a raw sample together with its quality flags
+ *
+ * Reads STATUS before the data: AVALID tells whether an integration
+ * completed since the previous data read (otherwise the same result is
+ * returned again) and CPSAT whether the clear photodiode saturated. CPSAT
+ * is latched by the sensor and cleared here after being reported.
+ *
+ * @param sample Reference to ColorSample struct to populate
+ * @return true if read successful, false on sensor read error
+ *
+ * @note Averaged and differential readings are always fresh
+ */
+bool ADPS9960_ColorSensor::readSample(ColorSample &sample) {
+    uint8_t status;
+    if (!readRegister(REG_STATUS, status)) {
+        return false;
+    }
+
+    const bool settling = exposureSettling || exposureRestorePending; // The read waits for a new integration
+    RawColor raw{};
+    if (!readRawData(raw)) {
+        return false;
+    }
+
+    const bool averaged = oversampleValid || (flickerPhases > 1 && !isDifferentialCapture());
+    sample.ambient = raw.ambient;
+    sample.red = raw.red;
+    sample.green = raw.green;
+    sample.blue = raw.blue;
+    sample.timestampUs = micros();
+    sample.saturatedMask = lastSaturatedMask;
+    sample.gain = currentGain;
+    sample.atime = currentATime;
+    sample.flags = 0;
+    if (averaged || settling || isDifferentialCapture() || (status & STATUS_AVALID)) sample.flags |= SAMPLE_FRESH;
+    if (status & STATUS_CPSAT) sample.flags |= SAMPLE_ANALOG_SATURATED;
+    if (lastSaturatedMask != 0) sample.flags |= SAMPLE_CLIPPED;
+    if (averaged) sample.flags |= SAMPLE_AVERAGED;
+
+    if (status & STATUS_CPSAT) {
+        writeCommand(REG_CICLEAR); // Re-arm the saturation latch
+    }
+    return true;
+}
+
+/**
+ * @brief Check if a sample is fit for filters and classifiers
+ * @param sample Sample from readSample()
+ * @return true if fresh and neither clipped nor analog saturated
+ */
+bool ADPS9960_ColorSensor::isSampleUsable(const ColorSample &sample) {
+    return (sample.flags & SAMPLE_FRESH) &&
+           !(sample.flags & (SAMPLE_ANALOG_SATURATED | SAMPLE_CLIPPED));
+}
+
+/**
+ * @brief Get the clipped-channel mask of the last reading
+ * @return Bit mask (bit 0 = C, 1 = R, 2 = G, 3 = B)
+ */
+uint8_t ADPS9960_ColorSensor::getLastSaturatedMask() const {
+    return lastSaturatedMask;
+}
+
+/**
+ * @brief Read the four channels without any processing
+ *
+ * Plain register read shared by readRawData() and the averaging routines,
+ * which must not feed every partial sample to the white-balance tracker.
+ * With bus recovery enabled, a failed read recovers the bus and the sensor
+ * and is repeated once on the next fresh integration.
+ *
+ * @param raw Reference to RawColor struct to populate
+ * @return true if all four channels read successfully, false if any read fails
+ */
+bool ADPS9960_ColorSensor::readSensorChannels(RawColor &raw, uint8_t channelMask) {
+    if (readChannelRegisters(raw, channelMask)) {
+        return true;
+    }
+
+    if (!busRecoveryEnabled || busRecoveryActive) {
+        return false;
+    }
+    return recoverBus() && waitForValidData() && readChannelRegisters(raw, channelMask);
+}
+
+/**
+ * @brief Read channels once in a single burst
+ *
+ * The data registers C, R, G, B (low byte first) are contiguous from
+ * REG_CDATAL, so the burst spans from the first to the last requested
+ * channel: clear only is 2 data bytes, R+G+B 6, all four 8. Channels inside
+ * the span that were not requested are discarded.
+ *
+ * @param raw Reference to RawColor struct to populate
+ * @param channelMask ChannelMask bits to read (not 0)
+ * @return true if all requested channels read successfully, false otherwise
+ */
+bool ADPS9960_ColorSensor::readChannelRegisters(RawColor &raw, uint8_t channelMask) {
+    channelMask &= CHANNEL_ALL;
+    if (channelMask == 0) {
+        return false;
+    }
+
+    uint8_t first = 0;
+    while (!(channelMask & (1 << first))) first++;
+    uint8_t last = 3;
+    while (!(channelMask & (1 << last))) last--;
+    const uint8_t length = static_cast<uint8_t>(2 * (last - first + 1));
+
+    Wire.beginTransmission(I2C_ADDRESS);
+    Wire.write(static_cast<uint8_t>(REG_CDATAL + 2 * first));
+    busByteCount += 2;
+    if (!recordBusResult(Wire.endTransmission())) {
+        return false;
+    }
+
+    busByteCount += 1 + length;
+    if (Wire.requestFrom(I2C_ADDRESS, length) != length) {
+        lastBusError = BUS_SHORT_READ;
+        return false;
+    }
+
+    uint16_t values[4] = {0, 0, 0, 0};
+    for (uint8_t c = first; c <= last; c++) {
+        const uint8_t low = static_cast<uint8_t>(Wire.read());
+        const uint8_t high = static_cast<uint8_t>(Wire.read());
+        if (channelMask & (1 << c)) {
+            values[c] = static_cast<uint16_t>((high << 8) | low);
+        }
+    }
 
+    raw.ambient = values[0];
+    raw.red = values[1];
+    raw.green = values[2];
+    raw.blue = values[3];
     return true;
 }
 
+/**
+ * @brief Read only the requested channels in one burst
+ *
+ * For consumers that need part of the data, e.g. brightness (clear only,
+ * 2 data bytes) or an R/B ratio test (R+G+B span, 6 data bytes), instead
+ * of the 8 bytes of readRawData().
+ *
+ * @param raw Reference receiving the requested channels (others set to 0)
+ * @param channelMask ChannelMask bits to read
+ * @return true if read successful, false on bus error or empty mask
+ */
+bool ADPS9960_ColorSensor::readChannels(RawColor &raw, uint8_t channelMask) {
+    if ((channelMask & CHANNEL_ALL) == 0) {
+        return false;
+    }
+    const unsigned long startUs = micros();
+    const bool success = settleExposure() && readSensorChannels(raw, channelMask);
+
+    // Charge the MCU time and the bus traffic of this read
+    energyAwakeUs += micros() - startUs;
+    accountEnergy();
+    return success;
+}
+
+/**
+ * @brief Get the bytes moved on the bus by this library's transactions
+ *
+ * Counts address, register pointer and data bytes of every register
+ * access and burst. At 100 kHz one byte takes about 90 us on the wire.
+ *
+ * @return Bytes since the last reset
+ */
+uint32_t ADPS9960_ColorSensor::getBusByteCount() const {
+    return busByteCount;
+}
+
+/**
+ * @brief Reset the bus byte counter
+ */
+void ADPS9960_ColorSensor::resetBusByteCount() {
+    busByteCount = 0;
+}
+
 /**
  * @brief Read normalized RGB color values (0-255 range)
  * 
@@ -333,21 +823,40 @@ bool ADPS9960_ColorSensor::readRawData(RawColor &raw) {
  * @param r Reference to store normalized red value (0-255)
  * @param g Reference to store normalized green value (0-255)
  * @param b Reference to store normalized blue value (0-255)
+ * @param encoding ENCODING_LINEAR for sensor ratios, ENCODING_SRGB for
+ *                 gamma-encoded values (via 16-bit read and flash LUT)
  * @return true if read successful, false on sensor read error
  * 
  * @note Automatically calibrates with defaults if not yet calibrated
  * @note Safe to call even without explicit calibration
  */
-bool ADPS9960_ColorSensor::readRGB(uint8_t &r, uint8_t &g, uint8_t &b) {
-    // Auto-calibrate with defaults if necessary (fail-safe mechanism)
-    if (calibrationStatus == NOT_CALIBRATED) {
-        setDefaultCalibration();
-        calibrationStatus = CALIBRATED_WITH_DEFAULTS;
+bool ADPS9960_ColorSensor::readRGB(uint8_t &r, uint8_t &g, uint8_t &b,
+                                   ColorEncoding encoding) {
+    // sRGB needs the 16-bit path: encoding 8-bit linear values would
+    // leave gaps in the dark sRGB codes. Transfer and LUT correction also work on 16 bits.
+    if (encoding == ENCODING_SRGB || transferEnabled || correctionLUT != nullptr) {
+        RGB16 rgb16{};
+        if (!readRGB16(rgb16)) {
+            return false;
+        }
+        if (encoding == ENCODING_SRGB) {
+            r = linearToSRGB(rgb16.r);
+            g = linearToSRGB(rgb16.g);
+            b = linearToSRGB(rgb16.b);
+        } else {
+            r = static_cast<uint8_t>(rgb16.r >> 8);
+            g = static_cast<uint8_t>(rgb16.g >> 8);
+            b = static_cast<uint8_t>(rgb16.b >> 8);
+        }
+        return true;
     }
 
-    // Read raw sensor data
+    // Auto-calibrate with defaults if necessary (fail-safe mechanism)
+    ensureCalibrated();
+
+    // Read raw sensor data (the clear channel is not used)
     RawColor raw{};
-    if (!readRawData(raw)) {
+    if (!readRawChannels(raw, CHANNEL_RGB)) {
         return false;
     }
 
@@ -366,11 +875,79 @@ bool ADPS9960_ColorSensor::readRGB(uint8_t &r, uint8_t &g, uint8_t &b) {
  * Useful when you want to pass RGB as a single object.
  * 
  * @param rgb Reference to RGB struct to populate
+ * @param encoding Output transfer function
  * @return true if read successful, false on error
  */
-bool ADPS9960_ColorSensor::readRGB(RGB &rgb) {
+bool ADPS9960_ColorSensor::readRGB(RGB &rgb, ColorEncoding encoding) {
     // Struct version - delegates to reference parameter version
-    return readRGB(rgb.r, rgb.g, rgb.b);
+    return readRGB(rgb.r, rgb.g, rgb.b, encoding);
+}
+
+/**
+ * @brief Read normalized RGB values with 16 bits per channel
+ *
+ * Same normalization as readRGB() but scaled to 0-65535, so the full
+ * calibrated ADC resolution is preserved for fine shade grading and for
+ * the HSV conversion.
+ *
+ * Normalization algorithm:
+ * RGB16_value = (raw_value * 65535) / max_value_from_calibration
+ *
+ * @param rgb Reference to RGB16 struct to populate
+ * @return true if read successful, false on sensor read error
+ *
+ * @note Automatically calibrates with defaults if not yet calibrated
+ * @note Applies the transfer matrix, then the 3D correction LUT, when set
+ */
+bool ADPS9960_ColorSensor::readRGB16(RGB16 &rgb) {
+    ensureCalibrated();
+
+    RawColor raw{};
+    if (!readRawChannels(raw, CHANNEL_RGB)) {
+        return false;
+    }
+
+    if (oversampleValid) {
+        // Keep the sub-count resolution gained by oversampling
+        normalizeOversampled(rgb);
+        applyCorrections(rgb);
+    } else {
+        normalizeRaw(raw, rgb);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Normalize a raw reading the way readRGB16() does
+ *
+ * Lets recorded or already acquired samples (readSample(), a replayed
+ * stream) go through the same color pipeline as a live reading.
+ *
+ * @param raw Raw sensor data
+ * @param rgb Reference to RGB16 struct to fill
+ */
+void ADPS9960_ColorSensor::normalizeRaw(const RawColor &raw, RGB16 &rgb) const {
+    rgb.r = normalizeToRGB16(raw.red, max_red);
+    rgb.g = normalizeToRGB16(raw.green, max_green);
+    rgb.b = normalizeToRGB16(raw.blue, max_blue);
+    applyCorrections(rgb);
+}
+
+/**
+ * @brief Apply the transfer matrix and the correction LUT, if set
+ * @param rgb Normalized color, corrected in place
+ */
+void ADPS9960_ColorSensor::applyCorrections(RGB16 &rgb) const {
+    // Optional per-unit transfer into the canonical device space
+    if (transferEnabled) {
+        applyTransferMatrix(transferMatrix, rgb);
+    }
+
+    // Optional non-linear spectral correction
+    if (correctionLUT != nullptr) {
+        applyColorCorrectionLUT(correctionLUT, correctionLUTSize, correctionLUTInProgmem, rgb);
+    }
 }
 
 /**
@@ -379,16 +956,17 @@ bool ADPS9960_ColorSensor::readRGB(RGB &rgb) {
  * Reads RGB color and packs it into a single 32-bit value in the
  * format 0x00RRGGBB (compatible with web colors, graphics libraries).
  * 
+ * @param encoding Output transfer function (ENCODING_SRGB for web colors)
  * @return Color in 0xRRGGBB format, returns 0x000000 (black) on error
  * 
  * @note Cannot distinguish between actual black and read errors
  * @note Use readColorHex(uint32_t&) if error checking is needed
  */
-uint32_t ADPS9960_ColorSensor::readColorHex() {
+uint32_t ADPS9960_ColorSensor::readColorHex(ColorEncoding encoding) {
     uint8_t r, g, b;
 
     // If read fails, return black (0x000000)
-    if (!readRGB(r, g, b)) {
+    if (!readRGB(r, g, b, encoding)) {
         return 0x000000;
     }
 
@@ -407,12 +985,13 @@ uint32_t ADPS9960_ColorSensor::readColorHex() {
  * color and read failure.
  * 
  * @param hexColor Reference to store hex color value (0xRRGGBB format)
+ * @param encoding Output transfer function
  * @return true if read successful, false on error (hexColor set to 0x000000)
  */
-bool ADPS9960_ColorSensor::readColorHex(uint32_t &hexColor) {
+bool ADPS9960_ColorSensor::readColorHex(uint32_t &hexColor, ColorEncoding encoding) {
     uint8_t r, g, b;
 
-    if (!readRGB(r, g, b)) {
+    if (!readRGB(r, g, b, encoding)) {
         hexColor = 0x000000;
         return false;
     }
@@ -430,13 +1009,15 @@ bool ADPS9960_ColorSensor::readColorHex(uint32_t &hexColor) {
  * Reads color and formats it as a CSS/HTML-compatible hex string
  * with leading hash symbol (e.g., "#FF0000" for red).
  * 
+ * @param encoding Output transfer function (ENCODING_SRGB matches what
+ *                 browsers and displays expect)
  * @return String in "#RRGGBB" format (7 characters including '#')
  * 
  * @note Returns "#000000" on read error
  * @note Useful for web applications, displays, logging
  */
-String ADPS9960_ColorSensor::getColorHexString() {
-    const uint32_t hex = readColorHex();
+String ADPS9960_ColorSensor::getColorHexString(ColorEncoding encoding) {
+    const uint32_t hex = readColorHex(encoding);
 
     char buffer[8]; // "#RRGGBB\0" = 8 characters with null terminator
     sprintf(buffer, "#%06lX", hex); // Format with 6 hex digits, uppercase
@@ -458,15 +1039,15 @@ String ADPS9960_ColorSensor::getColorHexString() {
  * @param vMax Maximum value/brightness (0.0-1.0)
  * @return true if color is within all ranges, false otherwise
  * 
- * @note Returns false if sensor read fails
+ * @note Returns false if sensor read fails or a channel is clipped
  * @note Handles hue wrap-around (e.g., red crossing 0/360)
  */
 bool ADPS9960_ColorSensor::isColorInRange(float hMin, float hMax, 
                                          float sMin, float sMax, 
                                          float vMin, float vMax) {
     HSV hsv{};
-    if (!readColorHSV(hsv)) {
-        return false;
+    if (!readColorHSV(hsv) || lastSaturatedMask != 0) {
+        return false; // Read error or clipped channel (hue unreliable)
     }
 
     // Handle hue wrap-around (e.g., red: 350-10 degrees)
@@ -504,12 +1085,13 @@ bool ADPS9960_ColorSensor::isColorInRange(float hMin, float hMax,
  * 
  * @param color StandardColor enum value to check
  * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
- * @return true if color matches the standard, false otherwise
+ * @return true if color matches the standard, false otherwise (also on
+ *         read error or clipped channel)
  */
 bool ADPS9960_ColorSensor::isStandardColor(StandardColor color, float tolerance) {
     HSV hsv{};
-    if (!readColorHSV(hsv)) {
-        return false;
+    if (!readColorHSV(hsv) || lastSaturatedMask != 0) {
+        return false; // Read error or clipped channel, as detectColor()
     }
 
     // Clamp tolerance to valid range
@@ -603,17 +1185,34 @@ bool ADPS9960_ColorSensor::isStandardColor(StandardColor color, float tolerance)
  * - MAGENTA: [295-340)
  *
  * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
- * @return StandardColor enum of detected color, UNKNOWN if no match or read error
+ * @return StandardColor enum of detected color, UNKNOWN if no match, read error
+ *         or clipped channel
  *
  * @note Returns UNKNOWN if sensor read fails
  * @note Returns UNKNOWN if no standard color matches within tolerance
  */
 StandardColor ADPS9960_ColorSensor::detectColor(float tolerance) {
     HSV hsv{};
-    if (!readColorHSV(hsv)) {
-        return StandardColor::UNKNOWN;
+    if (!readColorHSV(hsv) || lastSaturatedMask != 0) {
+        return StandardColor::UNKNOWN; // Read error or clipped channel (hue unreliable)
     }
+    energyReport.classifications++;
 
+    return classifyHSV(hsv, tolerance);
+}
+
+/**
+ * @brief Classify an HSV color into the closest standard color
+ *
+ * Pure function behind detectColor(): applies the BLACK, WHITE and
+ * chromatic hue band rules to an already converted color. Useful for
+ * classifying recorded samples or colors from readRGB16().
+ *
+ * @param hsv Color to classify
+ * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
+ * @return StandardColor enum of matching color, UNKNOWN if no match
+ */
+StandardColor ADPS9960_ColorSensor::classifyHSV(const HSV &hsv, float tolerance) {
     // Clamp tolerance to valid range
     if (tolerance < 0.0f) tolerance = 0.0f;
     if (tolerance > 1.0f) tolerance = 1.0f;
@@ -636,59 +1235,12 @@ StandardColor ADPS9960_ColorSensor::detectColor(float tolerance) {
         return StandardColor::UNKNOWN; // Too desaturated or dark for chromatic colors
     }
 
-    // RED (wraps around 0/360): [340-360) ∪ [0-20)
-    if (hsv.h < 20.0f || hsv.h >= 340.0f) {
-        if (hsv.s >= (0.5f - tolerance) && hsv.v >= (0.3f - tolerance)) {
-            return StandardColor::RED;
-        }
-    }
-
-    // ORANGE: [20-50)
-    if (hsv.h >= 20.0f && hsv.h < 50.0f) {
-        if (hsv.s >= (0.5f - tolerance) && hsv.v >= (0.4f - tolerance)) {
-            return StandardColor::ORANGE;
-        }
-    }
-
-    // YELLOW: [50-80)
-    if (hsv.h >= 50.0f && hsv.h < 80.0f) {
-        if (hsv.s >= (0.5f - tolerance) && hsv.v >= (0.5f - tolerance)) {
-            return StandardColor::YELLOW;
-        }
-    }
-
-    // GREEN: [80-165)
-    if (hsv.h >= 80.0f && hsv.h < 165.0f) {
-        if (hsv.s >= (0.4f - tolerance) && hsv.v >= (0.3f - tolerance)) {
-            return StandardColor::GREEN;
-        }
-    }
-
-    // CYAN: [165-210) ← Your H=199° will match here!
-    if (hsv.h >= 165.0f && hsv.h < 210.0f) {
-        if (hsv.s >= (0.4f - tolerance) && hsv.v >= (0.4f - tolerance)) {
-            return StandardColor::CYAN;
-        }
-    }
-
-    // BLUE: [210-265)
-    if (hsv.h >= 210.0f && hsv.h < 265.0f) {
-        if (hsv.s >= (0.4f - tolerance) && hsv.v >= (0.3f - tolerance)) {
-            return StandardColor::BLUE;
-        }
-    }
-
-    // PURPLE: [265-295)
-    if (hsv.h >= 265.0f && hsv.h < 295.0f) {
-        if (hsv.s >= (0.4f - tolerance) && hsv.v >= (0.3f - tolerance)) {
-            return StandardColor::PURPLE;
-        }
-    }
-
-    // MAGENTA: [295-340)
-    if (hsv.h >= 295.0f && hsv.h < 340.0f) {
-        if (hsv.s >= (0.5f - tolerance) && hsv.v >= (0.4f - tolerance)) {
-            return StandardColor::MAGENTA;
+    // Chromatic colors by hue band (see CHROMATIC_RANGES)
+    for (const ChromaticRange &range : CHROMATIC_RANGES) {
+        if (isHueInBand(static_cast<uint16_t>(hsv.h), range) &&
+            hsv.s >= (range.sMinPercent / 100.0f - tolerance) &&
+            hsv.v >= (range.vMinPercent / 100.0f - tolerance)) {
+            return range.color;
         }
     }
 
@@ -712,13 +1264,29 @@ StandardColor ADPS9960_ColorSensor::detectColor(float tolerance) {
  *         otherwise false if the RGB data cannot be read.
  */
 bool ADPS9960_ColorSensor::readColorHSV(HSV &hsvColor) {
-    RGB rgbColor{};
-    if (!readRGB(rgbColor)) {
+    RGB16 rgbColor{};
+    if (!readRGB16(rgbColor)) {
         return false;
     }
-    const float rf = static_cast<float>(rgbColor.r) / 255.0f;
-    const float gf = static_cast<float>(rgbColor.g) / 255.0f;
-    const float bf = static_cast<float>(rgbColor.b) / 255.0f;
+
+    convertToHSV(rgbColor, hsvColor);
+    return true;
+}
+
+/**
+ * @brief Convert a 16-bit RGB color to HSV
+ *
+ * Computes the maximum, minimum and delta of the normalized channels to
+ * derive hue, saturation and value. Working from 16-bit input keeps hue
+ * resolution at low light, where 8-bit values collapse to a few codes.
+ *
+ * @param rgbColor Source color (0-65535 per channel)
+ * @param hsvColor An HSV structure to store the converted color data
+ */
+void ADPS9960_ColorSensor::convertToHSV(const RGB16 &rgbColor, HSV &hsvColor) {
+    const float rf = static_cast<float>(rgbColor.r) / 65535.0f;
+    const float gf = static_cast<float>(rgbColor.g) / 65535.0f;
+    const float bf = static_cast<float>(rgbColor.b) / 65535.0f;
 
     float maxc = rf;
     if (gf > maxc) maxc = gf;
@@ -737,7 +1305,7 @@ bool ADPS9960_ColorSensor::readColorHSV(HSV &hsvColor) {
     if (delta < 0.00001f) {
         hsvColor.h = 0;
         hsvColor.s = 0;
-        return true;
+        return;
     }
 
     // S (saturation)
@@ -760,10 +1328,189 @@ bool ADPS9960_ColorSensor::readColorHSV(HSV &hsvColor) {
 
     h *= 60.0f; // in degrees 0-360
     hsvColor.h = h;
+}
 
+/**
+ * @brief Read brightness-independent chromaticity coordinates
+ *
+ * Reads raw data and converts it with toChromaticity(). Unlike readRGB(),
+ * the r/g/b coordinates do not move when the illuminance changes, so a
+ * shadow or an opened door does not require recalibration.
+ *
+ * @param chroma Reference to Chromaticity struct to populate
+ * @param mode Normalization reference (channel sum or clear channel)
+ * @return true if read successful, false on sensor read error
+ *
+ * @note Automatically calibrates with defaults if not yet calibrated
+ */
+bool ADPS9960_ColorSensor::readChromaticity(Chromaticity &chroma, ChromaticityMode mode) {
+    ensureCalibrated();
+
+    RawColor raw{};
+    if (!readRawData(raw)) {
+        return false;
+    }
+
+    toChromaticity(raw, chroma, mode);
     return true;
 }
 
+/**
+ * @brief Convert a raw reading into chromaticity coordinates
+ *
+ * Algorithm (integer arithmetic only):
+ * 1. White-balance each channel: w = raw * CHROMA_SCALE / max_from_calibration
+ * 2. Pick the reference: R+G+B (CHROMA_BY_SUM) or clear (CHROMA_BY_CLEAR)
+ * 3. Shift operands down until w * CHROMA_SCALE fits in 32 bits
+ * 4. Coordinate = w * CHROMA_SCALE / reference, clamped to 16 bits
+ *
+ * A calibrated white surface maps to CHROMA_SCALE / 3 per channel in sum
+ * mode and to CHROMA_SCALE per channel in clear mode, at any brightness.
+ *
+ * @param raw Raw sensor data
+ * @param chroma Reference to Chromaticity struct to populate
+ * @param mode Normalization reference
+ *
+ * @note All coordinates are 0 when the reference is 0 (no light)
+ */
+void ADPS9960_ColorSensor::toChromaticity(const RawColor &raw, Chromaticity &chroma,
+                                          ChromaticityMode mode) const {
+    // Step 1: white balance against calibration (each term < 2^28)
+    uint32_t wr = max_red     ? (static_cast<uint32_t>(raw.red)     * CHROMA_SCALE) / max_red     : 0;
+    uint32_t wg = max_green   ? (static_cast<uint32_t>(raw.green)   * CHROMA_SCALE) / max_green   : 0;
+    uint32_t wb = max_blue    ? (static_cast<uint32_t>(raw.blue)    * CHROMA_SCALE) / max_blue    : 0;
+    uint32_t wc = max_ambient ? (static_cast<uint32_t>(raw.ambient) * CHROMA_SCALE) / max_ambient : 0;
+
+    chroma.intensity = wc > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(wc);
+
+    // Step 2: select reference
+    uint32_t reference = (mode == CHROMA_BY_CLEAR) ? wc : wr + wg + wb;
+    if (reference == 0) {
+        chroma.r = chroma.g = chroma.b = 0;
+        return;
+    }
+
+    // Step 3: keep every numerator below 2^20 so that x * 4096 fits in uint32_t
+    uint32_t largest = reference;
+    if (wr > largest) largest = wr;
+    if (wg > largest) largest = wg;
+    if (wb > largest) largest = wb;
+    while (largest > 0xFFFFFUL) {
+        largest >>= 1;
+        reference >>= 1;
+        wr >>= 1;
+        wg >>= 1;
+        wb >>= 1;
+    }
+    if (reference == 0) {
+        reference = 1;
+    }
+
+    // Step 4: divide and clamp
+    const uint32_t cr = (wr * CHROMA_SCALE) / reference;
+    const uint32_t cg = (wg * CHROMA_SCALE) / reference;
+    const uint32_t cb = (wb * CHROMA_SCALE) / reference;
+    chroma.r = cr > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(cr);
+    chroma.g = cg > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(cg);
+    chroma.b = cb > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(cb);
+}
+
+/**
+ * @brief Detect a standard color in chromaticity space
+ *
+ * Hue and saturation are computed from the chromaticity coordinates with
+ * integer arithmetic and matched against the same hue bands as
+ * detectColor(). Chromatic colors ignore the value threshold, which makes
+ * the result independent of illuminance. Priority order:
+ * 1. BLACK if the clear channel is below MIN_THRESHOLD (no usable signal)
+ * 2. Neutral (low saturation): WHITE if intensity is high, BLACK if low
+ * 3. Chromatic colors by hue band and minimum saturation
+ *
+ * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
+ * @return StandardColor enum of detected color, UNKNOWN if no match, read error
+ *         or clipped channel
+ *
+ * @note Neutral surfaces are told apart only by brightness, so WHITE and
+ *       BLACK are still affected by the light level
+ */
+StandardColor ADPS9960_ColorSensor::detectColorChromaticity(float tolerance) {
+    ensureCalibrated();
+
+    RawColor raw{};
+    if (!readRawData(raw) || lastSaturatedMask != 0) {
+        return StandardColor::UNKNOWN; // Read error or clipped channel
+    }
+    energyReport.classifications++;
+
+    // Priority 1: not enough light to measure any chromaticity
+    if (raw.ambient < MIN_THRESHOLD) {
+        return StandardColor::BLACK;
+    }
+
+    Chromaticity chroma{};
+    toChromaticity(raw, chroma, CHROMA_BY_SUM);
+
+    // Clamp tolerance and convert it once to percent
+    if (tolerance < 0.0f) tolerance = 0.0f;
+    if (tolerance > 1.0f) tolerance = 1.0f;
+    const int32_t tolPercent = static_cast<int32_t>(tolerance * 100.0f + 0.5f);
+
+    uint32_t maxc = chroma.r;
+    if (chroma.g > maxc) maxc = chroma.g;
+    if (chroma.b > maxc) maxc = chroma.b;
+
+    uint32_t minc = chroma.r;
+    if (chroma.g < minc) minc = chroma.g;
+    if (chroma.b < minc) minc = chroma.b;
+
+    if (maxc == 0) {
+        return StandardColor::BLACK;
+    }
+
+    const uint32_t delta = maxc - minc;
+    const int32_t satPercent = static_cast<int32_t>((delta * 100UL) / maxc);
+    const int32_t intensityPercent =
+        static_cast<int32_t>((static_cast<uint32_t>(chroma.intensity) * 100UL) / CHROMA_SCALE);
+
+    // Priority 2: neutral surfaces
+    if (satPercent <= 20 + tolPercent) {
+        if (intensityPercent >= 70 - tolPercent) {
+            return StandardColor::WHITE;
+        }
+        if (intensityPercent <= 20 + tolPercent) {
+            return StandardColor::BLACK;
+        }
+        return StandardColor::UNKNOWN;
+    }
+
+    if (satPercent < 30 - tolPercent) {
+        return StandardColor::UNKNOWN; // Too desaturated for chromatic colors
+    }
+
+    // Integer hue in whole degrees (same sextant formula as convertToHSV)
+    const int32_t d = static_cast<int32_t>(delta);
+    int32_t hue;
+    if (maxc == chroma.r) {
+        hue = floorDiv(60L * (static_cast<int32_t>(chroma.g) - static_cast<int32_t>(chroma.b)), d);
+        if (hue < 0) hue += 360;
+    } else if (maxc == chroma.g) {
+        hue = 120L + floorDiv(60L * (static_cast<int32_t>(chroma.b) - static_cast<int32_t>(chroma.r)), d);
+    } else {
+        hue = 240L + floorDiv(60L * (static_cast<int32_t>(chroma.r) - static_cast<int32_t>(chroma.g)), d);
+    }
+    if (hue >= 360) hue -= 360;
+
+    // Priority 3: chromatic colors (saturation only, no value threshold)
+    for (const ChromaticRange &range : CHROMATIC_RANGES) {
+        if (isHueInBand(static_cast<uint16_t>(hue), range) &&
+            satPercent >= static_cast<int32_t>(range.sMinPercent) - tolPercent) {
+            return range.color;
+        }
+    }
+
+    return StandardColor::UNKNOWN;
+}
+
 /**
  * @brief Normalize a 16-bit raw sensor value to 8-bit RGB range
  * 
@@ -801,3 +1548,35 @@ uint8_t normalizeToRGB(const uint16_t rawValue, const uint16_t maxValue) {
 
     return static_cast<uint8_t>(normalized);
 }
+
+/**
+ * @brief Normalize a 16-bit raw sensor value to the full 16-bit range
+ *
+ * 16-bit counterpart of normalizeToRGB(). The product of two 16-bit
+ * values always fits in uint32_t, so no precision is lost before the
+ * division.
+ *
+ * Formula: result = (rawValue * 65535) / maxValue
+ *
+ * @param rawValue Raw sensor reading (0-65535)
+ * @param maxValue Maximum value from calibration
+ * @return Normalized value (0-65535)
+ *
+ * @note Returns 0 if maxValue is 0 (prevents division by zero)
+ * @note Clamps result to 65535 if normalization exceeds maximum
+ */
+uint16_t normalizeToRGB16(const uint16_t rawValue, const uint16_t maxValue) {
+    // Prevent division by zero
+    if (maxValue == 0) {
+        return 0;
+    }
+
+    const uint32_t normalized = (static_cast<uint32_t>(rawValue) * 65535UL) / maxValue;
+
+    // Clamp to valid 16-bit range
+    if (normalized > 65535UL) {
+        return 65535;
+    }
+
+    return static_cast<uint16_t>(normalized);
+}
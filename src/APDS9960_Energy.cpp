@@ -0,0 +1,187 @@
+/**
+ * @file APDS9960_Energy.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Energy accounting for the APDS9960_ColorSensor class
+ *
+ * Estimates the energy spent on color sensing from what the library already
+ * knows, without a current meter:
+ *
+ *   sensor = V * (Ta * Iactive + Tw * Iwait) / (Ta + Tw) * t   (PON and AEN set)
+ *            V * Iwait * t                                  (PON only: ALS held or stopped)
+ *            V * Isleep * t                                 (PON cleared)
+ *   LED    = V * Iled * tLED
+ *   bus    = bytes * Ebyte
+ *   MCU    = V * Imcu * tawake
+ *
+ * The state comes from the ENABLE shadow, which every ENABLE access of the
+ * register layer updates after charging the time spent in the old state.
+ * Ta and Tw come from the ATIME and WTIME shadows, the bus bytes from the
+ * byte counter of the register layer and the awake time from the duration
+ * of the library reads. The figures in EnergyModel are typical values; for
+ * absolute numbers replace them with measurements of the actual board.
+ * Relative numbers (uJ per classification for two configurations) are
+ * meaningful with the defaults.
+ *
+ * The model is converted once to integer powers (nW) and the charges are
+ * summed as integer picojoules (nW * ms), so months of small increments
+ * add up exactly; floats appear only when the report is read.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @brief Scale a model figure to an unsigned integer rate
+ * @param value Figure from EnergyModel
+ * @param scale Unit conversion factor
+ * @return Rounded value, clamped to 0-UINT32_MAX
+ */
+static uint32_t toRate(float value, float scale) {
+    const float scaled = value * scale + 0.5f;
+    if (!(scaled > 0.0f)) {
+        return 0;
+    }
+    return scaled >= 4294967295.0f ? 4294967295UL : static_cast<uint32_t>(scaled);
+}
+
+/**
+ * @brief Replace the figures used by the energy model
+ *
+ * The energy used so far is charged with the old figures first.
+ *
+ * @param model New figures
+ */
+void ADPS9960_ColorSensor::setEnergyModel(const EnergyModel &model) {
+    accountEnergy();
+    energyModel = model;
+    updateEnergyRates();
+}
+
+/**
+ * @brief Convert the figures of energyModel to the integer rates used by accountEnergy()
+ *
+ * uA * V = uW (x1000 nW), mA * V = mW (x1000000 nW), uJ x1000000 pJ.
+ */
+void ADPS9960_ColorSensor::updateEnergyRates() {
+    const float voltage = energyModel.supplyVoltage;
+    energyActiveNw = toRate(energyModel.activeCurrentUa * voltage, 1000.0f);
+    energyWaitNw = toRate(energyModel.waitCurrentUa * voltage, 1000.0f);
+    energySleepNw = toRate(energyModel.sleepCurrentUa * voltage, 1000.0f);
+    energyLedNw = toRate(energyModel.ledCurrentMa * voltage, 1000000.0f);
+    energyMcuNw = toRate(energyModel.mcuAwakeCurrentMa * voltage, 1000000.0f);
+    energyBytePj = toRate(energyModel.busEnergyPerByteUj, 1000000.0f);
+}
+
+/**
+ * @brief Get the figures used by the energy model
+ * @return Reference to the model
+ */
+const ADPS9960_ColorSensor::EnergyModel &ADPS9960_ColorSensor::getEnergyModel() const {
+    return energyModel;
+}
+
+/**
+ * @brief Bring the energy totals up to date and return them
+ *
+ * The integer charges are converted to microjoules here (pJ / 1e6), and
+ * the average current follows as uJ / (V * ms) = mA, * 1000 = uA.
+ *
+ * @return Reference to the report
+ */
+const ADPS9960_ColorSensor::EnergyReport &ADPS9960_ColorSensor::getEnergyReport() {
+    accountEnergy();
+
+    energyReport.sensorUj = static_cast<float>(energySensorPj) / 1000000.0f;
+    energyReport.ledUj = static_cast<float>(energyLedPj) / 1000000.0f;
+    energyReport.busUj = static_cast<float>(energyBusPj) / 1000000.0f;
+    energyReport.mcuUj = static_cast<float>(energyMcuPj) / 1000000.0f;
+
+    const uint64_t totalPj = energySensorPj + energyLedPj + energyBusPj + energyMcuPj;
+    energyReport.totalUj = static_cast<float>(totalPj) / 1000000.0f;
+    const float voltage = energyModel.supplyVoltage;
+    energyReport.averageCurrentUa = energyReport.elapsedMs > 0 && voltage > 0.0f
+        ? energyReport.totalUj * 1000.0f / (voltage * static_cast<float>(energyReport.elapsedMs))
+        : 0.0f;
+    return energyReport;
+}
+
+/**
+ * @brief Restart the energy totals from now
+ */
+void ADPS9960_ColorSensor::resetEnergyReport() {
+    energyReport = EnergyReport{};
+    energyLastUs = micros();
+    energyLastBusBytes = busByteCount;
+    energyAwakeUs = 0;
+    energyLedOnUs = 0;
+    energySensorPj = 0;
+    energyLedPj = 0;
+    energyBusPj = 0;
+    energyMcuPj = 0;
+}
+
+/**
+ * @brief Charge the energy used since the last accounting to the totals
+ *
+ * Integer arithmetic only, since it runs on every read.
+ *
+ * Algorithm:
+ * 1. Take the elapsed time in whole milliseconds; the remainder is carried
+ *    to the next accounting, so elapsedMs never drifts
+ * 2. Charge the sensor at the power of its ENABLE state: duty-cycle
+ *    weighted over ATIME/WTIME while the ALS runs, the wait current while
+ *    it is powered but held or stopped, the sleep current without PON
+ *    (callers account before changing any of them)
+ * 3. Charge the bus bytes since the last accounting
+ * 4. Charge the pending MCU awake and LED on times
+ */
+void ADPS9960_ColorSensor::accountEnergy() {
+    if (!energyTracking) {
+        return;
+    }
+
+    // Step 1: elapsed time
+    const uint32_t elapsedMs = (static_cast<uint32_t>(micros()) - energyLastUs) / 1000UL;
+    energyLastUs += elapsedMs * 1000UL;
+    energyReport.elapsedMs += elapsedMs;
+
+    // Step 2: sensor supply (nW * ms = pJ)
+    uint64_t sensorNw;
+    if (!(enableShadow & ENABLE_PON)) {
+        sensorNw = energySleepNw;
+    } else if (!(enableShadow & ENABLE_AEN)) {
+        sensorNw = energyWaitNw; // Powered, no integration running
+    } else {
+        const uint64_t activeUs = getIntegrationTimeUs();
+        const uint64_t waitUs = getWaitTimeUs();
+        sensorNw = (activeUs * energyActiveNw + waitUs * energyWaitNw) / (activeUs + waitUs);
+    }
+    energySensorPj += sensorNw * elapsedMs;
+
+    // Step 3: bus traffic (the counter may have been reset in between)
+    const uint32_t bytes = busByteCount >= energyLastBusBytes ? busByteCount - energyLastBusBytes
+                                                              : busByteCount;
+    energyLastBusBytes = busByteCount;
+    energyReport.busBytes += bytes;
+    energyBusPj += static_cast<uint64_t>(bytes) * energyBytePj;
+
+    // Step 4: MCU and LED (nW * us / 1000 = pJ)
+    energyReport.mcuAwakeUs += energyAwakeUs;
+    energyMcuPj += (static_cast<uint64_t>(energyMcuNw) * energyAwakeUs + 500) / 1000;
+    energyAwakeUs = 0;
+
+    energyReport.ledOnUs += energyLedOnUs;
+    energyLedPj += (static_cast<uint64_t>(energyLedNw) * energyLedOnUs + 500) / 1000;
+    energyLedOnUs = 0;
+}
+
+/**
+ * @brief Update the ENABLE shadow, charging the time spent in the old state first
+ * @param enable ENABLE value now in the sensor
+ */
+void ADPS9960_ColorSensor::trackEnable(uint8_t enable) {
+    if (enable != enableShadow) {
+        accountEnergy();
+        enableShadow = enable;
+    }
+}
@@ -0,0 +1,437 @@
+/**
+ * @file APDS9960_Exposure.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Gain/integration time control and exposure-independent calibration
+ *
+ * The white reference recorded by calibrate() is only valid for the gain
+ * (AGAIN) and integration time (ATIME) active at that moment. Instead of
+ * recalibrating after every exposure change, the reference is stored with
+ * its exposure and rescaled:
+ *
+ *   active = reference * ratio[gain] / ratio[refGain] * cycles(ATIME) / cycles(refATIME)
+ *
+ * where cycles(ATIME) = 256 - ATIME. The channel counts are proportional
+ * to the number of integration cycles, while the real gain steps deviate
+ * from the nominal 1/4/16/64, so they can be measured once with
+ * calibrateGainRatios().
+ */
+
+#include "APDS9960_ColorSensor.h"
+#include <Wire.h>
+
+/**
+ * @brief Set the analog gain of the color channels
+ *
+ * Writes AGAIN through the SparkFun driver and rescales the active white
+ * reference, so normalized readings stay consistent without recalibration.
+ *
+ * @param gain AGAIN_1X, AGAIN_4X, AGAIN_16X or AGAIN_64X
+ * @return true on success, false for invalid gain or bus error
+ *
+ * @note The first reading after the change may still come from an
+ *       integration started with the previous gain
+ */
+bool ADPS9960_ColorSensor::setGain(uint8_t gain) {
+    if (gain >= GAIN_COUNT) {
+        return false;
+    }
+
+    if (!sensor.setAmbientLightGain(gain)) {
+        return false;
+    }
+
+    currentGain = gain;
+    updateActiveCalibration();
+    return true;
+}
+
+/**
+ * @brief Get the current analog gain
+ * @return AGAIN_1X..AGAIN_64X (shadow copy, no bus access)
+ */
+uint8_t ADPS9960_ColorSensor::getGain() const {
+    return currentGain;
+}
+
+/**
+ * @brief Set the ALS integration time
+ *
+ * Longer integration improves resolution of dark targets, shorter
+ * integration raises the sample rate and avoids saturation.
+ * Common values: 255 = 2.78 ms, 219 = 103 ms (default), 182 = 206 ms,
+ * 0 = 712 ms.
+ *
+ * @param atime ATIME register value
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::setIntegrationTime(uint8_t atime) {
+    accountEnergy(); // Charge the elapsed time at the old duty cycle
+    if (!writeRegister(REG_ATIME, atime)) {
+        return false;
+    }
+
+    currentATime = atime;
+    updateActiveCalibration();
+    return true;
+}
+
+/**
+ * @brief Get the current ATIME register value
+ * @return ATIME (shadow copy, no bus access)
+ */
+uint8_t ADPS9960_ColorSensor::getIntegrationTime() const {
+    return currentATime;
+}
+
+/**
+ * @brief Get the current integration time in microseconds
+ * @return Integration time ((256 - ATIME) cycles of 2.78 ms)
+ */
+uint32_t ADPS9960_ColorSensor::getIntegrationTimeUs() const {
+    return (256UL - currentATime) * INTEGRATION_CYCLE_US;
+}
+
+/**
+ * @brief Set the idle time of the sensor between integrations (WTIME)
+ *
+ * With WEN set the sensor sleeps (wait state) after each integration, which
+ * lowers the sample rate and the supply current without any MCU polling.
+ * A wait lasts (256 - WTIME) cycles of 2.78 ms, twelve times longer with
+ * WLONG, so the range is 2.78 ms to 8.54 s.
+ *
+ * Algorithm:
+ * 1. Round the wait to cycles; above 256 cycles switch to WLONG steps
+ * 2. Write WTIME and the WLONG bit of CONFIG1
+ * 3. Set or clear WEN in ENABLE
+ *
+ * @param waitUs Wait in microseconds (0 disables the wait state)
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::setWaitTime(uint32_t waitUs) {
+    accountEnergy(); // Charge the elapsed time at the old duty cycle
+    uint8_t enable, config1;
+    if (!readRegister(REG_ENABLE, enable) || !readRegister(REG_CONFIG1, config1)) {
+        return false;
+    }
+
+    if (waitUs == 0) {
+        if (!writeRegister(REG_ENABLE, enable & ~ENABLE_WEN)) {
+            return false;
+        }
+        waitEnabled = false;
+        return true;
+    }
+
+    // Step 1: cycles, in long steps if needed
+    const bool waitLong = waitUs > 256UL * INTEGRATION_CYCLE_US;
+    const uint32_t step = waitLong ? 12UL * INTEGRATION_CYCLE_US : INTEGRATION_CYCLE_US;
+    uint32_t cycles = (waitUs + step / 2) / step;
+    if (cycles < 1) cycles = 1;
+    if (cycles > 256) cycles = 256;
+    const uint8_t wtime = static_cast<uint8_t>(256 - cycles);
+
+    // Steps 2-3: program and enable
+    config1 = waitLong ? (config1 | CONFIG1_WLONG) : (config1 & ~CONFIG1_WLONG);
+    if (!writeRegister(REG_WTIME, wtime) ||
+        !writeRegister(REG_CONFIG1, config1) ||
+        !writeRegister(REG_ENABLE, enable | ENABLE_WEN)) {
+        return false;
+    }
+
+    currentWTime = wtime;
+    currentWaitLong = waitLong;
+    waitEnabled = true;
+    return true;
+}
+
+/**
+ * @brief Get the wait time between integrations
+ * @return Programmed wait in microseconds (0 if disabled)
+ */
+uint32_t ADPS9960_ColorSensor::getWaitTimeUs() const {
+    if (!waitEnabled) {
+        return 0;
+    }
+    const uint32_t waitUs = (256UL - currentWTime) * INTEGRATION_CYCLE_US;
+    return currentWaitLong ? 12UL * waitUs : waitUs;
+}
+
+/**
+ * @brief Get the time between two fresh results
+ * @return Integration time plus wait time in microseconds
+ */
+uint32_t ADPS9960_ColorSensor::getSamplePeriodUs() const {
+    return getIntegrationTimeUs() + getWaitTimeUs();
+}
+
+/**
+ * @brief Get the largest count a channel can reach at the current ATIME
+ *
+ * Each integration cycle adds up to 1025 counts, so short integration
+ * times saturate well below 65535.
+ *
+ * @return Full-scale count for the current integration time
+ */
+uint16_t ADPS9960_ColorSensor::getFullScale() const {
+    const uint32_t fullScale = (256UL - currentATime) * COUNTS_PER_CYCLE;
+    return fullScale > 65535UL ? 65535 : static_cast<uint16_t>(fullScale);
+}
+
+/**
+ * @brief Measure the real ratios between the four gain settings
+ *
+ * Averages all four channels at each gain and chains the ratios of
+ * consecutive steps (1x->4x, 4x->16x, 16x->64x) per channel: the gain
+ * stages do not match exactly across the four photodiode channels. A step
+ * is measured when the lower gain gives enough signal and neither gain
+ * saturates. Otherwise a color channel takes the step of the clear
+ * channel, and the clear channel keeps the nominal factor 4.
+ *
+ * Algorithm:
+ * 1. For each gain: switch, restart the integration so that none mixes two
+ *    gains, and average samplesPerGain fresh integrations (AVALID)
+ * 2. Chain measured step ratios per channel starting from 1x = 1.0
+ * 3. Restore the original gain and rescale the active calibration
+ *
+ * @param samplesPerGain Readings averaged at each gain (0 is treated as 1)
+ * @return true if all three steps of the clear channel were measured,
+ *         false if any nominal value was kept or the sensor could not be read
+ *
+ * @note Target and lighting must not change during the measurement
+ */
+bool ADPS9960_ColorSensor::calibrateGainRatios(uint8_t samplesPerGain) {
+    if (samplesPerGain == 0) {
+        samplesPerGain = 1;
+    }
+
+    const uint16_t saturation = getSaturationLevel();
+
+    uint32_t average[GAIN_COUNT][4] = {};
+    bool saturated[GAIN_COUNT][4] = {};
+    bool allRead = true;
+
+    // Step 1: average every channel at every gain, one fresh integration per sample
+    for (uint8_t gain = 0; gain < GAIN_COUNT; gain++) {
+        if (!sensor.setAmbientLightGain(gain) || !restartIntegration()) {
+            allRead = false;
+            continue;
+        }
+
+        uint32_t sum[4] = {0, 0, 0, 0};
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < samplesPerGain; i++) {
+            RawColor raw{};
+            if (!waitForValidData() || !readSensorChannels(raw)) {
+                continue;
+            }
+            const uint16_t values[4] = {raw.ambient, raw.red, raw.green, raw.blue};
+            for (uint8_t c = 0; c < 4; c++) {
+                if (values[c] >= saturation) saturated[gain][c] = true;
+                sum[c] += values[c];
+            }
+            count++;
+        }
+
+        if (count == 0) {
+            allRead = false;
+            continue;
+        }
+        for (uint8_t c = 0; c < 4; c++) {
+            average[gain][c] = sum[c] / count;
+        }
+    }
+
+    // Step 2: chain step ratios in Q8.8; weak color channels follow the clear step
+    bool allMeasured = allRead;
+    for (uint8_t c = 0; c < 4; c++) {
+        gainRatios[0][c] = 256;
+    }
+    for (uint8_t gain = 1; gain < GAIN_COUNT; gain++) {
+        for (uint8_t c = 0; c < 4; c++) {
+            const bool usable = average[gain - 1][c] >= static_cast<uint32_t>(MIN_THRESHOLD) * 10 &&
+                                !saturated[gain - 1][c] && !saturated[gain][c];
+            uint32_t ratio;
+            if (usable) {
+                ratio = (static_cast<uint32_t>(gainRatios[gain - 1][c]) * average[gain][c]) / average[gain - 1][c];
+            } else if (c > 0) {
+                ratio = (static_cast<uint32_t>(gainRatios[gain - 1][c]) * gainRatios[gain][0]) /
+                        gainRatios[gain - 1][0];
+            } else {
+                ratio = static_cast<uint32_t>(gainRatios[gain - 1][c]) * 4;
+                allMeasured = false;
+            }
+            gainRatios[gain][c] = ratio > 65535UL ? 65535 : static_cast<uint16_t>(ratio);
+        }
+    }
+
+    // Step 3: restore the user's gain with a clean integration
+    restoreExposure();
+    updateActiveCalibration();
+
+    return allMeasured;
+}
+
+/**
+ * @brief Get the gain factor of a setting relative to AGAIN_1X
+ * @param gain AGAIN_1X..AGAIN_64X
+ * @param channel 0 = clear, 1 = red, 2 = green, 3 = blue
+ * @return Gain factor (1.0 for AGAIN_1X), 0 for invalid gain or channel
+ */
+float ADPS9960_ColorSensor::getGainRatio(uint8_t gain, uint8_t channel) const {
+    if (gain >= GAIN_COUNT || channel >= 4) {
+        return 0.0f;
+    }
+    return static_cast<float>(gainRatios[gain][channel]) / 256.0f;
+}
+
+/**
+ * @brief Get the calibration white reference and its exposure
+ * @return Reference to the stored CalibrationData
+ */
+const ADPS9960_ColorSensor::CalibrationData &ADPS9960_ColorSensor::getCalibrationData() const {
+    return calibration;
+}
+
+/**
+ * @brief Store the current max values as white reference for the current exposure
+ *
+ * Called after calibrate() and setDefaultCalibration(), when max_* hold
+ * values measured (or assumed) at the active gain and ATIME.
+ */
+void ADPS9960_ColorSensor::storeCalibrationReference() {
+    calibration.maxAmbient = max_ambient;
+    calibration.maxRed = max_red;
+    calibration.maxGreen = max_green;
+    calibration.maxBlue = max_blue;
+    calibration.gain = currentGain;
+    calibration.atime = currentATime;
+    resetWhiteBalanceTracking();
+}
+
+/**
+ * @brief Scale one reference value to the current exposure
+ * @param reference White reference at the calibration exposure
+ * @param gainNum Gain ratio of the current gain (Q8.8)
+ * @param gainDen Gain ratio of the calibration gain (Q8.8)
+ * @param cyclesNum Integration cycles of the current ATIME (1-256)
+ * @param cyclesDen Integration cycles of the calibration ATIME (1-256)
+ * @return Scaled reference, clamped to 1-65535 (0 stays 0)
+ */
+static uint16_t scaleReference(uint16_t reference, uint16_t gainNum, uint16_t gainDen,
+                               uint16_t cyclesNum, uint16_t cyclesDen) {
+    if (reference == 0 || gainDen == 0) {
+        return 0;
+    }
+
+    // reference * gainNum < 2^30, / gainDen (>= 256 in practice) < 2^22, * cycles < 2^30
+    uint32_t scaled = (static_cast<uint32_t>(reference) * gainNum) / gainDen;
+    scaled = (scaled * cyclesNum) / cyclesDen;
+
+    if (scaled == 0) return 1;
+    if (scaled > 65535UL) return 65535;
+    return static_cast<uint16_t>(scaled);
+}
+
+/**
+ * @brief Rescale the white reference to the current gain and integration time
+ *
+ * Constant-time update of max_* from the stored reference, so the
+ * normalization hot path keeps dividing by a single precomputed value.
+ */
+void ADPS9960_ColorSensor::updateActiveCalibration() {
+    const uint16_t *gainNum = gainRatios[currentGain];
+    const uint16_t *gainDen = gainRatios[calibration.gain < GAIN_COUNT ? calibration.gain : 0];
+    const uint16_t cyclesNum = 256 - currentATime;
+    const uint16_t cyclesDen = 256 - calibration.atime;
+
+    max_ambient = scaleReference(calibration.maxAmbient, gainNum[0], gainDen[0], cyclesNum, cyclesDen);
+    max_red = scaleReference(calibration.maxRed, gainNum[1], gainDen[1], cyclesNum, cyclesDen);
+    max_green = scaleReference(calibration.maxGreen, gainNum[2], gainDen[2], cyclesNum, cyclesDen);
+    max_blue = scaleReference(calibration.maxBlue, gainNum[3], gainDen[3], cyclesNum, cyclesDen);
+    resetWhiteBalanceTracking();
+}
+
+/**
+ * @brief Get the count at or above which a channel is treated as clipped
+ * @return Saturation level at the current ATIME
+ */
+uint16_t ADPS9960_ColorSensor::getSaturationLevel() const {
+    return getSaturationLevel(currentATime);
+}
+
+/**
+ * @brief Get the count at or above which a channel is treated as clipped at an ATIME
+ *
+ * Each integration cycle adds up to COUNTS_PER_CYCLE, so short integration
+ * times clip well below SATURATION_THRESHOLD. A quarter cycle of margin
+ * catches readings that are clipped but a few counts short of full scale.
+ *
+ * @param atime ATIME register value
+ * @return Saturation level in counts
+ */
+uint16_t ADPS9960_ColorSensor::getSaturationLevel(uint8_t atime) {
+    uint32_t level = (256UL - atime) * COUNTS_PER_CYCLE;
+    if (level > 65535UL) level = 65535UL;
+    level -= COUNTS_PER_CYCLE / 4;
+    return level < SATURATION_THRESHOLD ? static_cast<uint16_t>(level) : SATURATION_THRESHOLD;
+}
+
+/**
+ * @brief Send an address-only special function command
+ * @param command Command register address (e.g. REG_CICLEAR)
+ * @return true if the sensor acknowledged the command
+ */
+bool ADPS9960_ColorSensor::writeCommand(uint8_t command) {
+    Wire.beginTransmission(I2C_ADDRESS);
+    Wire.write(command);
+    busByteCount += 2;
+    return recordBusResult(Wire.endTransmission());
+}
+
+/**
+ * @brief Write one sensor register
+ * @param reg Register address
+ * @param value Value to write
+ * @return true if the sensor acknowledged the write
+ */
+bool ADPS9960_ColorSensor::writeRegister(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    busByteCount += 3;
+    if (!recordBusResult(Wire.endTransmission())) {
+        return false;
+    }
+    if (reg == REG_ENABLE) {
+        trackEnable(value);
+    }
+    return true;
+}
+
+/**
+ * @brief Read one sensor register
+ * @param reg Register address
+ * @param value Reference receiving the register content
+ * @return true if the read succeeded
+ */
+bool ADPS9960_ColorSensor::readRegister(uint8_t reg, uint8_t &value) {
+    Wire.beginTransmission(I2C_ADDRESS);
+    Wire.write(reg);
+    busByteCount += 2;
+    if (!recordBusResult(Wire.endTransmission())) {
+        return false;
+    }
+
+    busByteCount += 2;
+    if (Wire.requestFrom(I2C_ADDRESS, static_cast<uint8_t>(1)) != 1) {
+        lastBusError = BUS_SHORT_READ;
+        return false;
+    }
+
+    value = static_cast<uint8_t>(Wire.read());
+    if (reg == REG_ENABLE) {
+        trackEnable(value); // Corrects the shadow after a reset the library did not see
+    }
+    return true;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file APDS9960_Flicker.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Mains flicker rejection for the APDS9960_ColorSensor class
+ *
+ * Lamps on 50/60 Hz mains flicker at twice the mains frequency. An
+ * integration that does not cover a whole number of flicker periods
+ * collects a different share of the bright phase every time, so
+ * consecutive readings ripple by several percent. Three tools fight this:
+ *
+ * - Synchronization: with one integration cycle of 2.78 ms, 18 cycles
+ *   (50.04 ms) span 5 flicker periods at 50 Hz and 6 at 60 Hz, and
+ *   3 cycles (8.34 ms) span one at 60 Hz. ATIME is rounded to a multiple.
+ * - Detection: the ripple is measured at 9 cycles (25.02 ms = 3 periods at
+ *   60 Hz, 2.5 at 50 Hz) and at 11 cycles (30.58 ms, close to 3 periods at
+ *   50 Hz, 3.67 at 60 Hz); the mains frequency is the one whose probe is
+ *   quiet.
+ * - Phase averaging: integrations are restarted at evenly spread phases of
+ *   the flicker period and averaged, which cancels what synchronization
+ *   leaves (oscillator tolerance, unknown mains).
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/// Probe integration that rejects 60 Hz flicker but not 50 Hz
+static const uint8_t PROBE_CYCLES_60HZ = 9;
+
+/// Probe integration that (nearly) rejects 50 Hz flicker but not 60 Hz
+static const uint8_t PROBE_CYCLES_50HZ = 11;
+
+/// Repeat period covering both flicker frequencies (5 and 6 periods)
+static const uint32_t COMMON_FLICKER_PERIOD_US = 50000UL;
+
+/// Ripple below this (peak-to-peak / mean) is treated as no flicker
+static const float FLICKER_MIN_RIPPLE = 0.01f;
+
+/// A probe must be this many times quieter than the other to decide
+static const float FLICKER_DECISION_RATIO = 2.0f;
+
+/**
+ * @brief Wait until a point in time relative to a start timestamp
+ * @param startUs micros() at the start of the schedule
+ * @param targetUs Offset from startUs to wait for
+ */
+static void waitUntil(unsigned long startUs, uint32_t targetUs) {
+    const uint32_t elapsed = micros() - startUs;
+    if (targetUs <= elapsed) {
+        return;
+    }
+    const uint32_t remaining = targetUs - elapsed;
+    delay(remaining / 1000UL);
+    delayMicroseconds(static_cast<unsigned int>(remaining % 1000UL));
+}
+
+/**
+ * @brief Raise a phase count until the phases are distinct at both flicker frequencies
+ *
+ * Phases spread over 50 ms fall on 5 flicker periods at 50 Hz and 6 at
+ * 60 Hz. A count sharing a factor with 30 repeats phases (12 phases are
+ * only 2 distinct ones at 60 Hz, which can miss the ripple entirely).
+ *
+ * @param samples Requested count
+ * @return Smallest count >= samples that is coprime with 30 (at most 251)
+ */
+static uint8_t distinctPhaseCount(uint8_t samples) {
+    while ((samples % 2 == 0 || samples % 3 == 0 || samples % 5 == 0) && samples < 251) {
+        samples++;
+    }
+    return samples;
+}
+
+/**
+ * @brief Synchronize the integration time to the mains flicker
+ *
+ * Rounds the current number of integration cycles to the nearest multiple
+ * of the flicker-free step (18 cycles for 50 Hz or unknown mains, 3 cycles
+ * for 60 Hz), keeping at least one step and at most 256 cycles. The
+ * default ATIME 219 (37 cycles) becomes 220 (36 cycles, 100 ms).
+ *
+ * @param mains Mains frequency (MAINS_ANY rejects both 50 and 60 Hz)
+ * @return true on success, false on bus error
+ *
+ * @note The white reference is rescaled to the new integration time
+ */
+bool ADPS9960_ColorSensor::enableFlickerRejection(MainsFrequency mains) {
+    mainsFrequency = mains;
+    if (mains == MAINS_NONE) {
+        return true; // Nothing to synchronize to
+    }
+
+    const uint16_t step = mains == MAINS_60HZ ? FLICKER_CYCLES_60HZ : FLICKER_CYCLES_50HZ;
+    const uint16_t cycles = 256 - currentATime;
+
+    uint16_t synced = ((cycles + step / 2) / step) * step;
+    if (synced < step) synced = step;
+    while (synced > 256) synced -= step;
+
+    return setIntegrationTime(static_cast<uint8_t>(256 - synced));
+}
+
+/**
+ * @brief Get the mains frequency used for flicker rejection
+ * @return MainsFrequency set by enableFlickerRejection()
+ */
+ADPS9960_ColorSensor::MainsFrequency ADPS9960_ColorSensor::getMainsFrequency() const {
+    return mainsFrequency;
+}
+
+/**
+ * @brief Detect the mains frequency from the flicker of the light on the target
+ *
+ * Algorithm:
+ * 1. Measure the ripple with a 9-cycle probe (quiet under 60 Hz flicker)
+ * 2. Measure the ripple with an 11-cycle probe (quiet under 50 Hz flicker)
+ * 3. Restore the integration time
+ * 4. Both quiet: no flicker. One probe FLICKER_DECISION_RATIO times
+ *    quieter than the other: that mains frequency. Otherwise undecided.
+ *
+ * @param samples Readings per probe (minimum 4)
+ * @return Detected MainsFrequency, MAINS_ANY if undecided or on error
+ *
+ * @note Keep target and light steady during the measurement
+ * @note Does not change the mode; pass the result to enableFlickerRejection()
+ */
+ADPS9960_ColorSensor::MainsFrequency ADPS9960_ColorSensor::detectMainsFrequency(uint8_t samples) {
+    if (samples < 4) {
+        samples = 4;
+    }
+
+    const uint8_t originalATime = currentATime;
+    float ripple60 = 0.0f;
+    float ripple50 = 0.0f;
+
+    // Steps 1-2: ripple at both probe integration times
+    const bool measured = setIntegrationTime(256 - PROBE_CYCLES_60HZ) &&
+                          measureFlickerRipple(ripple60, samples) &&
+                          setIntegrationTime(256 - PROBE_CYCLES_50HZ) &&
+                          measureFlickerRipple(ripple50, samples);
+
+    // Step 3: restore the user's integration time
+    setIntegrationTime(originalATime);
+
+    // Step 4: decide
+    if (!measured) {
+        return MAINS_ANY;
+    }
+    if (ripple60 < FLICKER_MIN_RIPPLE && ripple50 < FLICKER_MIN_RIPPLE) {
+        return MAINS_NONE;
+    }
+    if (ripple60 * FLICKER_DECISION_RATIO < ripple50) {
+        return MAINS_60HZ;
+    }
+    if (ripple50 * FLICKER_DECISION_RATIO < ripple60) {
+        return MAINS_50HZ;
+    }
+    return MAINS_ANY;
+}
+
+/**
+ * @brief Measure the flicker ripple left at the current integration time
+ *
+ * Restarts integrations at phases spread evenly over 50 ms (whole flicker
+ * periods at both 50 and 60 Hz) and reports the clear channel's
+ * peak-to-peak variation relative to its mean. With flicker rejection
+ * enabled this is the residual ripple; sensor noise sets the floor.
+ *
+ * @param ripple Reference receiving peak-to-peak / mean
+ * @param samples Number of phases (minimum 2, raised to a count coprime with 30)
+ * @return true if measured, false on read error or zero mean
+ */
+bool ADPS9960_ColorSensor::measureFlickerRipple(float &ripple, uint8_t samples) {
+    samples = distinctPhaseCount(samples < 2 ? 2 : samples);
+
+    RawColor average{};
+    uint16_t clearMin, clearMax;
+    if (!samplePhases(samples, COMMON_FLICKER_PERIOD_US, average, clearMin, clearMax) ||
+        average.ambient == 0) {
+        return false;
+    }
+
+    ripple = static_cast<float>(clearMax - clearMin) / static_cast<float>(average.ambient);
+    return true;
+}
+
+/**
+ * @brief Average every reading over integrations started at spread mains phases
+ *
+ * Uses the flicker period of the mains set by enableFlickerRejection();
+ * with MAINS_ANY or MAINS_NONE the phases are spread over 50 ms.
+ *
+ * @param phases Integrations per reading (0 or 1 disables)
+ */
+void ADPS9960_ColorSensor::setFlickerAveraging(uint8_t phases) {
+    flickerPhases = phases;
+}
+
+/**
+ * @brief Restart the ALS integration so the next one starts now
+ *
+ * Clearing and setting AEN aborts the running integration, which gives
+ * control over the phase of the next one relative to the mains.
+ *
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::restartIntegration() {
+    return holdIntegration() && startIntegration();
+}
+
+/**
+ * @brief Stop the ALS so that startIntegration() can start it with one write
+ *
+ * Clears AEN and keeps the rest of ENABLE, so the start is a single
+ * register write with a known value.
+ *
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::holdIntegration() {
+    uint8_t enable;
+    if (!readRegister(REG_ENABLE, enable) || !writeRegister(REG_ENABLE, enable & ~ENABLE_AEN)) {
+        return false;
+    }
+    heldEnable = enable | ENABLE_PON | ENABLE_AEN;
+    return true;
+}
+
+/**
+ * @brief Start an integration now
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::startIntegration() {
+    if (heldEnable == 0 && !holdIntegration()) {
+        return false;
+    }
+    const bool started = writeRegister(REG_ENABLE, heldEnable);
+    heldEnable = 0;
+    return started;
+}
+
+/**
+ * @brief Average integrations started at evenly spread phases of a period
+ *
+ * Integration i starts at i * slot + i * periodUs / phases, where slot is
+ * the sample period (wait state, if enabled, plus integration, plus one
+ * cycle of start-up) rounded up to whole periods, so the start phases are
+ * 0, 1/phases, 2/phases... of the period. The wait state runs before the
+ * integration but lasts the same every time, so it shifts all phases
+ * alike. Each result is read once AVALID reports it complete.
+ *
+ * @param phases Number of integrations (at least 1)
+ * @param periodUs Period whose phases are covered
+ * @param average Reference receiving the channel averages
+ * @param clearMin Reference receiving the smallest clear reading
+ * @param clearMax Reference receiving the largest clear reading
+ * @return true if all integrations were read, false on bus error
+ */
+bool ADPS9960_ColorSensor::samplePhases(uint8_t phases, uint32_t periodUs, RawColor &average,
+                                        uint16_t &clearMin, uint16_t &clearMax) {
+    if (phases == 0) {
+        phases = 1;
+    }
+
+    const uint32_t cycleUs = getSamplePeriodUs() + INTEGRATION_CYCLE_US;
+    const uint32_t slotUs = ((cycleUs + periodUs - 1) / periodUs) * periodUs;
+    uint32_t sum[4] = {0, 0, 0, 0};
+    clearMin = 65535;
+    clearMax = 0;
+
+    const unsigned long startUs = micros();
+    for (uint8_t i = 0; i < phases; i++) {
+        const uint32_t startOffset = i * slotUs + (i * periodUs) / phases;
+        waitUntil(startUs, startOffset);
+        RawColor raw{};
+        if (!restartIntegration() || !waitForValidData() || !readSensorChannels(raw)) {
+            return false;
+        }
+        sum[0] += raw.ambient;
+        sum[1] += raw.red;
+        sum[2] += raw.green;
+        sum[3] += raw.blue;
+        if (raw.ambient < clearMin) clearMin = raw.ambient;
+        if (raw.ambient > clearMax) clearMax = raw.ambient;
+    }
+
+    average.ambient = static_cast<uint16_t>(sum[0] / phases);
+    average.red = static_cast<uint16_t>(sum[1] / phases);
+    average.green = static_cast<uint16_t>(sum[2] / phases);
+    average.blue = static_cast<uint16_t>(sum[3] / phases);
+    return true;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file APDS9960_HDR.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Multi-exposure HDR acquisition for the APDS9960_ColorSensor class
+ *
+ * A single gain/integration time cannot cover glossy parts (which
+ * saturate) and matte black parts (which sit in the noise floor) at once.
+ * readHDR() takes back-to-back integrations at several exposures and
+ * merges them per channel:
+ *
+ * - Each exposure has a sensitivity factor gainRatio * cycles.
+ * - Per channel, the most sensitive unsaturated exposure is chosen: it has
+ *   the most counts, hence the best SNR.
+ * - Its value is scaled to counts of the current exposure, the unit of the
+ *   calibration white reference, with 8 fractional bits.
+ *
+ * The dynamic range grows by the ratio of the most to the least sensitive
+ * exposure (e.g. 64x/1x gain = 36 dB); the sample rate drops to one per
+ * sum of the integration times.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @brief Sensitivity of an exposure relative to 1x gain and one cycle
+ * @param gainRatio Gain factor (Q8.8)
+ * @param atime ATIME register value
+ * @return gainRatio * (256 - atime), below 2^24
+ */
+static uint32_t exposureFactor(uint16_t gainRatio, uint8_t atime) {
+    return static_cast<uint32_t>(gainRatio) * (256UL - atime);
+}
+
+/**
+ * @brief Get one channel of a sample by index
+ * @param raw Sample
+ * @param channel 0 = clear, 1 = red, 2 = green, 3 = blue
+ * @return Channel value
+ */
+static uint16_t channelValue(const ADPS9960_ColorSensor::RawColor &raw, uint8_t channel) {
+    switch (channel) {
+        case 0:
+            return raw.ambient;
+        case 1:
+            return raw.red;
+        case 2:
+            return raw.green;
+        default:
+            return raw.blue;
+    }
+}
+
+/**
+ * @brief Set the exposures merged by readHDR()
+ *
+ * Typical pair: the current exposure plus one 16x more sensitive (dark
+ * targets) or less sensitive (specular targets).
+ *
+ * @param exposures Array of 2 to MAX_HDR_EXPOSURES settings (copied)
+ * @param count Number of settings
+ * @return true if accepted, false on null pointer, bad count or bad gain
+ */
+bool ADPS9960_ColorSensor::setHDRExposures(const ExposureSetting *exposures, uint8_t count) {
+    if (exposures == nullptr || count < 2 || count > MAX_HDR_EXPOSURES) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (exposures[i].gain >= GAIN_COUNT) {
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        hdrExposures[i] = exposures[i];
+    }
+    hdrExposureCount = count;
+    return true;
+}
+
+/**
+ * @brief Get the dynamic range gained by the HDR exposures
+ * @return Ratio of the most to the least sensitive exposure (1.0 if none set)
+ */
+float ADPS9960_ColorSensor::getHDRDynamicRangeGain() const {
+    if (hdrExposureCount == 0) {
+        return 1.0f;
+    }
+
+    uint32_t lowest = 0xFFFFFFFFUL;
+    uint32_t highest = 0;
+    for (uint8_t i = 0; i < hdrExposureCount; i++) {
+        const uint32_t factor = exposureFactor(gainRatios[hdrExposures[i].gain][0], hdrExposures[i].atime);
+        if (factor < lowest) lowest = factor;
+        if (factor > highest) highest = factor;
+    }
+    return lowest > 0 ? static_cast<float>(highest) / static_cast<float>(lowest) : 1.0f;
+}
+
+/**
+ * @brief Acquire one extended-range sample from back-to-back exposures
+ *
+ * Algorithm:
+ * 1. For each exposure: program gain and ATIME, restart the integration,
+ *    wait for it and read the four channels
+ * 2. Restore the current exposure; on failure, fail and leave the restore
+ *    pending so that no later read returns counts at an HDR exposure
+ * 3. Per channel: pick the most sensitive unsaturated exposure (the least
+ *    sensitive one if all clip, flagging the channel as saturated)
+ * 4. Scale it to counts of the current exposure (Q24.8, 64-bit product)
+ *
+ * @param hdr Reference receiving the merged sample
+ * @return true on success, false if no exposures are set, on bus error or
+ *         if the current exposure could not be restored
+ *
+ * @note The next normal reading waits for the first integration at the
+ *       restored exposure
+ */
+bool ADPS9960_ColorSensor::readHDR(HDRColor &hdr) {
+    if (hdrExposureCount == 0) {
+        return false;
+    }
+
+    RawColor samples[MAX_HDR_EXPOSURES];
+    const unsigned long startUs = micros();
+    bool success = true;
+
+    // Step 1: one fresh integration per exposure
+    for (uint8_t i = 0; i < hdrExposureCount && success; i++) {
+        const ExposureSetting &exposure = hdrExposures[i];
+        success = sensor.setAmbientLightGain(exposure.gain) &&
+                  writeRegister(REG_ATIME, exposure.atime) &&
+                  restartIntegration();
+        if (success) {
+            success = waitForValidData() && readSensorChannels(samples[i]);
+        }
+    }
+
+    // Step 2: back to the user's exposure
+    if (!restoreExposure() || !success) {
+        return false;
+    }
+
+    // Steps 3-4: per-channel merge
+    uint32_t *outputs[4] = {&hdr.ambient, &hdr.red, &hdr.green, &hdr.blue};
+    hdr.exposureUsed = 0;
+    hdr.saturatedMask = 0;
+
+    for (uint8_t c = 0; c < 4; c++) {
+        const uint32_t baseFactor = exposureFactor(gainRatios[currentGain][c], currentATime);
+        int8_t best = -1;
+        int8_t leastSensitive = 0;
+        uint32_t bestFactor = 0;
+        uint32_t lowestFactor = 0xFFFFFFFFUL;
+
+        for (uint8_t i = 0; i < hdrExposureCount; i++) {
+            const ExposureSetting &exposure = hdrExposures[i];
+            const uint32_t factor = exposureFactor(gainRatios[exposure.gain][c], exposure.atime);
+            if (factor < lowestFactor) {
+                lowestFactor = factor;
+                leastSensitive = static_cast<int8_t>(i);
+            }
+            const bool clipped = channelValue(samples[i], c) >= getSaturationLevel(exposure.atime);
+            if (!clipped && factor > bestFactor) {
+                bestFactor = factor;
+                best = static_cast<int8_t>(i);
+            }
+        }
+
+        if (best < 0) {
+            best = leastSensitive;
+            bestFactor = lowestFactor;
+            hdr.saturatedMask |= static_cast<uint8_t>(1 << c);
+        }
+        hdr.exposureUsed |= static_cast<uint8_t>(best << (2 * c));
+
+        const uint16_t value = channelValue(samples[best], c);
+        const uint64_t scaled = bestFactor > 0
+                                ? ((static_cast<uint64_t>(value) << 8) * baseFactor) / bestFactor
+                                : 0;
+        *outputs[c] = scaled > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : static_cast<uint32_t>(scaled);
+    }
+
+    hdr.acquisitionUs = micros() - startUs;
+    return true;
+}
+
+/**
+ * @brief Program the shadow gain and ATIME again after a temporary exposure
+ *
+ * Until this succeeds the sensor may integrate at an HDR exposure while
+ * currentGain, currentATime and the white reference describe the user's
+ * one, so the restore stays pending and settleExposure() retries it
+ * before every read. With bus recovery enabled a failed restore recovers
+ * the bus, which re-initializes the sensor from the same shadow.
+ *
+ * The data registers still hold the last temporary exposure until the
+ * restarted integration completes, so the next read waits for it.
+ *
+ * @return true if the sensor holds the current exposure again
+ */
+bool ADPS9960_ColorSensor::restoreExposure() {
+    exposureRestorePending = !(sensor.setAmbientLightGain(currentGain) &&
+                               writeRegister(REG_ATIME, currentATime) &&
+                               restartIntegration());
+    if (exposureRestorePending && busRecoveryEnabled && !busRecoveryActive) {
+        exposureRestorePending = !(recoverBus() && restartIntegration());
+    }
+    exposureSettling = !exposureRestorePending;
+    return !exposureRestorePending;
+}
+
+/**
+ * @brief Make sure the next data read comes from the current exposure
+ *
+ * Retries a pending restore, then waits once for the first integration
+ * at the restored exposure (AVALID).
+ *
+ * @return true if the data registers hold counts at the current exposure
+ */
+bool ADPS9960_ColorSensor::settleExposure() {
+    if (exposureRestorePending && !restoreExposure()) {
+        return false; // Counts would be at an HDR exposure, not the calibrated one
+    }
+    if (exposureSettling) {
+        if (!waitForValidData()) {
+            return false;
+        }
+        exposureSettling = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Normalize an HDR sample against the calibration white reference
+ * @param hdr Sample from readHDR()
+ * @param rgb Reference receiving 0-65535 values (highlights clamp at white)
+ */
+void ADPS9960_ColorSensor::normalizeHDR(const HDRColor &hdr, RGB16 &rgb) const {
+    rgb.r = normalizeQ8ToRGB16(hdr.red, max_red);
+    rgb.g = normalizeQ8ToRGB16(hdr.green, max_green);
+    rgb.b = normalizeQ8ToRGB16(hdr.blue, max_blue);
+}
@@ -0,0 +1,410 @@
+/**
+ * @file APDS9960_HealthMonitor.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the SensorHealthMonitor class
+ *
+ * Every check keeps a constant amount of state per channel:
+ *
+ * - Stuck: a counter of consecutive identical fresh values. Real integrations
+ *   always carry a few counts of noise, so a long run of the same non-zero,
+ *   unclipped value means the data path froze. Fresh data that stops
+ *   arriving for STALE_INTEGRATIONS sample periods (integration plus wait)
+ *   counts as stuck on all channels.
+ * - Dropout: a counter of consecutive zeros on a channel while another
+ *   channel sees DROPOUT_MIN_SIGNAL counts; the photodiodes overlap too much
+ *   for that to happen on a working sensor.
+ * - Noise: an EWMA (1/32) of half the squared difference of consecutive
+ *   samples. For white noise this is the variance, and slow changes of the
+ *   target cancel out. Differences are clamped to twice the noise limit, so
+ *   a step of the target adds at most 1/16 of the limit and decays, while
+ *   noise above the limit still gets through. It is compared with the
+ *   calibration stddev.
+ * - Drift: an EWMA (1/8) of samples taken on the white reference, compared
+ *   with the calibration white reference.
+ */
+
+#include "APDS9960_HealthMonitor.h"
+
+/// EWMA shift of the noise estimate (1/32)
+static const uint8_t NOISE_EWMA_SHIFT = 5;
+
+/// EWMA shift of the reference estimate (1/8)
+static const uint8_t REFERENCE_EWMA_SHIFT = 3;
+
+/// Reference samples needed before drift is reported
+static const uint8_t DRIFT_MIN_SAMPLES = 4;
+
+/// Differences are clamped so the Q8 variance stays below 2^29
+static const int32_t MAX_NOISE_DIFFERENCE = 2047;
+
+/// Difference clamp relative to the noise limit (clamped noise tops out at 2x the limit variance)
+static const float NOISE_CLAMP_LIMITS = 2.0f;
+
+/**
+ * @brief Get one channel of a sample by index
+ * @param sample Sample
+ * @param channel 0 = clear, 1 = red, 2 = green, 3 = blue
+ * @return Channel value
+ */
+static uint16_t channelValue(const ADPS9960_ColorSensor::ColorSample &sample, uint8_t channel) {
+    switch (channel) {
+        case 0:
+            return sample.ambient;
+        case 1:
+            return sample.red;
+        case 2:
+            return sample.green;
+        default:
+            return sample.blue;
+    }
+}
+
+/**
+ * @brief Constructor - unconfigured, default limits, no callback
+ */
+SensorHealthMonitor::SensorHealthMonitor()
+    : configured(false),
+      whiteReference{0, 0, 0, 0},
+      calibrationNoise{0.0f, 0.0f, 0.0f, 0.0f},
+      noiseLimitQ8{0, 0, 0, 0},
+      noiseClamp{MAX_NOISE_DIFFERENCE, MAX_NOISE_DIFFERENCE, MAX_NOISE_DIFFERENCE, MAX_NOISE_DIFFERENCE},
+      calibrationGain(0),
+      calibrationATime(0),
+      samplePeriodUs(0),
+      stuckSamples(DEFAULT_STUCK_SAMPLES),
+      noiseFactor(4.0f),
+      driftLimit(0.05f),
+      callback(nullptr),
+      callbackContext(nullptr) {
+    reset();
+}
+
+/**
+ * @brief Take the expected noise, white reference and sample period from a calibrated sensor
+ *
+ * The calibration report is only filled by calibrate(); after default
+ * values or a restored profile the noise check stays off.
+ *
+ * @param sensor Sensor after calibrate() (or a restored profile)
+ */
+void SensorHealthMonitor::configure(const ADPS9960_ColorSensor &sensor) {
+    const ADPS9960_ColorSensor::CalibrationData &data = sensor.getCalibrationData();
+    const ADPS9960_ColorSensor::CalibrationReport &report = sensor.getCalibrationReport();
+
+    whiteReference[0] = data.maxAmbient;
+    whiteReference[1] = data.maxRed;
+    whiteReference[2] = data.maxGreen;
+    whiteReference[3] = data.maxBlue;
+    calibrationGain = data.gain;
+    calibrationATime = data.atime;
+    samplePeriodUs = sensor.getSamplePeriodUs();
+
+    const bool hasStatistics = report.sampleCount >= 2;
+    calibrationNoise[0] = hasStatistics ? report.ambient.stddev : 0.0f;
+    calibrationNoise[1] = hasStatistics ? report.red.stddev : 0.0f;
+    calibrationNoise[2] = hasStatistics ? report.green.stddev : 0.0f;
+    calibrationNoise[3] = hasStatistics ? report.blue.stddev : 0.0f;
+    updateNoiseLimits();
+
+    configured = true;
+    reset();
+}
+
+/**
+ * @brief Set the anomaly limits
+ * @param stuckCount Identical fresh samples that mean frozen (minimum 2)
+ * @param noiseMultiple Noise above calibration stddev * multiple is abnormal (0 disables)
+ * @param driftRatio Relative white reference drift that is reported (0 disables)
+ */
+void SensorHealthMonitor::setLimits(uint8_t stuckCount, float noiseMultiple, float driftRatio) {
+    stuckSamples = stuckCount < 2 ? 2 : stuckCount;
+    noiseFactor = noiseMultiple > 0.0f ? noiseMultiple : 0.0f;
+    driftLimit = driftRatio > 0.0f ? driftRatio : 0.0f;
+    updateNoiseLimits();
+}
+
+/**
+ * @brief Set the time between two fresh samples
+ * @param periodUs Sample period, e.g. getSamplePeriodUs() after changing WTIME
+ */
+void SensorHealthMonitor::setSamplePeriod(uint32_t periodUs) {
+    samplePeriodUs = periodUs;
+}
+
+/**
+ * @brief Set the function called on state changes
+ * @param function Function to call (nullptr disables)
+ * @param context Pointer handed back to the callback
+ */
+void SensorHealthMonitor::setCallback(HealthCallback function, void *context) {
+    callback = function;
+    callbackContext = context;
+}
+
+/**
+ * @brief Recompute the variance limits and difference clamps from noiseFactor
+ *
+ * The calibration stddev is floored at half a count, the quantization
+ * noise, so a very quiet calibration does not make every sample abnormal.
+ */
+void SensorHealthMonitor::updateNoiseLimits() {
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        if (noiseFactor <= 0.0f || calibrationNoise[c] <= 0.0f) {
+            noiseLimitQ8[c] = 0;
+            noiseClamp[c] = MAX_NOISE_DIFFERENCE;
+            continue;
+        }
+        const float sigma = calibrationNoise[c] < 0.5f ? 0.5f : calibrationNoise[c];
+        const float limit = sigma * noiseFactor;
+        const float limitQ8 = limit * limit * 256.0f;
+        noiseLimitQ8[c] = limitQ8 > 536870911.0f ? 536870911UL : static_cast<uint32_t>(limitQ8);
+
+        const float clamp = NOISE_CLAMP_LIMITS * limit + 1.0f;
+        noiseClamp[c] = clamp > MAX_NOISE_DIFFERENCE ? MAX_NOISE_DIFFERENCE : static_cast<int32_t>(clamp);
+    }
+}
+
+/**
+ * @brief Feed one sample of the normal stream
+ *
+ * Algorithm:
+ * 1. Non-fresh sample: only check how long fresh data has been missing,
+ *    against the sample period (at least the integration time)
+ * 2. Per channel: count identical non-zero unclipped values (stuck)
+ * 3. Per channel: count zeros while another channel sees light (dropout)
+ * 4. Per channel: update the variance from the clamped difference at the
+ *    calibration exposure and compare it with the limit after the warm-up
+ *    (noise)
+ * 5. Evaluate the state and notify on change
+ *
+ * @param sample Sample from readSample()
+ * @return Current state
+ */
+SensorHealthMonitor::HealthState SensorHealthMonitor::update(const ADPS9960_ColorSensor::ColorSample &sample) {
+    // Step 1: the sensor may have stopped integrating
+    if (!(sample.flags & ADPS9960_ColorSensor::SAMPLE_FRESH)) {
+        const uint32_t integrationUs = (256UL - sample.atime) * ADPS9960_ColorSensor::INTEGRATION_CYCLE_US;
+        const uint32_t periodUs = samplePeriodUs > integrationUs ? samplePeriodUs : integrationUs;
+        if (freshCount > 0 && sample.timestampUs - lastFreshUs > STALE_INTEGRATIONS * periodUs) {
+            stuckMask = 0x0F;
+        }
+        return evaluate();
+    }
+
+    const bool sameExposure = sample.gain == calibrationGain && sample.atime == calibrationATime;
+    uint16_t brightest = 0;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const uint16_t value = channelValue(sample, c);
+        if (value > brightest) brightest = value;
+    }
+
+    stuckMask = 0;
+    dropoutMask = 0;
+    noiseMask = 0;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const uint8_t bit = static_cast<uint8_t>(1 << c);
+        const uint16_t value = channelValue(sample, c);
+        const bool clipped = sample.saturatedMask & bit;
+
+        // Step 2: stuck
+        if (freshCount > 0 && value == lastValue[c] && value != 0 && !clipped) {
+            if (repeatCount[c] < 255) repeatCount[c]++;
+        } else {
+            repeatCount[c] = 0;
+        }
+        if (repeatCount[c] + 1 >= stuckSamples) stuckMask |= bit;
+
+        // Step 3: dropout
+        if (value == 0 && brightest >= DROPOUT_MIN_SIGNAL) {
+            if (zeroCount[c] < 255) zeroCount[c]++;
+        } else {
+            zeroCount[c] = 0;
+        }
+        if (zeroCount[c] >= DROPOUT_SAMPLES) dropoutMask |= bit;
+
+        // Step 4: noise
+        if (freshCount > 0 && sameExposure && !clipped) {
+            int32_t difference = static_cast<int32_t>(value) - lastValue[c];
+            if (difference > noiseClamp[c]) difference = noiseClamp[c];
+            if (difference < -noiseClamp[c]) difference = -noiseClamp[c];
+
+            const int32_t halfSquareQ8 = difference * difference * 128; // d^2 / 2 in Q8
+            varianceQ8[c] += (halfSquareQ8 - static_cast<int32_t>(varianceQ8[c])) >> NOISE_EWMA_SHIFT;
+        }
+        if (freshCount >= NOISE_WARMUP_SAMPLES && noiseLimitQ8[c] > 0 && varianceQ8[c] > noiseLimitQ8[c]) {
+            noiseMask |= bit;
+        }
+
+        lastValue[c] = value;
+    }
+
+    lastFreshUs = sample.timestampUs;
+    if (freshCount < 255) freshCount++;
+
+    // Step 5: state
+    return evaluate();
+}
+
+/**
+ * @brief Feed one sample taken on the white reference
+ * @param sample Sample from readSample() at the calibration exposure
+ * @return Current state
+ */
+SensorHealthMonitor::HealthState SensorHealthMonitor::updateReference(
+        const ADPS9960_ColorSensor::ColorSample &sample) {
+    if (!(sample.flags & ADPS9960_ColorSensor::SAMPLE_FRESH) || sample.saturatedMask != 0 ||
+        sample.gain != calibrationGain || sample.atime != calibrationATime) {
+        return state;
+    }
+
+    driftMask = 0;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        const int32_t valueQ8 = static_cast<int32_t>(channelValue(sample, c)) << 8;
+        if (referenceCount == 0) {
+            referenceQ8[c] = valueQ8;
+        } else {
+            referenceQ8[c] += (valueQ8 - referenceQ8[c]) >> REFERENCE_EWMA_SHIFT;
+        }
+    }
+    if (referenceCount < 255) referenceCount++;
+
+    if (referenceCount >= DRIFT_MIN_SAMPLES && driftLimit > 0.0f) {
+        for (uint8_t c = 0; c < CHANNELS; c++) {
+            const float drift = getDrift(c);
+            if (drift > driftLimit || drift < -driftLimit) {
+                driftMask |= static_cast<uint8_t>(1 << c);
+            }
+        }
+    }
+    return evaluate();
+}
+
+/**
+ * @brief Derive the state from the history and notify on change
+ * @return New state
+ */
+SensorHealthMonitor::HealthState SensorHealthMonitor::evaluate() {
+    HealthState newState = HEALTH_OK;
+    uint8_t newMask = 0;
+
+    if (!configured) {
+        newState = HEALTH_UNKNOWN;
+    } else if (stuckMask != 0) {
+        newState = HEALTH_STUCK;
+        newMask = stuckMask;
+    } else if (dropoutMask != 0) {
+        newState = HEALTH_DROPOUT;
+        newMask = dropoutMask;
+    } else if (noiseMask != 0) {
+        newState = HEALTH_NOISY;
+        newMask = noiseMask;
+    } else if (driftMask != 0) {
+        newState = HEALTH_DRIFT;
+        newMask = driftMask;
+    }
+
+    if (newState != state || newMask != channelMask) {
+        state = newState;
+        channelMask = newMask;
+        if (callback != nullptr) {
+            callback(state, channelMask, callbackContext);
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief Get the most severe anomaly
+ * @return Current HealthState
+ */
+SensorHealthMonitor::HealthState SensorHealthMonitor::getState() const {
+    return state;
+}
+
+/**
+ * @brief Get the channels behind the current state
+ * @return Bit mask (bit 0 = C, 1 = R, 2 = G, 3 = B)
+ */
+uint8_t SensorHealthMonitor::getChannelMask() const {
+    return channelMask;
+}
+
+/**
+ * @brief Check if classification results can be trusted
+ * @return true in HEALTH_OK or HEALTH_DRIFT
+ */
+bool SensorHealthMonitor::isHealthy() const {
+    return state == HEALTH_OK || state == HEALTH_DRIFT;
+}
+
+/**
+ * @brief Get the measured noise of a channel
+ * @param channel 0 = C, 1 = R, 2 = G, 3 = B
+ * @return Standard deviation in counts (0 before enough samples)
+ */
+float SensorHealthMonitor::getNoise(uint8_t channel) const {
+    if (channel >= CHANNELS || freshCount < NOISE_WARMUP_SAMPLES) {
+        return 0.0f;
+    }
+    return sqrtf(static_cast<float>(varianceQ8[channel]) / 256.0f);
+}
+
+/**
+ * @brief Get the drift of the white reference for a channel
+ * @param channel 0 = C, 1 = R, 2 = G, 3 = B
+ * @return (reference - calibration) / calibration (0 without reference samples)
+ */
+float SensorHealthMonitor::getDrift(uint8_t channel) const {
+    if (channel >= CHANNELS || referenceCount == 0 || whiteReference[channel] == 0) {
+        return 0.0f;
+    }
+    const float reference = static_cast<float>(referenceQ8[channel]) / 256.0f;
+    return (reference - whiteReference[channel]) / static_cast<float>(whiteReference[channel]);
+}
+
+/**
+ * @brief Get human-readable name of a health state
+ * @param state State to name
+ * @return String representation of the state
+ */
+const char *SensorHealthMonitor::getStateName(HealthState state) {
+    switch (state) {
+        case HEALTH_UNKNOWN:
+            return "HEALTH_UNKNOWN";
+        case HEALTH_OK:
+            return "HEALTH_OK";
+        case HEALTH_DRIFT:
+            return "HEALTH_DRIFT";
+        case HEALTH_NOISY:
+            return "HEALTH_NOISY";
+        case HEALTH_DROPOUT:
+            return "HEALTH_DROPOUT";
+        case HEALTH_STUCK:
+            return "HEALTH_STUCK";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Forget the sample history (keeps configuration and limits)
+ */
+void SensorHealthMonitor::reset() {
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        lastValue[c] = 0;
+        repeatCount[c] = 0;
+        zeroCount[c] = 0;
+        varianceQ8[c] = 0;
+        referenceQ8[c] = 0;
+    }
+    lastFreshUs = 0;
+    freshCount = 0;
+    referenceCount = 0;
+    stuckMask = 0;
+    dropoutMask = 0;
+    noiseMask = 0;
+    driftMask = 0;
+    state = configured ? HEALTH_OK : HEALTH_UNKNOWN;
+    channelMask = 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file APDS9960_Illumination.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Differential capture with an external illumination LED
+ *
+ * A reading under ambient light is the sum of what the target reflects of
+ * the ambient and what it reflects of the LED. Only the second part is a
+ * property of the target under a known light. Differential capture takes
+ * one integration with the LED on and one with it off, back to back, and
+ * subtracts them:
+ *
+ *   reflectance = lit - ambient
+ *
+ * Each integration is restarted after the LED switched, so none of them
+ * mixes the two states, and each is read once AVALID reports it complete,
+ * so the second one ends one sample period (wait state, if enabled, plus
+ * integration, plus bus time) after the first. Ambient light that changes
+ * linearly between the two leaves an error of one period of change; the
+ * order of the pair alternates, so over consecutive readings that error
+ * alternates in sign instead of biasing the result.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @brief Subtract the ambient integration from the lit one
+ * @param lit Channel reading with the LED on
+ * @param ambient Channel reading with the LED off
+ * @return lit - ambient, 0 if the ambient rose above the lit reading
+ */
+static uint16_t subtractAmbient(uint16_t lit, uint16_t ambient) {
+    return lit > ambient ? lit - ambient : 0;
+}
+
+/**
+ * @brief Set the function that switches the illumination LED
+ * @param callback Function called with true/false to switch the LED (nullptr disables)
+ * @param context Pointer handed back to the callback
+ * @param settleUs Delay after switching before the integration starts
+ */
+void ADPS9960_ColorSensor::setIllumination(IlluminationCallback callback, void *context, uint16_t settleUs) {
+    illuminationCallback = callback;
+    illuminationContext = context;
+    illuminationSettleUs = settleUs;
+}
+
+/**
+ * @brief Cancel ambient light with paired LED-on/LED-off integrations
+ * @param enabled true: every reading is lit minus ambient
+ */
+void ADPS9960_ColorSensor::setDifferentialCapture(bool enabled) {
+    differentialCapture = enabled;
+    differentialLitFirst = true;
+}
+
+/**
+ * @brief Check if readings are differential
+ * @return true if differential capture is enabled and an LED callback is set
+ */
+bool ADPS9960_ColorSensor::isDifferentialCapture() const {
+    return differentialCapture && illuminationCallback != nullptr;
+}
+
+/**
+ * @brief Calibrate the white reference from the LED reflection of a white target
+ *
+ * calibrate() measures the white target under ambient plus LED, which is
+ * not what differential readings are normalized against. Here the
+ * reference is the average difference of several pairs, so it holds the
+ * LED reflection only.
+ *
+ * @param pairs LED-on/LED-off pairs to average (minimum 1)
+ * @return true on success, false without LED callback, on read error or if
+ *         the LED adds less than MIN_THRESHOLD counts
+ */
+bool ADPS9960_ColorSensor::calibrateDifferential(uint8_t pairs) {
+    if (illuminationCallback == nullptr) {
+        return false;
+    }
+    if (pairs == 0) {
+        pairs = 1;
+    }
+
+    uint32_t sum[4] = {0, 0, 0, 0};
+    for (uint8_t i = 0; i < pairs; i++) {
+        RawColor reflectance{};
+        if (!readDifferential(reflectance)) {
+            return false;
+        }
+        sum[0] += reflectance.ambient;
+        sum[1] += reflectance.red;
+        sum[2] += reflectance.green;
+        sum[3] += reflectance.blue;
+    }
+
+    if (sum[0] / pairs < MIN_THRESHOLD) {
+        return false; // LED too weak or target too far for a usable reference
+    }
+
+    max_ambient = static_cast<uint16_t>(sum[0] / pairs);
+    max_red = static_cast<uint16_t>(sum[1] / pairs);
+    max_green = static_cast<uint16_t>(sum[2] / pairs);
+    max_blue = static_cast<uint16_t>(sum[3] / pairs);
+    storeCalibrationReference();
+    activeProfile = -1;
+    calibrationStatus = CALIBRATED_OK;
+    return true;
+}
+
+/**
+ * @brief Get the two integrations behind the last differential reading
+ * @return Reference to the report
+ */
+const ADPS9960_ColorSensor::DifferentialReport &ADPS9960_ColorSensor::getDifferentialReport() const {
+    return differentialReport;
+}
+
+/**
+ * @brief Take one LED-on and one LED-off integration and subtract them
+ *
+ * Algorithm:
+ * 1. Capture the pair in the order of differentialLitFirst, then flip it
+ * 2. Switch the LED off (also on error) and charge its on time
+ * 3. Subtract per channel, clamping at zero
+ * 4. Report the raw pair, the completion skew, clipping of the lit integration
+ *    and the share of ambient in the lit clear channel
+ *
+ * @param reflectance Reference receiving lit minus ambient
+ * @return true on success, false on bus error
+ */
+bool ADPS9960_ColorSensor::readDifferential(RawColor &reflectance) {
+    DifferentialReport &report = differentialReport;
+    const bool litFirst = differentialLitFirst;
+    differentialLitFirst = !differentialLitFirst;
+
+    // Step 1: the pair
+    unsigned long litDoneUs = 0, ambientDoneUs = 0, ledOnUs = 0;
+    bool success;
+    if (litFirst) {
+        ledOnUs = micros();
+        success = captureIlluminated(true, report.lit, litDoneUs) &&
+                  captureIlluminated(false, report.ambient, ambientDoneUs);
+    } else {
+        success = captureIlluminated(false, report.ambient, ambientDoneUs);
+        ledOnUs = micros();
+        success = success && captureIlluminated(true, report.lit, litDoneUs);
+    }
+
+    // Step 2: LED off
+    illuminationCallback(false, illuminationContext);
+    report.ledOnUs = micros() - ledOnUs;
+    energyLedOnUs += report.ledOnUs;
+    if (!success) {
+        return false;
+    }
+
+    // Step 3: ambient-free reflectance
+    reflectance.ambient = subtractAmbient(report.lit.ambient, report.ambient.ambient);
+    reflectance.red = subtractAmbient(report.lit.red, report.ambient.red);
+    reflectance.green = subtractAmbient(report.lit.green, report.ambient.green);
+    reflectance.blue = subtractAmbient(report.lit.blue, report.ambient.blue);
+
+    // Step 4: report
+    report.skewUs = litFirst ? ambientDoneUs - litDoneUs : litDoneUs - ambientDoneUs;
+    const uint16_t saturation = getSaturationLevel(currentATime);
+    report.litSaturatedMask = static_cast<uint8_t>((report.lit.ambient >= saturation ? 0x01 : 0) |
+                                                   (report.lit.red >= saturation ? 0x02 : 0) |
+                                                   (report.lit.green >= saturation ? 0x04 : 0) |
+                                                   (report.lit.blue >= saturation ? 0x08 : 0));
+    const uint32_t share = report.lit.ambient > 0
+        ? (static_cast<uint32_t>(report.ambient.ambient) * 255UL) / report.lit.ambient
+        : 255UL;
+    report.ambientShare = static_cast<uint8_t>(share > 255UL ? 255UL : share);
+    return true;
+}
+
+/**
+ * @brief Switch the LED and read one integration started after the switch
+ *
+ * The running integration started under the other LED state, so it is
+ * restarted once the LED has settled; the reading is taken as soon as
+ * AVALID reports the restarted integration complete, which also covers a
+ * wait state running before it.
+ *
+ * @param ledOn LED state during the integration
+ * @param raw Reference receiving the channels
+ * @param doneUs Reference receiving micros() when the integration was seen complete
+ * @return true on success, false on bus error or timeout
+ */
+bool ADPS9960_ColorSensor::captureIlluminated(bool ledOn, RawColor &raw, unsigned long &doneUs) {
+    illuminationCallback(ledOn, illuminationContext);
+    if (illuminationSettleUs > 0) {
+        delayMicroseconds(illuminationSettleUs);
+    }
+
+    if (!restartIntegration() || !waitForValidData()) {
+        return false;
+    }
+    doneUs = micros();
+    return readSensorChannels(raw);
+}
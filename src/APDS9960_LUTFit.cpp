@@ -0,0 +1,88 @@
+/**
+ * @file APDS9960_LUTFit.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the correction LUT fit
+ *
+ * Each node starts at its own coordinates (identity) and is moved by the
+ * correction (reference - measured) of the patches around it, weighted by
+ * inverse distance: w = 1 / (d^2 + h^2)^2, with h half a grid step. Close
+ * patches dominate, so local errors are followed, while nodes far from
+ * any patch get a smooth blend instead of a guess. Depends on <math.h>
+ * only, so it builds unchanged on a host.
+ */
+
+#include "APDS9960_LUTFit.h"
+#include <math.h>
+
+/// Smallest and largest nodes per axis (same limits as setColorCorrectionLUT())
+static const uint8_t LUT_FIT_MIN_GRID = 2;
+static const uint8_t LUT_FIT_MAX_GRID = 33;
+
+/**
+ * @brief Fit a 3D correction LUT from measured/reference patch pairs
+ *
+ * Algorithm:
+ * 1. Validate the inputs
+ * 2. For every node, accumulate the weighted patch corrections
+ * 3. Store node coordinates plus the mean correction, clamped to 0-65535
+ *
+ * @param measured Patches as measured by the unit, count x {r, g, b}
+ * @param reference The true values of the same patches
+ * @param count Number of patches (at least LUT_FIT_MIN_PATCHES)
+ * @param gridSize Nodes per axis (2-33)
+ * @param lut Array of gridSize^3 * 3 receiving the node table (unchanged on failure)
+ * @return true on success, false otherwise
+ *
+ * @note Use patches spread over the gamut: corrections far from every
+ *       patch are extrapolated from the nearest ones
+ * @note O(gridSize^3 x count): a 9x9x9 LUT from 100 patches is 73k
+ *       weight evaluations, fast on a host and seconds on an MCU
+ */
+bool fitCorrectionLUT(const uint16_t *measured, const uint16_t *reference, uint16_t count,
+                      uint8_t gridSize, uint16_t *lut) {
+    // Step 1: validate
+    if (measured == nullptr || reference == nullptr || lut == nullptr ||
+        count < LUT_FIT_MIN_PATCHES || gridSize < LUT_FIT_MIN_GRID || gridSize > LUT_FIT_MAX_GRID) {
+        return false;
+    }
+
+    const float step = 1.0f / static_cast<float>(gridSize - 1);
+    const float h2 = 0.25f * step * step;
+
+    for (uint8_t ri = 0; ri < gridSize; ri++) {
+        for (uint8_t gi = 0; gi < gridSize; gi++) {
+            for (uint8_t bi = 0; bi < gridSize; bi++) {
+                const float node[3] = {ri * step, gi * step, bi * step};
+
+                // Step 2: weighted mean correction of the patches
+                float weightSum = 0.0f;
+                float correction[3] = {0.0f, 0.0f, 0.0f};
+                for (uint16_t n = 0; n < count; n++) {
+                    const uint16_t *m = measured + n * 3;
+                    const uint16_t *r = reference + n * 3;
+                    float d2 = h2;
+                    for (uint8_t c = 0; c < 3; c++) {
+                        const float d = m[c] / 65535.0f - node[c];
+                        d2 += d * d;
+                    }
+                    const float w = 1.0f / (d2 * d2);
+                    weightSum += w;
+                    for (uint8_t c = 0; c < 3; c++) {
+                        correction[c] += w * (static_cast<float>(r[c]) - static_cast<float>(m[c]));
+                    }
+                }
+
+                // Step 3: identity plus correction
+                uint16_t *out = lut + ((static_cast<uint32_t>(ri) * gridSize + gi) * gridSize + bi) * 3;
+                for (uint8_t c = 0; c < 3; c++) {
+                    float value = node[c] * 65535.0f + correction[c] / weightSum;
+                    if (value < 0.0f) value = 0.0f;
+                    if (value > 65535.0f) value = 65535.0f;
+                    out[c] = static_cast<uint16_t>(lroundf(value));
+                }
+            }
+        }
+    }
+    return true;
+}
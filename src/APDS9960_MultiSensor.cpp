@@ -0,0 +1,176 @@
+/**
+ * @file APDS9960_MultiSensor.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the SynchronizedCapture class
+ *
+ * Timeline of one capture with N sensors:
+ *
+ *   hold 0..N-1     stop every ALS (read + write ENABLE, not time critical)
+ *   start 0..N-1    one ENABLE write each: the start skew is N-1 writes
+ *                   plus multiplexer selects, about 0.4 ms per sensor at 100 kHz
+ *   read 0..N-1     in start order, sensor i is read as soon as its AVALID
+ *                   is set, so the reads inherit the spacing of the starts
+ *                   and a wait state (WEN) before the integration is covered
+ *
+ * The cycle is one integration period plus twice the per-sensor bus time,
+ * instead of N integration periods for sequential free-running reads that
+ * wait for fresh data.
+ */
+
+#include "APDS9960_MultiSensor.h"
+
+/**
+ * @brief Constructor - no sensors, no bus select callback
+ */
+SynchronizedCapture::SynchronizedCapture()
+    : sensors{},
+      sensorCount(0),
+      busSelect(nullptr),
+      busSelectContext(nullptr) {
+}
+
+/**
+ * @brief Add a sensor to the capture
+ * @param sensor Sensor object (must outlive the capture)
+ * @return true if added, false if MAX_SENSORS are registered
+ */
+bool SynchronizedCapture::addSensor(ADPS9960_ColorSensor &sensor) {
+    if (sensorCount >= MAX_SENSORS) {
+        return false;
+    }
+    sensors[sensorCount++] = &sensor;
+    return true;
+}
+
+/**
+ * @brief Set the function that routes the bus to a sensor
+ * @param callback Multiplexer select function (nullptr: no multiplexer)
+ * @param context Pointer handed back to the callback
+ */
+void SynchronizedCapture::setBusSelect(BusSelectCallback callback, void *context) {
+    busSelect = callback;
+    busSelectContext = context;
+}
+
+/**
+ * @brief Capture one synchronized multi-view sample
+ *
+ * Algorithm:
+ * 1. Hold the ALS of every sensor
+ * 2. Start them back to back, recording each start time; restart any
+ *    sensor that could not be started, so none is left with its ALS off
+ * 3. In start order, wait for each sensor's AVALID and read the four
+ *    channels
+ * 4. Convert each view to chromaticity with its sensor's calibration and
+ *    average the valid, unclipped views into the fused result
+ *
+ * @param sample Reference receiving the views and the fused result
+ * @return true if every view was read, false if any failed (see validMask)
+ */
+bool SynchronizedCapture::capture(MultiViewSample &sample) {
+    sample.count = sensorCount;
+    sample.validMask = 0;
+    sample.skewUs = 0;
+    sample.fused = ADPS9960_ColorSensor::Chromaticity{};
+    if (sensorCount == 0 || (sensorCount > 1 && busSelect == nullptr)) {
+        return false; // Sensors share address 0x39: more than one needs a multiplexer
+    }
+    const unsigned long captureStartUs = micros();
+
+    // Step 1: prepare every sensor for a one-write start
+    uint8_t heldMask = 0;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        if (select(i) && sensors[i]->holdIntegration()) {
+            heldMask |= static_cast<uint8_t>(1U << i);
+        }
+    }
+
+    // Step 2: start as close together as the bus allows
+    unsigned long startUs[MAX_SENSORS];
+    uint8_t startedMask = 0;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        if ((heldMask & (1U << i)) && select(i) && sensors[i]->startIntegration()) {
+            startUs[i] = micros();
+            startedMask |= static_cast<uint8_t>(1U << i);
+        }
+    }
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        if (!(startedMask & (1U << i)) && select(i)) {
+            sensors[i]->startIntegration(); // Back to free-running; its view stays invalid
+        }
+    }
+    if (startedMask == 0) {
+        sample.cycleUs = micros() - captureStartUs;
+        return false;
+    }
+
+    uint8_t first = 0;
+    while (!(startedMask & (1U << first))) first++;
+    sample.timestampUs = startUs[first];
+
+    // Step 3: read each sensor once its integration is complete
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        SensorView &view = sample.views[i];
+        view = SensorView{};
+        if (!(startedMask & (1U << i))) {
+            continue;
+        }
+        view.startOffsetUs = startUs[i] - startUs[first];
+        if (view.startOffsetUs > sample.skewUs) {
+            sample.skewUs = view.startOffsetUs;
+        }
+
+        if (select(i) && sensors[i]->waitForValidData() &&
+            sensors[i]->readChannels(view.raw, ADPS9960_ColorSensor::CHANNEL_ALL)) {
+            const uint16_t saturation = sensors[i]->getSaturationLevel();
+            view.saturatedMask = static_cast<uint8_t>((view.raw.ambient >= saturation ? 0x01 : 0) |
+                                                      (view.raw.red >= saturation ? 0x02 : 0) |
+                                                      (view.raw.green >= saturation ? 0x04 : 0) |
+                                                      (view.raw.blue >= saturation ? 0x08 : 0));
+            sensors[i]->toChromaticity(view.raw, view.chroma);
+            sample.validMask |= static_cast<uint8_t>(1U << i);
+        }
+    }
+
+    // Step 4: fuse the usable views
+    uint32_t sum[4] = {0, 0, 0, 0};
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        const SensorView &view = sample.views[i];
+        if (!(sample.validMask & (1U << i)) || view.saturatedMask != 0) {
+            continue;
+        }
+        sum[0] += view.chroma.r;
+        sum[1] += view.chroma.g;
+        sum[2] += view.chroma.b;
+        sum[3] += view.chroma.intensity;
+        used++;
+    }
+    if (used > 0) {
+        sample.fused.r = static_cast<uint16_t>(sum[0] / used);
+        sample.fused.g = static_cast<uint16_t>(sum[1] / used);
+        sample.fused.b = static_cast<uint16_t>(sum[2] / used);
+        sample.fused.intensity = static_cast<uint16_t>(sum[3] / used);
+    }
+
+    sample.cycleUs = micros() - captureStartUs;
+    return sample.validMask == static_cast<uint8_t>((1U << sensorCount) - 1);
+}
+
+/**
+ * @brief Get the number of registered sensors
+ * @return Sensor count
+ */
+uint8_t SynchronizedCapture::getSensorCount() const {
+    return sensorCount;
+}
+
+/**
+ * @brief Route the bus to a sensor
+ * @param index Sensor index
+ * @return true on success (always without callback)
+ */
+bool SynchronizedCapture::select(uint8_t index) {
+    return busSelect == nullptr || busSelect(index, busSelectContext);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file APDS9960_OKLab.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief OKLab/OKLCh conversion and perceptual color classification
+ *
+ * OKLab (Björn Ottosson, 2020) is a perceptually uniform color space:
+ * equal distances correspond to roughly equal perceived differences,
+ * which HSV does not provide. Conversion from linear RGB is two 3x3
+ * matrices around a per-channel cube root. The cube root is the only
+ * expensive step, so it is replaced by a bit-level estimate refined with
+ * Newton iterations, keeping the cost close to the float HSV conversion.
+ *
+ * Calibrated sensor RGB is treated as linear sRGB (D65 white).
+ */
+
+#include "APDS9960_ColorSensor.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Fast cube root for non-negative and negative floats
+ *
+ * Starts from an exponent-divided-by-three estimate taken from the IEEE
+ * 754 bit pattern, then applies two Newton steps. Measured relative error
+ * against cbrtf() is below 2e-6 over [1e-6, 1], which is well below the
+ * resolution of the 16-bit input.
+ *
+ * @param x Input value
+ * @return Approximation of the real cube root of x
+ */
+static float fastCbrt(float x) {
+    if (x == 0.0f) {
+        return 0.0f;
+    }
+
+    const bool negative = x < 0.0f;
+    if (negative) {
+        x = -x;
+    }
+
+    // Initial estimate: divide the biased exponent by three
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = bits / 3 + 0x2A5137A0UL;
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+
+    // Two Newton iterations: y = (2y + x / y^2) / 3
+    y = (2.0f * y + x / (y * y)) * (1.0f / 3.0f);
+    y = (2.0f * y + x / (y * y)) * (1.0f / 3.0f);
+
+    return negative ? -y : y;
+}
+
+/**
+ * @struct OKLChRange
+ * @brief Hue band of a chromatic standard color in OKLCh
+ *
+ * Bounds are the HSV band edges of detectColor() converted to OKLCh hue
+ * angles. detectColor() computes HSV from linear RGB16, so the edges are
+ * taken on the fully saturated linear RGB wheel (e.g. HSV 20 degrees =
+ * linear (1, 0.33, 0) = OKLCh 66 degrees), not on the sRGB-encoded one.
+ * Semi-open [hMin, hMax); hMin > hMax wraps around 0/360 degrees.
+ */
+struct OKLChRange {
+    float hMin;           ///< Lower hue angle (degrees, inclusive)
+    float hMax;           ///< Upper hue angle (degrees, exclusive)
+    StandardColor color;  ///< Color reported for this band
+};
+
+/// Chromatic standard colors by OKLCh hue angle (no overlap)
+static const OKLChRange OKLCH_RANGES[] = {
+    {354.0f,  66.0f, StandardColor::RED},      // HSV 340-20
+    { 66.0f, 103.0f, StandardColor::ORANGE},   // HSV 20-50
+    {103.0f, 121.0f, StandardColor::YELLOW},   // HSV 50-80
+    {121.0f, 180.0f, StandardColor::GREEN},    // HSV 80-165
+    {180.0f, 234.0f, StandardColor::CYAN},     // HSV 165-210
+    {234.0f, 308.0f, StandardColor::BLUE},     // HSV 210-265
+    {308.0f, 326.0f, StandardColor::PURPLE},   // HSV 265-295
+    {326.0f, 354.0f, StandardColor::MAGENTA},  // HSV 295-340
+};
+
+// OKLCh classification thresholds (before tolerance is applied)
+static const float OKLCH_DARK_MAX_L = 0.25f;       ///< Too dark for any hue (~1.6% reflectance)
+static const float OKLCH_BLACK_MAX_L = 0.45f;      ///< Dark neutral (~9% reflectance)
+static const float OKLCH_WHITE_MIN_L = 0.85f;      ///< Light neutral (~61% reflectance)
+static const float OKLCH_NEUTRAL_MAX_C = 0.04f;    ///< Below this chroma a color reads as gray
+static const float OKLCH_CHROMATIC_MIN_C = 0.06f;  ///< Minimum chroma for a hue to be trusted
+
+/**
+ * @brief Read the current color in OKLab space
+ *
+ * Reads 16-bit calibrated RGB and converts it with convertToOKLab().
+ *
+ * @param lab Reference to OKLab struct to populate
+ * @return true if read successful, false on sensor read error
+ */
+bool ADPS9960_ColorSensor::readColorOKLab(OKLab &lab) {
+    RGB16 rgb{};
+    if (!readRGB16(rgb)) {
+        return false;
+    }
+
+    convertToOKLab(rgb, lab);
+    return true;
+}
+
+/**
+ * @brief Convert a linear 16-bit RGB color to OKLab
+ *
+ * Algorithm:
+ * 1. Linear RGB -> LMS cone response (3x3 matrix)
+ * 2. Cube root of each LMS component (fastCbrt)
+ * 3. Non-linear LMS -> Lab (3x3 matrix)
+ *
+ * @param rgb Source color, linear and calibrated (65535 = calibrated white)
+ * @param lab Reference to OKLab struct to populate
+ */
+void ADPS9960_ColorSensor::convertToOKLab(const RGB16 &rgb, OKLab &lab) {
+    const float r = static_cast<float>(rgb.r) / 65535.0f;
+    const float g = static_cast<float>(rgb.g) / 65535.0f;
+    const float b = static_cast<float>(rgb.b) / 65535.0f;
+
+    const float l = fastCbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    const float m = fastCbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    const float s = fastCbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+    lab.L = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+    lab.a = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+    lab.b = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+}
+
+/**
+ * @brief Convert an OKLab color to its polar OKLCh form
+ *
+ * @param lab Source color
+ * @param lch Reference to OKLCh struct to populate (hue in 0-360 degrees)
+ */
+void ADPS9960_ColorSensor::convertToOKLCh(const OKLab &lab, OKLCh &lch) {
+    lch.L = lab.L;
+    lch.C = sqrtf(lab.a * lab.a + lab.b * lab.b);
+
+    float h = atan2f(lab.b, lab.a) * 57.2957795f; // radians to degrees
+    if (h < 0.0f) {
+        h += 360.0f;
+    }
+    lch.h = h;
+}
+
+/**
+ * @brief Classify an OKLCh color into the closest standard color
+ *
+ * Same priority order as classifyHSV(), with thresholds expressed in
+ * perceptual lightness and chroma:
+ * 1. BLACK:   L <= 0.25 + tolerance / 2 (no reliable hue)
+ * 2. Neutral: C <= 0.04 + tolerance / 5
+ *    - WHITE if L >= 0.85 - tolerance / 2
+ *    - BLACK if L <= 0.45 + tolerance / 2
+ * 3. Chromatic colors by hue angle when C >= 0.06 - tolerance / 5
+ *
+ * Unlike HSV value, OKLab lightness of saturated blue or purple is low,
+ * so the neutral BLACK limit is only applied to low-chroma colors.
+ *
+ * @param lch Color to classify
+ * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
+ * @return StandardColor enum of matching color, UNKNOWN if no match
+ */
+StandardColor ADPS9960_ColorSensor::classifyOKLCh(const OKLCh &lch, float tolerance) {
+    // Clamp tolerance to valid range
+    if (tolerance < 0.0f) tolerance = 0.0f;
+    if (tolerance > 1.0f) tolerance = 1.0f;
+
+    // Priority 1: BLACK (too dark to trust any hue)
+    if (lch.L <= OKLCH_DARK_MAX_L + tolerance * 0.5f) {
+        return StandardColor::BLACK;
+    }
+
+    // Priority 2: neutral colors (WHITE, BLACK or an unnamed gray)
+    if (lch.C <= OKLCH_NEUTRAL_MAX_C + tolerance * 0.2f) {
+        if (lch.L >= OKLCH_WHITE_MIN_L - tolerance * 0.5f) {
+            return StandardColor::WHITE;
+        }
+        if (lch.L <= OKLCH_BLACK_MAX_L + tolerance * 0.5f) {
+            return StandardColor::BLACK;
+        }
+        return StandardColor::UNKNOWN;
+    }
+
+    // Priority 3: chromatic colors need enough chroma for a stable hue
+    if (lch.C < OKLCH_CHROMATIC_MIN_C - tolerance * 0.2f) {
+        return StandardColor::UNKNOWN;
+    }
+
+    for (const OKLChRange &range : OKLCH_RANGES) {
+        const bool inBand = (range.hMin <= range.hMax)
+                                ? (lch.h >= range.hMin && lch.h < range.hMax)
+                                : (lch.h >= range.hMin || lch.h < range.hMax);
+        if (inBand) {
+            return range.color;
+        }
+    }
+
+    return StandardColor::UNKNOWN;
+}
+
+/**
+ * @brief Detect the closest standard color using OKLCh hue angles
+ *
+ * Perceptually even counterpart of detectColor(): reads OKLab, converts
+ * to OKLCh and classifies with classifyOKLCh().
+ *
+ * @param tolerance Tolerance factor (0.0-1.0, default 0.15 = 15%)
+ * @return StandardColor enum of detected color, UNKNOWN if no match, read error
+ *         or clipped channel
+ */
+StandardColor ADPS9960_ColorSensor::detectColorOKLCh(float tolerance) {
+    OKLab lab{};
+    if (!readColorOKLab(lab) || lastSaturatedMask != 0) {
+        return StandardColor::UNKNOWN; // Read error or clipped channel
+    }
+    energyReport.classifications++;
+
+    OKLCh lch{};
+    convertToOKLCh(lab, lch);
+    return classifyOKLCh(lch, tolerance);
+}
+
+/**
+ * @brief Find the palette entry nearest to a color in OKLab space
+ *
+ * Linear scan comparing squared Euclidean distances; the square root is
+ * taken only once, for the reported distance of the winner.
+ *
+ * @param lab Color to match
+ * @param palette Array of reference colors
+ * @param paletteSize Number of entries in palette
+ * @param distance Optional pointer receiving the OKLab distance (0.02 is
+ *                 about one just-noticeable difference)
+ * @return Index of the nearest entry, -1 if palette is null or empty
+ */
+int ADPS9960_ColorSensor::findNearestColor(const OKLab &lab, const OKLab *palette,
+                                           uint8_t paletteSize, float *distance) {
+    if (palette == nullptr || paletteSize == 0) {
+        return -1;
+    }
+
+    int bestIndex = 0;
+    float bestDistance2 = 0.0f;
+
+    for (uint8_t i = 0; i < paletteSize; i++) {
+        const float dL = lab.L - palette[i].L;
+        const float da = lab.a - palette[i].a;
+        const float db = lab.b - palette[i].b;
+        const float d2 = dL * dL + da * da + db * db;
+
+        if (i == 0 || d2 < bestDistance2) {
+            bestDistance2 = d2;
+            bestIndex = i;
+        }
+    }
+
+    if (distance != nullptr) {
+        *distance = sqrtf(bestDistance2);
+    }
+    return bestIndex;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file APDS9960_Oversampling.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Oversampling and decimation for noise-limited dark targets
+ *
+ * Dark materials give raw counts in the tens, where noise and the 1-count
+ * quantization dominate the hue. Oversampling accumulates several fresh
+ * integrations (AVALID set, never the same result twice) into 32-bit sums
+ * and decimates them into one reading:
+ *
+ * - readRawData() returns the rounded average, so every existing path
+ *   (RGB, HSV, OKLab, chromaticity, white balance) uses it unchanged.
+ * - readRGB16() normalizes the average with 8 fractional bits, keeping
+ *   the resolution gained below one count.
+ *
+ * Averaging N integrations with white noise improves the SNR by sqrt(N),
+ * i.e. 0.5 * log2(N) effective bits, at N times the latency. The count is
+ * either fixed or chosen per reading to reach a target SNR.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/// Samples needed before the SNR estimate can stop adaptive oversampling
+static const uint8_t OVERSAMPLING_MIN_SNR_SAMPLES = 4;
+
+/// Quantization noise variance of one count (1/12)
+static const float QUANTIZATION_VARIANCE = 1.0f / 12.0f;
+
+/**
+ * @brief Average a fixed number of fresh integrations per reading
+ * @param samples Integrations per reading (clamped to MAX_OVERSAMPLING, 0 or 1 disables)
+ * @note Disables the target SNR mode
+ */
+void ADPS9960_ColorSensor::setOversampling(uint8_t samples) {
+    oversampleCount = samples > MAX_OVERSAMPLING ? MAX_OVERSAMPLING : samples;
+    oversampleTargetSNR = 0.0f;
+}
+
+/**
+ * @brief Average fresh integrations until a target SNR is reached
+ *
+ * The SNR of the running average is estimated from the clear channel as
+ * mean * sqrt(n) / stddev, with the quantization noise as floor. Bright
+ * targets stop after OVERSAMPLING_MIN_SNR_SAMPLES integrations, dark ones
+ * continue up to maxSamples.
+ *
+ * @param snr Target SNR (0 disables oversampling)
+ * @param maxSamples Latency bound in integrations (clamped to 4-MAX_OVERSAMPLING)
+ */
+void ADPS9960_ColorSensor::setOversamplingTargetSNR(float snr, uint8_t maxSamples) {
+    if (maxSamples < OVERSAMPLING_MIN_SNR_SAMPLES) maxSamples = OVERSAMPLING_MIN_SNR_SAMPLES;
+    if (maxSamples > MAX_OVERSAMPLING) maxSamples = MAX_OVERSAMPLING;
+
+    oversampleTargetSNR = snr > 0.0f ? snr : 0.0f;
+    oversampleMaxSamples = maxSamples;
+    oversampleCount = 0;
+}
+
+/**
+ * @brief Get the cost and benefit of the last oversampled reading
+ * @return Reference to the report
+ */
+const ADPS9960_ColorSensor::OversamplingReport &ADPS9960_ColorSensor::getOversamplingReport() const {
+    return oversamplingReport;
+}
+
+/**
+ * @brief Wait until the ALS has completed an integration (AVALID)
+ *
+ * AVALID is set at the end of each integration and cleared by reading the
+ * color data, so every reading after a successful wait is a new one.
+ *
+ * @return true when fresh data is available, false on timeout or bus error
+ */
+bool ADPS9960_ColorSensor::waitForValidData() {
+    const unsigned long timeoutMs = 2 * (getSamplePeriodUs() / 1000UL) + 10;
+    const unsigned long start = millis();
+
+    do {
+        uint8_t status;
+        if (!readRegister(REG_STATUS, status)) {
+            return false;
+        }
+        if (status & STATUS_AVALID) {
+            return true;
+        }
+        delayMicroseconds(INTEGRATION_CYCLE_US); // Poll once per integration cycle
+    } while (millis() - start < timeoutMs);
+
+    return false;
+}
+
+/**
+ * @brief Accumulate fresh integrations and decimate them into one reading
+ *
+ * Algorithm:
+ * 1. Wait for AVALID, read the four channels and add them to 32-bit sums
+ *    (64 x 65535 < 2^22); track mean and variance of the clear channel
+ * 2. Stop after the fixed count, or once the estimated SNR reaches the
+ *    target (adaptive mode, bounded by oversampleMaxSamples)
+ * 3. Decimate: store the averages with 8 fractional bits and return them
+ *    rounded to counts
+ * 4. Report samples, effective bits gained, SNR and latency
+ *
+ * @param raw Reference receiving the rounded channel averages
+ * @return true on success, false on read error
+ */
+bool ADPS9960_ColorSensor::readOversampled(RawColor &raw) {
+    const bool adaptive = oversampleTargetSNR > 0.0f;
+    const uint8_t maxSamples = adaptive ? oversampleMaxSamples : oversampleCount;
+    const float targetSNRSquared = oversampleTargetSNR * oversampleTargetSNR;
+
+    uint32_t sum[4] = {0, 0, 0, 0};
+    float mean = 0.0f;
+    float m2 = 0.0f;
+    uint8_t count = 0;
+    const unsigned long startUs = micros();
+
+    // Steps 1-2: accumulate fresh integrations
+    while (count < maxSamples) {
+        RawColor sample{};
+        if (!waitForValidData() || !readSensorChannels(sample)) {
+            return false;
+        }
+        sum[0] += sample.ambient;
+        sum[1] += sample.red;
+        sum[2] += sample.green;
+        sum[3] += sample.blue;
+        count++;
+
+        const float x = static_cast<float>(sample.ambient);
+        const float delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+
+        // SNR^2 of the average = mean^2 * n / variance (no sqrt needed)
+        if (adaptive && count >= OVERSAMPLING_MIN_SNR_SAMPLES) {
+            const float variance = m2 / (count - 1) + QUANTIZATION_VARIANCE;
+            if (mean * mean * count >= targetSNRSquared * variance) {
+                break;
+            }
+        }
+    }
+
+    // Step 3: decimate (sum < 2^22, so sum << 8 fits in 32 bits)
+    for (uint8_t c = 0; c < 4; c++) {
+        oversampleMeanQ8[c] = ((sum[c] << 8) + count / 2) / count;
+    }
+    raw.ambient = static_cast<uint16_t>((oversampleMeanQ8[0] + 128) >> 8);
+    raw.red = static_cast<uint16_t>((oversampleMeanQ8[1] + 128) >> 8);
+    raw.green = static_cast<uint16_t>((oversampleMeanQ8[2] + 128) >> 8);
+    raw.blue = static_cast<uint16_t>((oversampleMeanQ8[3] + 128) >> 8);
+    oversampleValid = true;
+
+    // Step 4: report
+    const float variance = (count > 1 ? m2 / (count - 1) : 0.0f) + QUANTIZATION_VARIANCE;
+    oversamplingReport.samples = count;
+    oversamplingReport.effectiveBitsGain = 0.5f * logf(static_cast<float>(count)) / 0.6931472f;
+    oversamplingReport.snr = mean * sqrtf(static_cast<float>(count) / variance);
+    oversamplingReport.latencyUs = micros() - startUs;
+    return true;
+}
+
+/**
+ * @brief Normalize the last oversampled reading with its fractional bits
+ * @param rgb Reference to RGB16 struct to populate
+ */
+void ADPS9960_ColorSensor::normalizeOversampled(RGB16 &rgb) const {
+    rgb.r = normalizeQ8ToRGB16(oversampleMeanQ8[1], max_red);
+    rgb.g = normalizeQ8ToRGB16(oversampleMeanQ8[2], max_green);
+    rgb.b = normalizeQ8ToRGB16(oversampleMeanQ8[3], max_blue);
+}
+
+/**
+ * @brief Normalize a Q24.8 count to the 16-bit RGB range
+ *
+ * Same scale as normalizeToRGB16(): value = count * 65535 / max, computed
+ * as a Q16 ratio (valueQ8 * 256 / max) so it fits in 32 bits.
+ *
+ * @param valueQ8 Count with 8 fractional bits
+ * @param maxValue Maximum value from calibration
+ * @return Normalized value (0-65535)
+ */
+uint16_t ADPS9960_ColorSensor::normalizeQ8ToRGB16(uint32_t valueQ8, uint16_t maxValue) {
+    // Division guard and overflow clamp
+    if (maxValue == 0) {
+        return 0;
+    }
+    if (valueQ8 >= (static_cast<uint32_t>(maxValue) << 8)) {
+        return 65535;
+    }
+
+    // valueQ8 < maxValue * 2^8 < 2^24, so valueQ8 * 2^8 < 2^32
+    const uint32_t ratioQ16 = (valueQ8 << 8) / maxValue;
+    return static_cast<uint16_t>(ratioQ16 - (ratioQ16 >> 16));
+}
@@ -0,0 +1,268 @@
+/**
+ * @file APDS9960_PaletteLearner.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the PaletteLearner class
+ *
+ * Per sample (k = clusters):
+ *
+ *   nearest = argmin |x - c_i|^2                         k distances
+ *   |x - c|^2 <= radius^2:  c += (x - c) / min(n, maxWeight)
+ *   otherwise:              new cluster at x, replacing the cluster with
+ *                           the fewest members when all slots are in use
+ *
+ * Every MERGE_INTERVAL samples, clusters closer than the merge distance
+ * are merged into their weighted mean. The pass is O(k^2), so the
+ * amortized cost per sample stays O(k) for k <= MERGE_INTERVAL. Squared
+ * distances are compared throughout; the only square root is in the
+ * spread estimate of the cluster that took the sample.
+ */
+
+#include "APDS9960_PaletteLearner.h"
+#include <math.h>
+
+/**
+ * @brief Squared OKLab distance
+ * @param x First color
+ * @param y Second color
+ * @return |x - y|^2
+ */
+static float distance2(const ADPS9960_ColorSensor::OKLab &x, const ADPS9960_ColorSensor::OKLab &y) {
+    const float dL = x.L - y.L;
+    const float da = x.a - y.a;
+    const float db = x.b - y.b;
+    return dL * dL + da * da + db * db;
+}
+
+/**
+ * @brief Constructor - radius 0.06, merge distance 0.03, no clusters
+ * @param colorSensor Calibrated sensor whose white reference normalizes the samples
+ */
+PaletteLearner::PaletteLearner(const ADPS9960_ColorSensor &colorSensor)
+    : sensor(colorSensor),
+      radius2(0.06f * 0.06f),
+      merge2(0.03f * 0.03f),
+      maxWeight(DEFAULT_MAX_WEIGHT),
+      clusters{},
+      clusterCount(0),
+      sinceMerge(0),
+      sampleCount(0) {
+}
+
+/**
+ * @brief Set the cluster distances
+ * @param radius OKLab distance beyond which a sample opens a new cluster
+ * @param mergeDistance Centroids closer than this are merged (clamped to radius)
+ */
+void PaletteLearner::setDistances(float radius, float mergeDistance) {
+    if (radius < 0.0f) radius = 0.0f;
+    if (mergeDistance > radius) mergeDistance = radius;
+    if (mergeDistance < 0.0f) mergeDistance = 0.0f;
+    radius2 = radius * radius;
+    merge2 = mergeDistance * mergeDistance;
+}
+
+/**
+ * @brief Set how long centroids keep adapting
+ * @param weight A centroid moves by at least 1/weight of each new member (minimum 1)
+ */
+void PaletteLearner::setMaxWeight(uint16_t weight) {
+    maxWeight = weight > 0 ? weight : 1;
+}
+
+/**
+ * @brief Feed one sample
+ *
+ * Normalizes the sample like readRGB16() with the sensor's calibration and
+ * converts it to OKLab.
+ *
+ * @param sample Sample from readSample() or a recording
+ * @return Index of the cluster that took the sample, -1 if the sample was skipped
+ */
+int8_t PaletteLearner::update(const ADPS9960_ColorSensor::ColorSample &sample) {
+    if (!ADPS9960_ColorSensor::isSampleUsable(sample)) {
+        return -1;
+    }
+
+    const ADPS9960_ColorSensor::RawColor raw = {sample.ambient, sample.red, sample.green, sample.blue};
+    ADPS9960_ColorSensor::RGB16 rgb;
+    ADPS9960_ColorSensor::OKLab lab;
+    sensor.normalizeRaw(raw, rgb);
+    ADPS9960_ColorSensor::convertToOKLab(rgb, lab);
+    return updateLab(lab);
+}
+
+/**
+ * @brief Feed one color already converted to OKLab
+ *
+ * Algorithm:
+ * 0. Every MERGE_INTERVAL samples, merge clusters that drifted together
+ * 1. Find the nearest centroid
+ * 2. Within the radius: add the color to it with weight 1/min(n, maxWeight)
+ *    and update the spread with the same weight
+ * 3. Otherwise open a cluster, replacing the weakest one if all are in use
+ * 4. Halve all member counts when one saturates
+ *
+ * @param lab Color to cluster
+ * @return Index of the cluster that took the color
+ */
+int8_t PaletteLearner::updateLab(const ADPS9960_ColorSensor::OKLab &lab) {
+    sampleCount++;
+    if (++sinceMerge >= MERGE_INTERVAL) {
+        sinceMerge = 0;
+        mergeClusters(); // Before the search, so the returned index stays valid
+    }
+
+    // Step 1: nearest centroid
+    uint8_t nearest = 0;
+    float nearest2 = 0.0f;
+    for (uint8_t i = 0; i < clusterCount; i++) {
+        const float d2 = distance2(lab, clusters[i].centroid);
+        if (i == 0 || d2 < nearest2) {
+            nearest2 = d2;
+            nearest = i;
+        }
+    }
+
+    if (clusterCount > 0 && nearest2 <= radius2) {
+        // Step 2: running mean, bounded weight so the centroid can follow drift
+        Cluster &cluster = clusters[nearest];
+        if (cluster.samples < 65535) {
+            cluster.samples++;
+        }
+        const float weight = 1.0f / static_cast<float>(cluster.samples < maxWeight ? cluster.samples : maxWeight);
+        cluster.centroid.L += (lab.L - cluster.centroid.L) * weight;
+        cluster.centroid.a += (lab.a - cluster.centroid.a) * weight;
+        cluster.centroid.b += (lab.b - cluster.centroid.b) * weight;
+        cluster.spread += (sqrtf(nearest2) - cluster.spread) * weight;
+    } else {
+        // Step 3: a new color
+        if (clusterCount < MAX_CLUSTERS) {
+            nearest = clusterCount++;
+        } else {
+            nearest = 0;
+            for (uint8_t i = 1; i < clusterCount; i++) {
+                if (clusters[i].samples < clusters[nearest].samples) {
+                    nearest = i;
+                }
+            }
+        }
+        clusters[nearest].centroid = lab;
+        clusters[nearest].spread = 0.0f;
+        clusters[nearest].samples = 1;
+    }
+
+    // Step 4: keep the counts in range, preserving their ratios
+    if (clusters[nearest].samples == 65535) {
+        for (uint8_t i = 0; i < clusterCount; i++) {
+            clusters[i].samples = static_cast<uint16_t>((clusters[i].samples + 1) / 2);
+        }
+    }
+    return static_cast<int8_t>(nearest);
+}
+
+/**
+ * @brief Get the number of clusters
+ * @return Clusters discovered so far
+ */
+uint8_t PaletteLearner::getClusterCount() const {
+    return clusterCount;
+}
+
+/**
+ * @brief Get one cluster
+ * @param index 0 to getClusterCount() - 1 (clamped)
+ * @return Reference to the cluster
+ */
+const PaletteLearner::Cluster &PaletteLearner::getCluster(uint8_t index) const {
+    return clusters[index < MAX_CLUSTERS ? index : MAX_CLUSTERS - 1];
+}
+
+/**
+ * @brief Export the centroids as a palette, most frequent first
+ *
+ * Selection by repeated maximum: O(k^2) once per export, no buffer.
+ *
+ * @param palette Array receiving the centroids
+ * @param maxEntries Size of palette
+ * @param minShare Clusters with a smaller share of all members are left out
+ * @return Number of entries written
+ */
+uint8_t PaletteLearner::exportPalette(ADPS9960_ColorSensor::OKLab *palette, uint8_t maxEntries,
+                                      float minShare) const {
+    if (palette == nullptr) {
+        return 0;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < clusterCount; i++) {
+        total += clusters[i].samples;
+    }
+    const float minSamples = minShare * static_cast<float>(total);
+
+    uint16_t exported = 0; // Bit i: cluster i written
+    uint8_t count = 0;
+    while (count < maxEntries) {
+        int8_t best = -1;
+        for (uint8_t i = 0; i < clusterCount; i++) {
+            if (!(exported & (1U << i)) && static_cast<float>(clusters[i].samples) >= minSamples &&
+                (best < 0 || clusters[i].samples > clusters[best].samples)) {
+                best = static_cast<int8_t>(i);
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        exported |= static_cast<uint16_t>(1U << best);
+        palette[count++] = clusters[best].centroid;
+    }
+    return count;
+}
+
+/**
+ * @brief Get the samples clustered since the last reset
+ * @return Sample count
+ */
+uint32_t PaletteLearner::getSampleCount() const {
+    return sampleCount;
+}
+
+/**
+ * @brief Forget all clusters (keeps the settings)
+ */
+void PaletteLearner::reset() {
+    clusterCount = 0;
+    sinceMerge = 0;
+    sampleCount = 0;
+}
+
+/**
+ * @brief Merge every pair of clusters closer than the merge distance
+ *
+ * The merged centroid and spread are the member-weighted means; the last
+ * cluster moves into the freed slot.
+ */
+void PaletteLearner::mergeClusters() {
+    for (uint8_t i = 0; i < clusterCount; i++) {
+        uint8_t j = i + 1;
+        while (j < clusterCount) {
+            if (distance2(clusters[i].centroid, clusters[j].centroid) > merge2) {
+                j++;
+                continue;
+            }
+
+            Cluster &target = clusters[i];
+            const Cluster &source = clusters[j];
+            const uint32_t total = static_cast<uint32_t>(target.samples) + source.samples;
+            const float wt = static_cast<float>(target.samples) / static_cast<float>(total);
+            const float ws = 1.0f - wt;
+            target.centroid.L = target.centroid.L * wt + source.centroid.L * ws;
+            target.centroid.a = target.centroid.a * wt + source.centroid.a * ws;
+            target.centroid.b = target.centroid.b * wt + source.centroid.b * ws;
+            target.spread = target.spread * wt + source.spread * ws;
+            target.samples = static_cast<uint16_t>(total > 65535UL ? 65535UL : total);
+
+            clusters[j] = clusters[--clusterCount]; // Re-check the moved cluster at j
+        }
+    }
+}
@@ -0,0 +1,370 @@
+/**
+ * @file APDS9960_Profiles.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Named illuminant calibration profiles and persistent calibration storage
+ *
+ * Lines that alternate between lighting conditions (daylight shifts,
+ * LED-only night shifts) need one calibration per illuminant. Profiles
+ * store the white reference of each illuminant and the transfer matrix
+ * fitted under it (filter mismatch depends on the light's spectrum) under
+ * a short name; switching copies one small struct and rescales it to the
+ * current exposure, so it takes constant time and never touches the sensor.
+ *
+ * Profiles hold no dark level: the library subtracts none anywhere. The
+ * ALS dark count is a few counts at most, and white-balanced readings are
+ * already zero in the dark under every illuminant.
+ *
+ * exportCalibration()/importCalibration() pack the complete calibration
+ * state (current calibration, gain ratios, all profiles, the fleet
+ * transfer matrix and the size and checksum of the correction LUT) into a plain
+ * struct with a checksum, ready to be written with EEPROM.put() or
+ * Preferences.putBytes().
+ */
+
+#include "APDS9960_ColorSensor.h"
+#include <string.h>
+#include <stddef.h>
+
+/**
+ * @brief Store the current calibration as a named profile
+ *
+ * The scene signature (R/G/B relative to clear) records the color of the
+ * light on the reference surface, so autoSelectProfile() can later tell
+ * which illuminant is active.
+ *
+ * @param name Profile name (null or empty names are rejected)
+ * @param captureSignature true to read the sensor and record the signature
+ * @return Profile index, -1 if not calibrated, name invalid or no free slot
+ *
+ * @note If the signature read fails, the profile is saved without one
+ */
+int8_t ADPS9960_ColorSensor::saveProfile(const char *name, bool captureSignature) {
+    if (name == nullptr || name[0] == '\0' || calibrationStatus == NOT_CALIBRATED) {
+        return -1;
+    }
+
+    // Overwrite a profile with the same name, otherwise append
+    int8_t index = findProfile(name);
+    if (index < 0) {
+        if (profileCount >= MAX_PROFILES) {
+            return -1;
+        }
+        index = static_cast<int8_t>(profileCount++);
+    }
+
+    CalibrationProfile &profile = profiles[index];
+    strncpy(profile.name, name, PROFILE_NAME_LENGTH - 1);
+    profile.name[PROFILE_NAME_LENGTH - 1] = '\0';
+    profile.data = calibration;
+    profile.status = static_cast<uint8_t>(calibrationStatus);
+    profile.transfer = transferMatrix;
+    profile.transferEnabled = transferEnabled ? 1 : 0;
+    profile.signature[0] = profile.signature[1] = profile.signature[2] = 0;
+
+    if (captureSignature) {
+        readSceneSignature(profile.signature);
+    }
+
+    activeProfile = index;
+    return index;
+}
+
+/**
+ * @brief Activate a stored profile
+ *
+ * Copies the profile's white reference into the active calibration and
+ * rescales it to the current gain and ATIME, restores the transfer matrix
+ * and the calibration status the profile was saved with (a profile saved
+ * from defaults stays CALIBRATED_WITH_DEFAULTS). Constant time, no bus access.
+ *
+ * @param index Profile index
+ * @return true if selected, false for invalid index
+ */
+bool ADPS9960_ColorSensor::selectProfile(uint8_t index) {
+    if (index >= profileCount) {
+        return false;
+    }
+
+    calibration = profiles[index].data;
+    transferMatrix = profiles[index].transfer;
+    transferEnabled = profiles[index].transferEnabled != 0;
+    updateActiveCalibration();
+    calibrationStatus = static_cast<CalibrationStatus>(profiles[index].status);
+    activeProfile = static_cast<int8_t>(index);
+    return true;
+}
+
+/**
+ * @brief Activate a stored profile by name
+ * @param name Profile name
+ * @return true if found and selected, false otherwise
+ */
+bool ADPS9960_ColorSensor::selectProfile(const char *name) {
+    const int8_t index = findProfile(name);
+    if (index < 0) {
+        return false;
+    }
+    return selectProfile(static_cast<uint8_t>(index));
+}
+
+/**
+ * @brief Find a stored profile by name
+ * @param name Profile name (compared up to PROFILE_NAME_LENGTH - 1 characters)
+ * @return Profile index, -1 if not found
+ */
+int8_t ADPS9960_ColorSensor::findProfile(const char *name) const {
+    if (name == nullptr) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < profileCount; i++) {
+        if (strncmp(profiles[i].name, name, PROFILE_NAME_LENGTH - 1) == 0) {
+            return static_cast<int8_t>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Delete a stored profile
+ *
+ * The calibration in use is not changed, even when the active profile is
+ * removed; it simply no longer belongs to a stored profile.
+ *
+ * @param index Profile index
+ * @return true if removed, false for invalid index
+ */
+bool ADPS9960_ColorSensor::removeProfile(uint8_t index) {
+    if (index >= profileCount) {
+        return false;
+    }
+
+    for (uint8_t i = index; i + 1 < profileCount; i++) {
+        profiles[i] = profiles[i + 1];
+    }
+    profileCount--;
+    memset(&profiles[profileCount], 0, sizeof(CalibrationProfile));
+
+    if (activeProfile == static_cast<int8_t>(index)) {
+        activeProfile = -1;
+    } else if (activeProfile > static_cast<int8_t>(index)) {
+        activeProfile--;
+    }
+    return true;
+}
+
+/**
+ * @brief Get the number of stored profiles
+ * @return 0 to MAX_PROFILES
+ */
+uint8_t ADPS9960_ColorSensor::getProfileCount() const {
+    return profileCount;
+}
+
+/**
+ * @brief Get the name of a stored profile
+ * @param index Profile index
+ * @return Profile name, "" for invalid index
+ */
+const char *ADPS9960_ColorSensor::getProfileName(uint8_t index) const {
+    if (index >= profileCount) {
+        return "";
+    }
+    return profiles[index].name;
+}
+
+/**
+ * @brief Get the index of the active profile
+ * @return Profile index, -1 if none is active
+ */
+int8_t ADPS9960_ColorSensor::getActiveProfile() const {
+    return activeProfile;
+}
+
+/**
+ * @brief Select the profile whose scene signature best matches the current light
+ *
+ * Reads one sample, computes its signature and picks the profile with the
+ * smallest sum of absolute signature differences. Profiles saved without a
+ * signature are skipped.
+ *
+ * @return Selected profile index, -1 if no candidate or sensor read error
+ */
+int8_t ADPS9960_ColorSensor::autoSelectProfile() {
+    uint16_t signature[3];
+    if (!readSceneSignature(signature)) {
+        return -1;
+    }
+
+    int8_t best = -1;
+    uint32_t bestDistance = 0;
+    for (uint8_t i = 0; i < profileCount; i++) {
+        const uint16_t *reference = profiles[i].signature;
+        if (reference[0] == 0 && reference[1] == 0 && reference[2] == 0) {
+            continue; // Saved without signature
+        }
+
+        uint32_t distance = 0;
+        for (uint8_t c = 0; c < 3; c++) {
+            distance += reference[c] > signature[c] ? reference[c] - signature[c]
+                                                    : signature[c] - reference[c];
+        }
+
+        if (best < 0 || distance < bestDistance) {
+            best = static_cast<int8_t>(i);
+            bestDistance = distance;
+        }
+    }
+
+    if (best >= 0) {
+        selectProfile(static_cast<uint8_t>(best));
+    }
+    return best;
+}
+
+/**
+ * @brief Read the sensor and compute the signature of the ambient light
+ *
+ * With differential capture a reading is the LED reflection only, so the
+ * signature is taken from the LED-off integration of the pair, which is
+ * what the light source looks like without the LED.
+ *
+ * @param signature Array of 3 values receiving the signature
+ * @return true on success, false on sensor read error
+ */
+bool ADPS9960_ColorSensor::readSceneSignature(uint16_t signature[3]) {
+    RawColor raw{};
+    if (!readRawData(raw)) {
+        return false;
+    }
+
+    computeSignature(isDifferentialCapture() ? differentialReport.ambient : raw, signature);
+    return true;
+}
+
+/**
+ * @brief Compute the scene signature of a sample
+ *
+ * R, G and B divided by the clear channel (CHROMA_SCALE = equal to clear).
+ * Independent of brightness and of the calibration, so it identifies the
+ * spectrum of the light source.
+ *
+ * @param raw Sample to describe
+ * @param signature Array of 3 values receiving the signature (all 0 when dark)
+ */
+void ADPS9960_ColorSensor::computeSignature(const RawColor &raw, uint16_t signature[3]) {
+    if (raw.ambient == 0) {
+        signature[0] = signature[1] = signature[2] = 0;
+        return;
+    }
+
+    const uint16_t channels[3] = {raw.red, raw.green, raw.blue};
+    for (uint8_t c = 0; c < 3; c++) {
+        const uint32_t value = (static_cast<uint32_t>(channels[c]) * CHROMA_SCALE) / raw.ambient;
+        signature[c] = value > 65535UL ? 65535 : static_cast<uint16_t>(value);
+    }
+}
+
+/**
+ * @brief Fletcher-16 checksum
+ * @param data Bytes to check
+ * @param length Number of bytes
+ * @return 16-bit checksum
+ */
+static uint16_t fletcher16(const uint8_t *data, size_t length) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (size_t i = 0; i < length; i++) {
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return static_cast<uint16_t>((sum2 << 8) | sum1);
+}
+
+/**
+ * @brief Copy the complete calibration state into a storable blob
+ *
+ * The blob is zeroed first so that padding bytes are deterministic and
+ * the checksum is stable.
+ *
+ * @param blob Reference to CalibrationBlob to fill
+ */
+void ADPS9960_ColorSensor::exportCalibration(CalibrationBlob &blob) const {
+    memset(&blob, 0, sizeof(blob));
+
+    blob.magic = CALIBRATION_BLOB_MAGIC;
+    blob.version = CALIBRATION_BLOB_VERSION;
+    blob.status = static_cast<uint8_t>(calibrationStatus);
+    blob.current = calibration;
+    memcpy(blob.gainRatios, gainRatios, sizeof(gainRatios));
+    blob.profileCount = profileCount;
+    blob.activeProfile = activeProfile;
+    memcpy(blob.profiles, profiles, sizeof(profiles));
+    blob.transfer = transferMatrix;
+    blob.transferEnabled = transferEnabled ? 1 : 0;
+    if (correctionLUT != nullptr) {
+        blob.lutGridSize = correctionLUTSize;
+        blob.lutChecksum = getColorCorrectionLUTChecksum(correctionLUT, correctionLUTSize, correctionLUTInProgmem);
+    }
+
+    blob.checksum = fletcher16(reinterpret_cast<const uint8_t *>(&blob),
+                               offsetof(CalibrationBlob, checksum));
+}
+
+/**
+ * @brief Restore calibration state from a blob
+ *
+ * Validates magic, version, checksum and counts before changing anything,
+ * so a corrupted or blank EEPROM leaves the current state untouched.
+ * Blobs of an older layout version are rejected.
+ *
+ * The correction LUT is not in the blob, only its size and checksum: from
+ * now on setColorCorrectionLUT() accepts only that table, and a LUT already
+ * set that does not match is disabled.
+ *
+ * @param blob Blob previously filled by exportCalibration()
+ * @return true if restored, false if the blob is invalid
+ */
+bool ADPS9960_ColorSensor::importCalibration(const CalibrationBlob &blob) {
+    if (blob.magic != CALIBRATION_BLOB_MAGIC || blob.version != CALIBRATION_BLOB_VERSION) {
+        return false;
+    }
+
+    const uint16_t checksum = fletcher16(reinterpret_cast<const uint8_t *>(&blob),
+                                         offsetof(CalibrationBlob, checksum));
+    if (checksum != blob.checksum) {
+        return false;
+    }
+
+    if (blob.profileCount > MAX_PROFILES || blob.activeProfile >= static_cast<int8_t>(blob.profileCount) ||
+        blob.status > CALIBRATED_WITH_DEFAULTS || blob.current.gain >= GAIN_COUNT ||
+        (blob.lutGridSize != 0 && (blob.lutGridSize < MIN_LUT_GRID_SIZE || blob.lutGridSize > MAX_LUT_GRID_SIZE))) {
+        return false;
+    }
+    for (uint8_t i = 0; i < blob.profileCount; i++) {
+        if (blob.profiles[i].status == NOT_CALIBRATED || blob.profiles[i].status > CALIBRATED_WITH_DEFAULTS) {
+            return false;
+        }
+    }
+
+    calibration = blob.current;
+    memcpy(gainRatios, blob.gainRatios, sizeof(gainRatios));
+    profileCount = blob.profileCount;
+    activeProfile = blob.activeProfile < 0 ? -1 : blob.activeProfile;
+    memcpy(profiles, blob.profiles, sizeof(profiles));
+    transferMatrix = blob.transfer;
+    transferEnabled = blob.transferEnabled != 0;
+    calibrationStatus = static_cast<CalibrationStatus>(blob.status);
+
+    expectedLUTSize = blob.lutGridSize;
+    expectedLUTChecksum = blob.lutChecksum;
+    if (correctionLUT != nullptr && expectedLUTSize != 0 &&
+        (correctionLUTSize != expectedLUTSize ||
+         getColorCorrectionLUTChecksum(correctionLUT, correctionLUTSize, correctionLUTInProgmem) != expectedLUTChecksum)) {
+        clearColorCorrectionLUT();
+    }
+
+    updateActiveCalibration();
+    return true;
+}
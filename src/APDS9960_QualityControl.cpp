@@ -0,0 +1,328 @@
+/**
+ * @file APDS9960_QualityControl.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the ColorQualityControl class
+ *
+ * Each offset from the golden mean is divided by the golden noise of its
+ * axis, sigma_L, sigma_a or sigma_b. With independent normal noise, the
+ * length d of the standardized offset follows a chi distribution with 3
+ * degrees of freedom whatever the three sigmas are:
+ *
+ *   mean  = 2 * sqrt(2 / pi)   = 1.596
+ *   stdev = sqrt(3 - 8 / pi)   = 0.673
+ *
+ * The charts run on d with these in-control parameters:
+ *
+ *   EWMA   z = lambda * d + (1 - lambda) * z,  z0 = mean
+ *          limit = mean + L * stdev * sqrt(lambda / (2 - lambda) * (1 - (1 - lambda)^(2t)))
+ *   CUSUM  S = max(0, S + (d - mean) / stdev - k),  alarm when S > h
+ *
+ * d only grows when the process moves away from the golden sample in any
+ * direction, so both charts are one-sided; the direction is tracked
+ * separately as an EWMA of the per-axis offset.
+ *
+ * The sigmas must describe the spread of good parts. Readings of several
+ * good parts give it directly; repeated readings of a single part only
+ * give the sensor noise, so the part-to-part spread is then added with
+ * setProcessSigma():
+ *
+ *   sigma = sqrt(sigma_taught^2 + sigma_process^2)
+ */
+
+#include "APDS9960_QualityControl.h"
+#include <math.h>
+
+/// Lower bound of the golden noise, so a perfectly steady reference does not flag every part
+static const float MIN_GOLDEN_SIGMA = 0.0005f;
+
+/// Mean of a chi distribution with 3 degrees of freedom, in sigmas
+static const float CHI3_MEAN = 1.5958f;
+
+/// Standard deviation of a chi distribution with 3 degrees of freedom, in sigmas
+static const float CHI3_STDEV = 0.6734f;
+
+/// Single-part limit in standard deviations of the standardized distance
+static const float OUTLIER_SIGMAS = 3.0f;
+
+/**
+ * @brief Constructor - no golden sample, EWMA lambda 0.2 at 3 sigma, CUSUM k 0.5 h 5
+ * @param colorSensor Calibrated sensor whose white reference normalizes the samples
+ */
+ColorQualityControl::ColorQualityControl(const ADPS9960_ColorSensor &colorSensor)
+    : sensor(colorSensor),
+      golden{},
+      processSigma(0.0f),
+      toleranceDeltaE(0.0f),
+      lambda(0.2f),
+      ewmaLimitSigmas(3.0f),
+      cusumSlack(0.5f),
+      cusumDecision(5.0f),
+      teachCount(0),
+      teachMean{0.0f, 0.0f, 0.0f},
+      teachM2{0.0f, 0.0f, 0.0f},
+      axisScale{0.0f, 0.0f, 0.0f},
+      ewma(0.0f),
+      ewmaStart(1.0f),
+      cusum(0.0f),
+      drift{0.0f, 0.0f, 0.0f},
+      parts(0) {
+}
+
+/**
+ * @brief Add one reading of the golden sample
+ * @param sample Sample from readSample()
+ * @return true if the sample was used (fresh and unclipped)
+ */
+bool ColorQualityControl::addGoldenSample(const ADPS9960_ColorSensor::ColorSample &sample) {
+    if (!ADPS9960_ColorSensor::isSampleUsable(sample)) {
+        return false;
+    }
+
+    const ADPS9960_ColorSensor::RawColor raw = {sample.ambient, sample.red, sample.green, sample.blue};
+    ADPS9960_ColorSensor::RGB16 rgb;
+    ADPS9960_ColorSensor::OKLab lab;
+    sensor.normalizeRaw(raw, rgb);
+    ADPS9960_ColorSensor::convertToOKLab(rgb, lab);
+    addGoldenLab(lab);
+    return true;
+}
+
+/**
+ * @brief Add one golden reading already converted to OKLab
+ *
+ * Welford's running mean and sum of squared deviations per axis: no
+ * sample buffer, numerically stable in single precision.
+ *
+ * @param lab Golden color
+ */
+void ColorQualityControl::addGoldenLab(const ADPS9960_ColorSensor::OKLab &lab) {
+    if (teachCount == 65535) {
+        return;
+    }
+    teachCount++;
+
+    const float values[3] = {lab.L, lab.a, lab.b};
+    for (uint8_t i = 0; i < 3; i++) {
+        const float delta = values[i] - teachMean[i];
+        teachMean[i] += delta / static_cast<float>(teachCount);
+        teachM2[i] += delta * (values[i] - teachMean[i]);
+    }
+}
+
+/**
+ * @brief Freeze the golden reference and reset the charts
+ *
+ * Keeps the sample standard deviation of each axis; pooling them would
+ * let the noisiest axis (usually L) hide shifts along the quiet ones.
+ *
+ * @return true if at least MIN_GOLDEN_SAMPLES were added
+ */
+bool ColorQualityControl::finishGolden() {
+    if (teachCount < MIN_GOLDEN_SAMPLES) {
+        return false;
+    }
+
+    Golden taught;
+    taught.mean.L = teachMean[0];
+    taught.mean.a = teachMean[1];
+    taught.mean.b = teachMean[2];
+    for (uint8_t i = 0; i < 3; i++) {
+        taught.sigma[i] = sqrtf(teachM2[i] / static_cast<float>(teachCount - 1));
+    }
+    taught.samples = teachCount;
+    setGolden(taught);
+
+    teachCount = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        teachMean[i] = 0.0f;
+        teachM2[i] = 0.0f;
+    }
+    return true;
+}
+
+/**
+ * @brief Restore a stored golden reference and reset the charts
+ * @param reference Reference from getGolden()
+ */
+void ColorQualityControl::setGolden(const Golden &reference) {
+    golden = reference;
+    updateLimits();
+    resetCharts();
+}
+
+/**
+ * @brief Set the part-to-part spread that teaching did not see
+ * @param sigma OKLab standard deviation per axis of good parts (0 = taught noise only)
+ */
+void ColorQualityControl::setProcessSigma(float sigma) {
+    processSigma = sigma > 0.0f ? sigma : 0.0f;
+    updateLimits();
+    resetCharts();
+}
+
+/**
+ * @brief Get the golden reference
+ * @return Reference (samples is 0 before finishGolden())
+ */
+const ColorQualityControl::Golden &ColorQualityControl::getGolden() const {
+    return golden;
+}
+
+/**
+ * @brief Set the specified color tolerance
+ * @param deltaE Largest acceptable OKLab distance (0 disables)
+ */
+void ColorQualityControl::setTolerance(float deltaE) {
+    toleranceDeltaE = deltaE > 0.0f ? deltaE : 0.0f;
+}
+
+/**
+ * @brief Set the EWMA chart
+ * @param weight Weight of the newest part (clamped to 0.05-1.0)
+ * @param limitSigmas Control limit in sigmas of the EWMA
+ */
+void ColorQualityControl::setEwma(float weight, float limitSigmas) {
+    if (weight < 0.05f) weight = 0.05f;
+    if (weight > 1.0f) weight = 1.0f;
+    lambda = weight;
+    ewmaLimitSigmas = limitSigmas;
+    resetCharts();
+}
+
+/**
+ * @brief Set the CUSUM chart
+ * @param slack Allowance k in standard deviations of the distance
+ * @param decisionInterval Alarm threshold h in standard deviations of the distance
+ */
+void ColorQualityControl::setCusum(float slack, float decisionInterval) {
+    cusumSlack = slack > 0.0f ? slack : 0.0f;
+    cusumDecision = decisionInterval;
+    resetCharts();
+}
+
+/**
+ * @brief Inspect one part
+ * @param sample Sample from readSample()
+ * @param result Reference receiving the inspection
+ * @return QualityAlarm bits
+ */
+uint8_t ColorQualityControl::inspect(const ADPS9960_ColorSensor::ColorSample &sample, Inspection &result) {
+    if (!ADPS9960_ColorSensor::isSampleUsable(sample)) {
+        result = Inspection{};
+        result.part = parts;
+        result.alarms = QC_NOT_READY;
+        return result.alarms;
+    }
+
+    const ADPS9960_ColorSensor::RawColor raw = {sample.ambient, sample.red, sample.green, sample.blue};
+    ADPS9960_ColorSensor::RGB16 rgb;
+    ADPS9960_ColorSensor::OKLab lab;
+    sensor.normalizeRaw(raw, rgb);
+    ADPS9960_ColorSensor::convertToOKLab(rgb, lab);
+    return inspectLab(lab, result);
+}
+
+/**
+ * @brief Inspect one part already converted to OKLab
+ *
+ * Algorithm:
+ * 1. DeltaE to the golden mean, and the distance with each axis divided
+ *    by its golden noise
+ * 2. Single-part checks: specified tolerance on DeltaE, 3-sigma limit on
+ *    the standardized distance
+ * 3. EWMA with its exact (start-up) control limit
+ * 4. Upper CUSUM on the standardized distance
+ * 5. Per-axis drift direction
+ *
+ * @param lab Part color
+ * @param result Reference receiving the inspection
+ * @return QualityAlarm bits
+ */
+uint8_t ColorQualityControl::inspectLab(const ADPS9960_ColorSensor::OKLab &lab, Inspection &result) {
+    result = Inspection{};
+    if (golden.samples == 0) {
+        result.alarms = QC_NOT_READY;
+        return result.alarms;
+    }
+    parts++;
+    uint8_t alarms = QC_OK;
+
+    // Step 1
+    const float offset[3] = {lab.L - golden.mean.L, lab.a - golden.mean.a, lab.b - golden.mean.b};
+    const float deltaE = sqrtf(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+    const float z[3] = {offset[0] * axisScale[0], offset[1] * axisScale[1], offset[2] * axisScale[2]};
+    const float distance = sqrtf(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
+
+    // Step 2
+    if (toleranceDeltaE > 0.0f && deltaE > toleranceDeltaE) {
+        alarms |= QC_OUT_OF_TOLERANCE;
+    }
+    if (distance > CHI3_MEAN + OUTLIER_SIGMAS * CHI3_STDEV) {
+        alarms |= QC_OUTLIER;
+    }
+
+    // Step 3
+    ewma += lambda * (distance - ewma);
+    ewmaStart *= (1.0f - lambda) * (1.0f - lambda);
+    const float ewmaSigma = CHI3_STDEV * sqrtf(lambda / (2.0f - lambda) * (1.0f - ewmaStart));
+    if (ewma > CHI3_MEAN + ewmaLimitSigmas * ewmaSigma) {
+        alarms |= QC_EWMA_SHIFT;
+    }
+
+    // Step 4
+    cusum += (distance - CHI3_MEAN) / CHI3_STDEV - cusumSlack;
+    if (cusum < 0.0f) {
+        cusum = 0.0f;
+    }
+    if (cusum > cusumDecision) {
+        alarms |= QC_CUSUM_DRIFT;
+    }
+
+    // Step 5
+    for (uint8_t i = 0; i < 3; i++) {
+        drift[i] += lambda * (offset[i] - drift[i]);
+    }
+
+    result.deltaE = deltaE;
+    result.distance = distance;
+    result.ewma = ewma;
+    result.cusum = cusum;
+    result.part = parts;
+    result.alarms = alarms;
+    return alarms;
+}
+
+/**
+ * @brief Get the direction of the process drift
+ * @param offset Reference receiving the EWMA of part - golden per OKLab axis
+ */
+void ColorQualityControl::getDrift(ADPS9960_ColorSensor::OKLab &offset) const {
+    offset.L = drift[0];
+    offset.a = drift[1];
+    offset.b = drift[2];
+}
+
+/**
+ * @brief Restart the EWMA and CUSUM charts
+ */
+void ColorQualityControl::resetCharts() {
+    ewma = CHI3_MEAN;
+    ewmaStart = 1.0f;
+    cusum = 0.0f;
+    for (uint8_t i = 0; i < 3; i++) {
+        drift[i] = 0.0f;
+    }
+    parts = 0;
+}
+
+/**
+ * @brief Derive the per-axis standardization from golden.sigma and the process sigma
+ */
+void ColorQualityControl::updateLimits() {
+    for (uint8_t i = 0; i < 3; i++) {
+        float sigma = sqrtf(golden.sigma[i] * golden.sigma[i] + processSigma * processSigma);
+        if (sigma < MIN_GOLDEN_SIGMA) sigma = MIN_GOLDEN_SIGMA;
+        axisScale[i] = 1.0f / sigma;
+    }
+}
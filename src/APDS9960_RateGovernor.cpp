@@ -0,0 +1,249 @@
+/**
+ * @file APDS9960_RateGovernor.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the SampleRateGovernor class
+ *
+ * Per sample, in integer arithmetic:
+ *
+ *   brightness = |C - C'| / C'                    (relative clear change)
+ *   color      = max |X / (R+G+B) - X' / (R'+G'+B')|, X = R, G, B
+ *
+ * Either above its threshold: period = ceiling period (one step, so an
+ * event is seen at most one ceiling period late once the rate is up).
+ * Otherwise, after stableSamples quiet samples the period doubles, up to
+ * the floor period. Going from the floor to the ceiling thus takes one
+ * sample; going back takes stableSamples * log2(floor / ceiling) samples.
+ */
+
+#include "APDS9960_RateGovernor.h"
+
+/// Longest period WTIME can produce on top of the longest integration (about 9.2 s)
+static const uint32_t MAX_GOVERNOR_PERIOD_US = 9250000UL;
+
+/**
+ * @brief Convert a rate to a period
+ * @param hz Rate in samples per second
+ * @return Period in microseconds, clamped to MAX_GOVERNOR_PERIOD_US
+ */
+static uint32_t periodFromRate(float hz) {
+    if (hz <= 1000000.0f / MAX_GOVERNOR_PERIOD_US) {
+        return MAX_GOVERNOR_PERIOD_US;
+    }
+    return static_cast<uint32_t>(1000000.0f / hz + 0.5f);
+}
+
+/**
+ * @brief Convert a fraction to Q12
+ * @param fraction Value (clamped to 0.0-1.0)
+ * @return fraction * 4096
+ */
+static uint16_t fractionToQ12(float fraction) {
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    return static_cast<uint16_t>(fraction * 4096.0f + 0.5f);
+}
+
+/**
+ * @brief Constructor - 1 Hz floor, 10 Hz ceiling, 5% brightness and 1% color thresholds
+ */
+SampleRateGovernor::SampleRateGovernor()
+    : minPeriodUs(100000UL),
+      maxPeriodUs(1000000UL),
+      periodUs(100000UL),
+      appliedPeriodUs(0),
+      brightnessThresholdQ12(205),
+      colorThresholdQ12(41),
+      stableSamples(DEFAULT_STABLE_SAMPLES),
+      stableCount(0),
+      hasLast(false),
+      lastClear(0),
+      lastShare{0, 0, 0},
+      lastTimestampUs(0),
+      sampleCount(0),
+      eventCount(0),
+      elapsedUs(0) {
+}
+
+/**
+ * @brief Set the slowest and fastest sample rates
+ * @param floorHz Rate of a stable scene
+ * @param ceilingHz Rate while the signal changes (raised to floorHz if lower)
+ */
+void SampleRateGovernor::setRateLimits(float floorHz, float ceilingHz) {
+    if (ceilingHz < floorHz) {
+        ceilingHz = floorHz;
+    }
+    maxPeriodUs = periodFromRate(floorHz);
+    minPeriodUs = periodFromRate(ceilingHz);
+
+    if (periodUs < minPeriodUs) periodUs = minPeriodUs;
+    if (periodUs > maxPeriodUs) periodUs = maxPeriodUs;
+}
+
+/**
+ * @brief Set the change per sample that counts as activity
+ * @param brightnessChange Relative change of the clear channel (0.05 = 5%)
+ * @param colorChange Change of an R/G/B share of R+G+B (0.01 = 1 point)
+ */
+void SampleRateGovernor::setThresholds(float brightnessChange, float colorChange) {
+    brightnessThresholdQ12 = fractionToQ12(brightnessChange);
+    colorThresholdQ12 = fractionToQ12(colorChange);
+}
+
+/**
+ * @brief Set how quickly the rate backs off
+ * @param samplesPerDoubling Stable samples before each doubling of the period (minimum 1)
+ */
+void SampleRateGovernor::setBackoff(uint8_t samplesPerDoubling) {
+    stableSamples = samplesPerDoubling > 0 ? samplesPerDoubling : 1;
+}
+
+/**
+ * @brief Feed one sample and get the period until the next one
+ *
+ * Algorithm:
+ * 1. Ignore repeated samples; accumulate time and count for the average rate
+ * 2. Compute the R/G/B shares of R+G+B (Q12) and the changes against the
+ *    previous sample
+ * 3. Change above a threshold: jump to the ceiling period
+ * 4. Otherwise double the period every stableSamples quiet samples, up to
+ *    the floor period
+ *
+ * @param sample Sample from readSample()
+ * @return Sample period in microseconds
+ */
+uint32_t SampleRateGovernor::update(const ADPS9960_ColorSensor::ColorSample &sample) {
+    // Step 1: fresh samples only
+    if (!(sample.flags & ADPS9960_ColorSensor::SAMPLE_FRESH)) {
+        return periodUs;
+    }
+    if (sampleCount > 0) {
+        elapsedUs += sample.timestampUs - lastTimestampUs;
+    }
+    lastTimestampUs = sample.timestampUs;
+    sampleCount++;
+
+    // Step 2: shares and changes (sum < 2^18, value * 4096 < 2^28)
+    const uint32_t sum = static_cast<uint32_t>(sample.red) + sample.green + sample.blue;
+    const uint16_t values[3] = {sample.red, sample.green, sample.blue};
+    uint16_t share[3] = {0, 0, 0};
+    for (uint8_t c = 0; c < 3; c++) {
+        share[c] = sum > 0 ? static_cast<uint16_t>((static_cast<uint32_t>(values[c]) << 12) / sum) : 0;
+    }
+
+    bool changed = false;
+    if (hasLast) {
+        const uint32_t clearDelta = sample.ambient > lastClear ? sample.ambient - lastClear
+                                                               : lastClear - sample.ambient;
+        const uint32_t reference = lastClear > 0 ? lastClear : 1;
+        changed = (clearDelta << 12) > static_cast<uint32_t>(brightnessThresholdQ12) * reference;
+
+        for (uint8_t c = 0; c < 3 && !changed; c++) {
+            const uint16_t shareDelta = share[c] > lastShare[c] ? share[c] - lastShare[c]
+                                                                : lastShare[c] - share[c];
+            changed = shareDelta > colorThresholdQ12;
+        }
+    }
+
+    hasLast = true;
+    lastClear = sample.ambient;
+    for (uint8_t c = 0; c < 3; c++) {
+        lastShare[c] = share[c];
+    }
+
+    // Step 3: activity
+    if (changed) {
+        if (periodUs != minPeriodUs) {
+            eventCount++;
+        }
+        periodUs = minPeriodUs;
+        stableCount = 0;
+        return periodUs;
+    }
+
+    // Step 4: exponential back-off
+    if (++stableCount >= stableSamples) {
+        stableCount = 0;
+        periodUs = periodUs > maxPeriodUs / 2 ? maxPeriodUs : periodUs * 2;
+    }
+    return periodUs;
+}
+
+/**
+ * @brief Pace the sensor with its wait time to the current period
+ *
+ * The wait time is the period minus the integration time; a period shorter
+ * than the integration disables the wait state (free running).
+ *
+ * @param sensor Sensor to program
+ * @return true on success or if nothing changed, false on bus error
+ */
+bool SampleRateGovernor::apply(ADPS9960_ColorSensor &sensor) {
+    if (periodUs == appliedPeriodUs) {
+        return true;
+    }
+
+    const uint32_t integrationUs = sensor.getIntegrationTimeUs();
+    const uint32_t waitUs = periodUs > integrationUs ? periodUs - integrationUs : 0;
+    if (!sensor.setWaitTime(waitUs)) {
+        return false;
+    }
+    appliedPeriodUs = periodUs;
+    return true;
+}
+
+/**
+ * @brief Get the current sample period
+ * @return Period in microseconds
+ */
+uint32_t SampleRateGovernor::getPeriodUs() const {
+    return periodUs;
+}
+
+/**
+ * @brief Check if the governor runs at the ceiling rate
+ * @return true while the signal changes
+ */
+bool SampleRateGovernor::isActive() const {
+    return periodUs == minPeriodUs;
+}
+
+/**
+ * @brief Get the achieved sample rate since the last reset
+ * @return Fresh samples per second (0 before two samples)
+ */
+float SampleRateGovernor::getAverageRate() const {
+    if (sampleCount < 2 || elapsedUs == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(sampleCount - 1) * 1000000.0f / static_cast<float>(elapsedUs);
+}
+
+/**
+ * @brief Get the fresh samples seen since the last reset
+ * @return Sample count
+ */
+uint32_t SampleRateGovernor::getSampleCount() const {
+    return sampleCount;
+}
+
+/**
+ * @brief Get how often a change raised the rate to the ceiling
+ * @return Activity events since the last reset
+ */
+uint32_t SampleRateGovernor::getEventCount() const {
+    return eventCount;
+}
+
+/**
+ * @brief Forget the signal history and statistics; restart at the ceiling rate
+ */
+void SampleRateGovernor::reset() {
+    periodUs = minPeriodUs;
+    stableCount = 0;
+    hasLast = false;
+    sampleCount = 0;
+    eventCount = 0;
+    elapsedUs = 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file APDS9960_Recovery.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief I2C bus recovery and sensor re-initialization for the APDS9960_ColorSensor class
+ *
+ * A brown-out or a reset of the microcontroller in the middle of a read can
+ * leave the sensor driving SDA low while it waits for clocks that never
+ * come; every later transaction then fails until power is cycled. A
+ * brown-out of the sensor alone resets its registers, so it answers but
+ * no longer integrates. recoverBus() handles both:
+ *
+ * - The cause is classified from the Wire.endTransmission() code of a probe
+ *   read (NACK, arbitration lost / bus error, timeout).
+ * - A bus held low is released with up to 9 SCL pulses, which lets the
+ *   slave shift out the rest of its byte, followed by a STOP.
+ * - A sensor that lost its configuration is re-initialized and gets gain
+ *   and ATIME back from the shadow registers, so the calibration white
+ *   reference stays valid without recalibrating.
+ * - Attempts are spaced by a doubling delay bounded by maxBackoffMs.
+ */
+
+#include "APDS9960_ColorSensor.h"
+#include <Wire.h>
+
+/// Half period of the bit-banged clock (100 kHz)
+static const uint8_t BUS_HALF_PERIOD_US = 5;
+
+/// Power-on time of the sensor before the first register write (5.7 ms typical)
+static const uint8_t SENSOR_STARTUP_MS = 6;
+
+/**
+ * @brief Recover automatically from failed sensor reads
+ * @param sdaPin SDA pin for the bus-clear sequence (-1: no bus clear)
+ * @param sclPin SCL pin for the bus-clear sequence (-1: no bus clear)
+ * @param maxRetries Recovery attempts per failed read (minimum 1)
+ * @param maxBackoffMs Upper bound of the doubling delay between attempts
+ */
+void ADPS9960_ColorSensor::enableBusRecovery(int8_t sdaPin, int8_t sclPin, uint8_t maxRetries,
+                                             uint16_t maxBackoffMs) {
+    busSdaPin = sdaPin;
+    busSclPin = sclPin;
+    busMaxRetries = maxRetries > 0 ? maxRetries : 1;
+    busMaxBackoffMs = maxBackoffMs > 0 ? maxBackoffMs : 1;
+    busRecoveryEnabled = true;
+}
+
+/**
+ * @brief Stop recovering from failed reads
+ */
+void ADPS9960_ColorSensor::disableBusRecovery() {
+    busRecoveryEnabled = false;
+}
+
+/**
+ * @brief Bring the bus and the sensor back after an error
+ *
+ * Algorithm (per attempt, with a doubling delay between attempts):
+ * 1. Probe ENABLE; on failure record the cause, clear the bus if the pins
+ *    are known and try again
+ * 2. Compare ENABLE, ATIME and gain with the shadow; if the sensor lost
+ *    them (power-on reset), re-initialize it from the shadow
+ * 3. Update the recovery report with the attempts and the duration
+ *
+ * @return true if the sensor responds with the configured exposure
+ */
+bool ADPS9960_ColorSensor::recoverBus() {
+    busRecoveryActive = true;
+    const unsigned long startUs = micros();
+    recoveryReport.busErrors++;
+    recoveryReport.lastError = lastBusError;
+
+    uint16_t backoffMs = 1;
+    uint8_t attempt = 0;
+    bool recovered = false;
+
+    while (!recovered && attempt < busMaxRetries) {
+        if (attempt > 0) {
+            delay(backoffMs);
+            backoffMs = backoffMs >= busMaxBackoffMs / 2 ? busMaxBackoffMs : backoffMs * 2;
+        }
+        attempt++;
+
+        // Step 1: is anyone answering?
+        uint8_t enable, atime, control;
+        if (!readRegister(REG_ENABLE, enable)) {
+            recoveryReport.lastError = lastBusError;
+            if (busSdaPin >= 0 && busSclPin >= 0) {
+                clearBus();
+                recoveryReport.busClears++;
+            }
+            continue;
+        }
+
+        // Step 2: does the sensor still hold our configuration?
+        const bool configured = (enable & (ENABLE_PON | ENABLE_AEN)) == (ENABLE_PON | ENABLE_AEN) &&
+                                readRegister(REG_ATIME, atime) && atime == currentATime &&
+                                readRegister(REG_CONTROL, control) && (control & 0x03) == currentGain;
+        if (!configured) {
+            recoveryReport.reinitializations++;
+            if (!reinitializeSensor()) {
+                recoveryReport.lastError = lastBusError;
+                continue;
+            }
+        }
+        recovered = true;
+    }
+
+    // Step 3: report
+    const uint32_t elapsedUs = micros() - startUs;
+    recoveryReport.lastAttempts = attempt;
+    recoveryReport.lastRecoveryUs = elapsedUs;
+    if (elapsedUs > recoveryReport.maxRecoveryUs) {
+        recoveryReport.maxRecoveryUs = elapsedUs;
+    }
+    if (recovered) {
+        recoveryReport.recoveries++;
+        lastBusError = BUS_OK;
+    } else {
+        recoveryReport.failedRecoveries++;
+    }
+
+    busRecoveryActive = false;
+    return recovered;
+}
+
+/**
+ * @brief Release a bus held low by a slave
+ *
+ * A slave interrupted mid-byte keeps SDA low until it has clocked out its
+ * remaining bits. Up to BUS_CLEAR_PULSES clocks are sent while SDA stays
+ * low, then a STOP condition resets the bus state of every slave. The pins
+ * are driven open-drain style: low as OUTPUT, released as INPUT_PULLUP.
+ *
+ * @return true if SDA and SCL are high afterwards
+ */
+bool ADPS9960_ColorSensor::clearBus() {
+    const uint8_t sda = static_cast<uint8_t>(busSdaPin);
+    const uint8_t scl = static_cast<uint8_t>(busSclPin);
+
+    Wire.end();
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+    delayMicroseconds(BUS_HALF_PERIOD_US);
+
+    // Clock until the slave lets go of SDA
+    for (uint8_t i = 0; i < BUS_CLEAR_PULSES && digitalRead(sda) == LOW; i++) {
+        digitalWrite(scl, LOW);
+        pinMode(scl, OUTPUT);
+        delayMicroseconds(BUS_HALF_PERIOD_US);
+        pinMode(scl, INPUT_PULLUP);
+        delayMicroseconds(BUS_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA rises while SCL is high
+    digitalWrite(sda, LOW);
+    pinMode(sda, OUTPUT);
+    delayMicroseconds(BUS_HALF_PERIOD_US);
+    pinMode(sda, INPUT_PULLUP);
+    delayMicroseconds(BUS_HALF_PERIOD_US);
+
+    const bool released = digitalRead(sda) == HIGH && digitalRead(scl) == HIGH;
+
+#if defined(ESP32)
+    Wire.begin(busSdaPin, busSclPin);
+#else
+    Wire.begin();
+#endif
+    return released;
+}
+
+/**
+ * @brief Re-initialize the sensor and re-apply the register shadow
+ *
+ * currentGain and currentATime mirror what the user configured, so the
+ * white reference measured at that exposure applies again unchanged. The
+ * wait time is re-applied as well.
+ *
+ * @return true if all registers were written
+ */
+bool ADPS9960_ColorSensor::reinitializeSensor() {
+    if (!sensor.init()) {
+        lastBusError = BUS_DRIVER_ERROR;
+        return false;
+    }
+    delay(SENSOR_STARTUP_MS);
+
+    if (!sensor.enableLightSensor(false)) {
+        lastBusError = BUS_DRIVER_ERROR;
+        return false;
+    }
+    trackEnable(ENABLE_PON | ENABLE_AEN); // init() cleared ENABLE, the driver set PON and AEN
+    if (!sensor.setAmbientLightGain(currentGain)) {
+        lastBusError = BUS_DRIVER_ERROR;
+        return false;
+    }
+    return writeRegister(REG_ATIME, currentATime) &&
+           (!waitEnabled || setWaitTime(getWaitTimeUs()));
+}
+
+/**
+ * @brief Record the result of Wire.endTransmission()
+ * @param result Return value of endTransmission() (0 = success)
+ * @return true if the transaction succeeded
+ */
+bool ADPS9960_ColorSensor::recordBusResult(uint8_t result) {
+    lastBusError = result <= BUS_TIMEOUT ? static_cast<BusError>(result) : BUS_ARBITRATION;
+    return result == 0;
+}
+
+/**
+ * @brief Get the cause of the last failed bus transaction
+ * @return BusError (BUS_OK if the last transaction succeeded)
+ */
+ADPS9960_ColorSensor::BusError ADPS9960_ColorSensor::getLastBusError() const {
+    return lastBusError;
+}
+
+/**
+ * @brief Get the bus error and recovery statistics
+ * @return Reference to the report
+ */
+const ADPS9960_ColorSensor::RecoveryReport &ADPS9960_ColorSensor::getRecoveryReport() const {
+    return recoveryReport;
+}
+
+/**
+ * @brief Get human-readable name of a bus error
+ * @param error Error to name
+ * @return String representation of the error
+ */
+const char *ADPS9960_ColorSensor::getBusErrorName(BusError error) {
+    switch (error) {
+        case BUS_OK:
+            return "BUS_OK";
+        case BUS_DATA_TOO_LONG:
+            return "BUS_DATA_TOO_LONG";
+        case BUS_NACK_ADDRESS:
+            return "BUS_NACK_ADDRESS";
+        case BUS_NACK_DATA:
+            return "BUS_NACK_DATA";
+        case BUS_ARBITRATION:
+            return "BUS_ARBITRATION";
+        case BUS_TIMEOUT:
+            return "BUS_TIMEOUT";
+        case BUS_SHORT_READ:
+            return "BUS_SHORT_READ";
+        case BUS_DRIVER_ERROR:
+            return "BUS_DRIVER_ERROR";
+        default:
+            return "UNKNOWN";
+    }
+}
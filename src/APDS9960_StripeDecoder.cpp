@@ -0,0 +1,252 @@
+/**
+ * @file APDS9960_StripeDecoder.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the StripeDecoder class
+ *
+ * Per sample, with class s:
+ *
+ *   s == open band          band grows; a pending change was noise and its
+ *                           samples count against the band's confidence
+ *   s == pending change     the change grows; after switchSamples it closes
+ *                           the band and opens one of class s
+ *   otherwise               s becomes the pending change
+ *
+ * A closed band is kept if it lasted minBandSamples. Two kept bands of the
+ * same class separated only by dropped (too short) bands are merged, so a
+ * glitch inside a band does not split it. A background band of endSamples
+ * completes the sequence. The work per sample is constant: one
+ * normalization, one HSV classification and a few comparisons.
+ */
+
+#include "APDS9960_StripeDecoder.h"
+
+/**
+ * @brief Add to a sample counter, saturating at 65535
+ * @param counter Counter to increase
+ * @param amount Samples to add
+ */
+static void addSamples(uint16_t &counter, uint16_t amount) {
+    counter = counter > 65535U - amount ? 65535U : static_cast<uint16_t>(counter + amount);
+}
+
+/**
+ * @brief Constructor
+ * @param colorSensor Calibrated sensor whose white reference classifies the samples
+ * @param classTolerance Classification tolerance, as for detectColor()
+ */
+StripeDecoder::StripeDecoder(const ADPS9960_ColorSensor &colorSensor, float classTolerance)
+    : sensor(colorSensor),
+      tolerance(classTolerance),
+      background(StandardColor::BLACK),
+      minBandSamples(DEFAULT_MIN_BAND_SAMPLES),
+      switchSamples(DEFAULT_SWITCH_SAMPLES),
+      endSamples(DEFAULT_END_SAMPLES),
+      bandSymbol(StandardColor::BLACK),
+      bandSamples(0),
+      bandAgreeing(0),
+      bandStartUs(0),
+      bandLastUs(0),
+      candidateSymbol(StandardColor::UNKNOWN),
+      candidateSamples(0),
+      candidateStartUs(0),
+      separated(true),
+      building{},
+      completed{} {
+}
+
+/**
+ * @brief Set the segmentation limits
+ * @param minBand Samples a band needs to be kept (minimum 1)
+ * @param switchAfter Consecutive samples of another class that end a band (minimum 1)
+ * @param endAfter Consecutive background samples that end a sequence (minimum 1)
+ */
+void StripeDecoder::setSegmentation(uint8_t minBand, uint8_t switchAfter, uint8_t endAfter) {
+    minBandSamples = minBand > 0 ? minBand : 1;
+    switchSamples = switchAfter > 0 ? switchAfter : 1;
+    endSamples = endAfter > 0 ? endAfter : 1;
+}
+
+/**
+ * @brief Set the class seen between sequences
+ * @param symbol Class that is not a symbol
+ */
+void StripeDecoder::setBackground(StandardColor symbol) {
+    background = symbol;
+    reset();
+}
+
+/**
+ * @brief Feed one sample
+ *
+ * Classifies like detectColor(): the sample is normalized with the
+ * sensor's white reference and corrections, converted to HSV and matched
+ * against the standard colors.
+ *
+ * @param sample Sample from readSample() or a recording
+ * @return true when a sequence was completed
+ */
+bool StripeDecoder::update(const ADPS9960_ColorSensor::ColorSample &sample) {
+    if (!ADPS9960_ColorSensor::isSampleUsable(sample)) {
+        return false;
+    }
+
+    const ADPS9960_ColorSensor::RawColor raw = {sample.ambient, sample.red, sample.green, sample.blue};
+    ADPS9960_ColorSensor::RGB16 rgb;
+    ADPS9960_ColorSensor::HSV hsv;
+    sensor.normalizeRaw(raw, rgb);
+    ADPS9960_ColorSensor::convertToHSV(rgb, hsv);
+    return updateSymbol(ADPS9960_ColorSensor::classifyHSV(hsv, tolerance), sample.timestampUs);
+}
+
+/**
+ * @brief Feed one already classified sample
+ *
+ * Algorithm:
+ * 1. UNKNOWN counts as background
+ * 2. Same class as the open band: extend it, absorbing a pending change
+ * 3. Otherwise extend or replace the pending change; once it lasted
+ *    switchSamples, close the band and open one of the new class
+ * 4. Complete the sequence after endSamples of background
+ *
+ * @param symbol Class of the sample
+ * @param timestampUs Time of the sample
+ * @return true when a sequence was completed
+ */
+bool StripeDecoder::updateSymbol(StandardColor symbol, uint32_t timestampUs) {
+    // Step 1
+    if (symbol == StandardColor::UNKNOWN) {
+        symbol = background;
+    }
+
+    if (symbol == bandSymbol) {
+        // Step 2: the band continues; a pending change was a glitch
+        addSamples(bandSamples, candidateSamples + 1);
+        addSamples(bandAgreeing, 1);
+        candidateSamples = 0;
+        bandLastUs = timestampUs;
+    } else {
+        // Step 3: a change, confirmed after switchSamples
+        if (candidateSamples > 0 && symbol == candidateSymbol) {
+            candidateSamples++;
+        } else {
+            addSamples(bandSamples, candidateSamples);
+            candidateSymbol = symbol;
+            candidateSamples = 1;
+            candidateStartUs = timestampUs;
+        }
+
+        if (candidateSamples >= switchSamples) {
+            closeBand();
+            bandSymbol = candidateSymbol;
+            bandSamples = candidateSamples;
+            bandAgreeing = candidateSamples;
+            bandStartUs = candidateStartUs;
+            bandLastUs = timestampUs;
+            candidateSamples = 0;
+        }
+    }
+
+    // Step 4: a long enough stretch of background ends the sequence
+    if (bandSymbol == background && bandAgreeing >= endSamples && building.length > 0) {
+        return completeSequence();
+    }
+    return false;
+}
+
+/**
+ * @brief End the sequence in progress, e.g. when the part has left
+ * @return true if a sequence with at least one band was completed
+ */
+bool StripeDecoder::flush() {
+    addSamples(bandSamples, candidateSamples);
+    candidateSamples = 0;
+    closeBand();
+    bandSymbol = background;
+    bandSamples = 0;
+    bandAgreeing = 0;
+    return building.length > 0 && completeSequence();
+}
+
+/**
+ * @brief Get the last completed sequence
+ * @return Reference to the sequence
+ */
+const StripeDecoder::Sequence &StripeDecoder::getSequence() const {
+    return completed;
+}
+
+/**
+ * @brief Drop the sequence in progress
+ */
+void StripeDecoder::reset() {
+    bandSymbol = background;
+    bandSamples = 0;
+    bandAgreeing = 0;
+    candidateSamples = 0;
+    separated = true;
+    building = Sequence{};
+}
+
+/**
+ * @brief Close the open band and append it to the sequence if long enough
+ */
+void StripeDecoder::closeBand() {
+    if (bandAgreeing < minBandSamples) {
+        return; // Too short: a glitch, or a band narrower than the sampling allows
+    }
+    if (bandSymbol == background) {
+        separated = true;
+        return;
+    }
+
+    const uint8_t confidence = static_cast<uint8_t>((static_cast<uint32_t>(bandAgreeing) * 255UL) / bandSamples);
+    if (!separated && building.length > 0 && building.bands[building.length - 1].symbol == bandSymbol) {
+        // Same class on both sides of a dropped glitch: one band
+        Band &band = building.bands[building.length - 1];
+        const uint32_t samples = static_cast<uint32_t>(band.samples) + bandSamples;
+        band.confidence = static_cast<uint8_t>((static_cast<uint32_t>(band.confidence) * band.samples +
+                                                static_cast<uint32_t>(confidence) * bandSamples) / samples);
+        band.samples = static_cast<uint16_t>(samples > 65535UL ? 65535UL : samples);
+        band.durationUs = bandLastUs - band.startUs;
+        return;
+    }
+
+    separated = false;
+    if (building.length >= MAX_BANDS) {
+        building.truncated = true;
+        return;
+    }
+    Band &band = building.bands[building.length++];
+    band.symbol = bandSymbol;
+    band.confidence = confidence;
+    band.samples = bandSamples;
+    band.startUs = bandStartUs;
+    band.durationUs = bandLastUs - bandStartUs;
+}
+
+/**
+ * @brief Complete the sequence in progress
+ * @return true if it held at least one band
+ */
+bool StripeDecoder::completeSequence() {
+    if (building.length == 0) {
+        return false;
+    }
+
+    uint8_t weakest = 255;
+    for (uint8_t i = 0; i < building.length; i++) {
+        if (building.bands[i].confidence < weakest) {
+            weakest = building.bands[i].confidence;
+        }
+    }
+    const Band &last = building.bands[building.length - 1];
+    building.confidence = static_cast<float>(weakest) / 255.0f;
+    building.startUs = building.bands[0].startUs;
+    building.durationUs = last.startUs + last.durationUs - building.startUs;
+
+    completed = building;
+    building = Sequence{};
+    separated = true;
+    return true;
+}
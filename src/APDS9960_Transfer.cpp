@@ -0,0 +1,162 @@
+/**
+ * @file APDS9960_Transfer.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Fleet calibration transfer into a canonical device space
+ *
+ * White calibration removes illuminant and gain differences, but the
+ * spectral response of the R/G/B filters still varies from unit to unit,
+ * so a palette trained on one sensor drifts on another. Each unit is
+ * characterized once on a shared set of reference targets:
+ *
+ * 1. Measure every target with measureTransferTarget()
+ * 2. Fit a 3x3 matrix that maps these readings onto the canonical values
+ *    of the same targets (least squares, fitTransferMatrix(), or
+ *    fitTransferCoefficients() on a host)
+ * 3. Enable it with setTransferMatrix() and persist it with exportCalibration()
+ *
+ * The canonical values are usually the readings of a golden unit. With the
+ * transfer enabled every unit reports colors in that space, so one palette,
+ * LUT or classifier serves the whole fleet.
+ *
+ * The matrix is linear (no offset): white-balanced readings are zero in
+ * the dark on every unit, so black already maps onto black.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/**
+ * @brief Measure a reference target for fleet characterization
+ *
+ * Averages white-balanced RGB16 readings without transfer matrix and LUT,
+ * so the result describes the raw behavior of this unit. With oversampling
+ * enabled each reading keeps the 8 fractional bits of its average, as
+ * readRGB16() does, so dark targets are not quantized to whole counts.
+ *
+ * @param measured Reference receiving the averaged reading
+ * @param samples Readings averaged, one per integration period (0 is treated as 1)
+ * @return true if at least one reading succeeded, false otherwise
+ *
+ * @note Calibrate on the white reference first: targets are normalized to it
+ */
+bool ADPS9960_ColorSensor::measureTransferTarget(RGB16 &measured, uint8_t samples) {
+    if (samples == 0) {
+        samples = 1;
+    }
+    ensureCalibrated();
+
+    const unsigned long periodMs = getIntegrationTimeUs() / 1000UL + 1;
+    uint32_t sum[3] = {0, 0, 0};
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < samples; i++) {
+        RawColor raw{};
+        if (readRawData(raw)) {
+            RGB16 rgb{};
+            if (oversampleValid) {
+                normalizeOversampled(rgb); // Keep the sub-count resolution of the average
+            } else {
+                rgb.r = normalizeToRGB16(raw.red, max_red);
+                rgb.g = normalizeToRGB16(raw.green, max_green);
+                rgb.b = normalizeToRGB16(raw.blue, max_blue);
+            }
+            sum[0] += rgb.r;
+            sum[1] += rgb.g;
+            sum[2] += rgb.b;
+            count++;
+        }
+        if (i + 1 < samples && !oversampleValid) {
+            delay(periodMs); // Wait for a fresh integration (oversampled reads wait for AVALID)
+        }
+    }
+
+    if (count == 0) {
+        return false;
+    }
+
+    measured.r = static_cast<uint16_t>(sum[0] / count);
+    measured.g = static_cast<uint16_t>(sum[1] / count);
+    measured.b = static_cast<uint16_t>(sum[2] / count);
+    return true;
+}
+
+/**
+ * @brief Fit a transfer matrix by least squares over reference targets
+ *
+ * Thin wrapper around fitTransferCoefficients() (APDS9960_TransferFit.h),
+ * which holds the fit without any Arduino dependency. RGB16 is three
+ * packed uint16_t, the layout the free function expects.
+ *
+ * @param measured Targets as measured by this unit
+ * @param canonical The same targets in the canonical device space
+ * @param count Number of targets (at least MIN_TRANSFER_TARGETS)
+ * @param matrix Reference receiving the fitted matrix (unchanged on failure)
+ * @return true on success, false otherwise
+ */
+bool ADPS9960_ColorSensor::fitTransferMatrix(const RGB16 *measured, const RGB16 *canonical,
+                                             uint8_t count, TransferMatrix &matrix) {
+    static_assert(sizeof(RGB16) == 3 * sizeof(uint16_t), "RGB16 must be three packed channels");
+    return fitTransferCoefficients(reinterpret_cast<const uint16_t *>(measured),
+                                   reinterpret_cast<const uint16_t *>(canonical), count, matrix.m);
+}
+
+/**
+ * @brief Enable the transfer into the canonical device space
+ * @param matrix Unit transfer matrix (copied)
+ */
+void ADPS9960_ColorSensor::setTransferMatrix(const TransferMatrix &matrix) {
+    transferMatrix = matrix;
+    transferEnabled = true;
+}
+
+/**
+ * @brief Disable the transfer and reset the matrix to identity
+ */
+void ADPS9960_ColorSensor::clearTransferMatrix() {
+    const TransferMatrix identity = {{CHROMA_SCALE, 0, 0, 0, CHROMA_SCALE, 0, 0, 0, CHROMA_SCALE}};
+    transferMatrix = identity;
+    transferEnabled = false;
+}
+
+/**
+ * @brief Check if a transfer matrix is applied
+ * @return true if readings are reported in the canonical device space
+ */
+bool ADPS9960_ColorSensor::hasTransferMatrix() const {
+    return transferEnabled;
+}
+
+/**
+ * @brief Get the current transfer matrix
+ * @return Reference to the matrix (identity if none was set)
+ */
+const ADPS9960_ColorSensor::TransferMatrix &ADPS9960_ColorSensor::getTransferMatrix() const {
+    return transferMatrix;
+}
+
+/**
+ * @brief Apply a transfer matrix to a color
+ *
+ * Each product (|m| <= 2^15, value < 2^16) fits in 32 bits and is reduced
+ * to the 16-bit scale (>> 12, CHROMA_SCALE = 2^12) before summing, so the
+ * sum cannot overflow.
+ *
+ * @param matrix Transfer matrix (Q3.12)
+ * @param rgb Color to transform in place (clamped to 0-65535)
+ */
+void ADPS9960_ColorSensor::applyTransferMatrix(const TransferMatrix &matrix, RGB16 &rgb) {
+    const int32_t in[3] = {rgb.r, rgb.g, rgb.b};
+    int32_t out[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t sum = 0;
+        for (uint8_t j = 0; j < 3; j++) {
+            sum += (static_cast<int32_t>(matrix.m[i * 3 + j]) * in[j] + CHROMA_SCALE / 2) >> 12;
+        }
+        out[i] = sum < 0 ? 0 : (sum > 65535L ? 65535L : sum);
+    }
+
+    rgb.r = static_cast<uint16_t>(out[0]);
+    rgb.g = static_cast<uint16_t>(out[1]);
+    rgb.b = static_cast<uint16_t>(out[2]);
+}
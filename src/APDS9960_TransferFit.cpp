@@ -0,0 +1,97 @@
+/**
+ * @file APDS9960_TransferFit.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the transfer matrix fit
+ *
+ * Solves the normal equations M^T = (X^T X)^-1 X^T Y, where the rows of X
+ * are the measured targets and the rows of Y the canonical ones. Depends
+ * on <math.h> only, so it builds unchanged on a host.
+ */
+
+#include "APDS9960_TransferFit.h"
+#include <math.h>
+
+/// Smallest accepted |det(X^T X)| relative to its scale (targets must span RGB)
+static const float TRANSFER_MIN_DETERMINANT = 1e-6f;
+
+/**
+ * @brief Fit a 3x3 transfer matrix by least squares over reference targets
+ *
+ * Algorithm:
+ * 1. Accumulate X^T X and X^T Y (values scaled to 0-1)
+ * 2. Invert X^T X by cofactors, rejecting near-singular target sets
+ * 3. Multiply, round to Q3.12 and reject coefficients outside int16_t
+ *
+ * @param measured Targets as measured by the unit, count x {r, g, b}
+ * @param canonical The same targets in the canonical device space
+ * @param count Number of targets (at least TRANSFER_FIT_MIN_TARGETS)
+ * @param coefficients Array of 9 receiving the row-major matrix (unchanged on failure)
+ * @return true on success, false otherwise
+ *
+ * @note Use targets that span the gamut (white, gray, primaries,
+ *       secondaries); three grays alone are degenerate
+ */
+bool fitTransferCoefficients(const uint16_t *measured, const uint16_t *canonical,
+                             uint8_t count, int16_t coefficients[9]) {
+    if (measured == nullptr || canonical == nullptr || coefficients == nullptr ||
+        count < TRANSFER_FIT_MIN_TARGETS) {
+        return false;
+    }
+
+    // Step 1: normal equations
+    float xtx[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    float xty[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    for (uint8_t n = 0; n < count; n++) {
+        const uint16_t *xn = measured + n * 3;
+        const uint16_t *yn = canonical + n * 3;
+        const float x[3] = {xn[0] / 65535.0f, xn[1] / 65535.0f, xn[2] / 65535.0f};
+        const float y[3] = {yn[0] / 65535.0f, yn[1] / 65535.0f, yn[2] / 65535.0f};
+        for (uint8_t i = 0; i < 3; i++) {
+            for (uint8_t j = 0; j < 3; j++) {
+                xtx[i][j] += x[i] * x[j];
+                xty[i][j] += x[i] * y[j];
+            }
+        }
+    }
+
+    // Step 2: inverse of the symmetric 3x3 matrix by cofactors
+    float inv[3][3];
+    inv[0][0] = xtx[1][1] * xtx[2][2] - xtx[1][2] * xtx[2][1];
+    inv[0][1] = xtx[0][2] * xtx[2][1] - xtx[0][1] * xtx[2][2];
+    inv[0][2] = xtx[0][1] * xtx[1][2] - xtx[0][2] * xtx[1][1];
+    inv[1][0] = xtx[1][2] * xtx[2][0] - xtx[1][0] * xtx[2][2];
+    inv[1][1] = xtx[0][0] * xtx[2][2] - xtx[0][2] * xtx[2][0];
+    inv[1][2] = xtx[0][2] * xtx[1][0] - xtx[0][0] * xtx[1][2];
+    inv[2][0] = xtx[1][0] * xtx[2][1] - xtx[1][1] * xtx[2][0];
+    inv[2][1] = xtx[0][1] * xtx[2][0] - xtx[0][0] * xtx[2][1];
+    inv[2][2] = xtx[0][0] * xtx[1][1] - xtx[0][1] * xtx[1][0];
+
+    const float det = xtx[0][0] * inv[0][0] + xtx[0][1] * inv[1][0] + xtx[0][2] * inv[2][0];
+    const float trace = xtx[0][0] + xtx[1][1] + xtx[2][2];
+    if (!(fabsf(det) > TRANSFER_MIN_DETERMINANT * trace * trace * trace)) {
+        return false;
+    }
+
+    // Step 3: M[i][j] = sum_k inv[j][k] * xty[k][i] (M^T = inv * X^T Y)
+    int16_t fitted[9];
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            float value = 0.0f;
+            for (uint8_t k = 0; k < 3; k++) {
+                value += inv[j][k] * xty[k][i];
+            }
+            value = value / det * TRANSFER_FIT_SCALE;
+
+            if (value > 32767.0f || value < -32768.0f) {
+                return false;
+            }
+            fitted[i * 3 + j] = static_cast<int16_t>(value < 0.0f ? value - 0.5f : value + 0.5f);
+        }
+    }
+
+    for (uint8_t i = 0; i < 9; i++) {
+        coefficients[i] = fitted[i];
+    }
+    return true;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file APDS9960_WhiteBalance.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Continuous white-balance adaptation for the APDS9960_ColorSensor class
+ *
+ * After calibrate() the white point slowly drifts as lamps age or the
+ * ambient light changes. Adaptive white balance follows that drift from
+ * the normal sample stream, without interrupting the line:
+ *
+ * - Only bright, near-neutral, unsaturated samples are used: they are
+ *   most likely white or gray surfaces lit by the current illuminant.
+ * - Color balance (gray world on neutral samples): each such sample
+ *   implies a white reference raw_channel * max_clear / raw_clear for
+ *   R, G and B, which is tracked with an exponential moving average.
+ * - Brightness (white patch): the clear reference tracks a high
+ *   percentile (~94th) of the accepted samples, so it follows the
+ *   brightest neutral surfaces rather than the average gray.
+ * - Every update is bounded to a small fraction of the reference, so a
+ *   single outlier cannot move the calibration noticeably.
+ *
+ * Each update is O(1) and uses integer arithmetic only.
+ */
+
+#include "APDS9960_ColorSensor.h"
+
+/// Samples darker than 1/2^shift of the white reference are ignored
+static const uint8_t WB_MIN_INTENSITY_SHIFT = 1;
+
+/// Largest white-balanced channel spread accepted as neutral, 1/2^shift of the mean
+static const uint8_t WB_NEUTRAL_SPREAD_SHIFT = 3;
+
+/// Percentile tracker: downward steps are 2^shift times smaller than upward ones
+static const uint8_t WB_PERCENTILE_SHIFT = 4;
+
+/**
+ * @brief Enable or disable continuous white-balance adaptation
+ *
+ * Enabling re-seeds the filter from the active white reference, so
+ * adaptation starts from the current calibration.
+ *
+ * @param enable true to track the white point from the sample stream
+ */
+void ADPS9960_ColorSensor::enableAdaptiveWhiteBalance(bool enable) {
+    whiteBalanceAdaptive = enable;
+    resetWhiteBalanceTracking();
+}
+
+/**
+ * @brief Configure the speed of white-balance adaptation
+ *
+ * With the default shift of 8 the reference moves 1/256 of the way to each
+ * accepted sample, i.e. a time constant of about 256 neutral samples.
+ *
+ * @param timeConstantShift EMA weight 1/2^shift (clamped to 1-16)
+ * @param maxStepShift Largest change per sample, 1/2^shift of the reference
+ *                     (clamped to 1-16)
+ */
+void ADPS9960_ColorSensor::setWhiteBalanceAdaptation(uint8_t timeConstantShift,
+                                                     uint8_t maxStepShift) {
+    if (timeConstantShift < 1) timeConstantShift = 1;
+    if (timeConstantShift > 16) timeConstantShift = 16;
+    if (maxStepShift < 1) maxStepShift = 1;
+    if (maxStepShift > 16) maxStepShift = 16;
+
+    wbTimeConstantShift = timeConstantShift;
+    wbMaxStepShift = maxStepShift;
+}
+
+/**
+ * @brief Freeze or resume white-balance adaptation
+ * @param frozen true to hold the current white reference
+ */
+void ADPS9960_ColorSensor::freezeWhiteBalance(bool frozen) {
+    whiteBalanceFrozen = frozen;
+}
+
+/**
+ * @brief Check if adaptive white balance is enabled and not frozen
+ * @return true if samples currently update the white reference
+ */
+bool ADPS9960_ColorSensor::isWhiteBalanceAdapting() const {
+    return whiteBalanceAdaptive && !whiteBalanceFrozen;
+}
+
+/**
+ * @brief Re-seed the white-balance filter from the active white reference
+ *
+ * Called whenever the reference changes for another reason (calibration,
+ * gain or ATIME change), so the filter never pulls back to a stale value.
+ */
+void ADPS9960_ColorSensor::resetWhiteBalanceTracking() {
+    wbState[0] = static_cast<uint32_t>(max_ambient) << 8;
+    wbState[1] = static_cast<uint32_t>(max_red) << 8;
+    wbState[2] = static_cast<uint32_t>(max_green) << 8;
+    wbState[3] = static_cast<uint32_t>(max_blue) << 8;
+}
+
+/**
+ * @brief Move a filter state toward a target by a bounded step
+ * @param state Filter state (Q24.8)
+ * @param step Signed step (Q24.8) before bounding
+ * @param maxStepShift Step bound, 1/2^shift of the state
+ */
+static void applyBoundedStep(uint32_t &state, int32_t step, uint8_t maxStepShift) {
+    int32_t bound = static_cast<int32_t>(state >> maxStepShift);
+    if (bound < 1) bound = 1;
+
+    if (step > bound) step = bound;
+    if (step < -bound) step = -bound;
+
+    const int32_t next = static_cast<int32_t>(state) + step;
+    state = next < 256 ? 256 : static_cast<uint32_t>(next); // Never below 1 count
+}
+
+/**
+ * @brief Update the white reference from one sample
+ *
+ * Algorithm:
+ * 1. Reject samples when not calibrated, too dark or saturated
+ * 2. Reject samples whose white-balanced channels spread more than 1/8
+ *    of their mean (not neutral)
+ * 3. R/G/B: EMA toward raw_channel * max_clear / raw_clear, bounded step
+ * 4. Clear: asymmetric percentile step toward raw_clear, bounded step
+ * 5. Publish the filtered values as active and reference white; the
+ *    reference no longer matches a stored profile
+ *
+ * @param raw Freshly read sample
+ */
+void ADPS9960_ColorSensor::adaptWhiteBalance(const RawColor &raw) {
+    // Step 1: usable sample?
+    if (calibrationStatus == NOT_CALIBRATED || max_ambient == 0 ||
+        max_red == 0 || max_green == 0 || max_blue == 0) {
+        return;
+    }
+    if ((static_cast<uint32_t>(raw.ambient) << WB_MIN_INTENSITY_SHIFT) < max_ambient) {
+        return;
+    }
+    const uint16_t saturation = getSaturationLevel();
+    if (raw.ambient >= saturation || raw.red >= saturation ||
+        raw.green >= saturation || raw.blue >= saturation) {
+        return;
+    }
+
+    // Step 2: neutral test on white-balanced channels (each < 2^28)
+    const uint32_t wr = (static_cast<uint32_t>(raw.red) * CHROMA_SCALE) / max_red;
+    const uint32_t wg = (static_cast<uint32_t>(raw.green) * CHROMA_SCALE) / max_green;
+    const uint32_t wb = (static_cast<uint32_t>(raw.blue) * CHROMA_SCALE) / max_blue;
+
+    uint32_t maxw = wr, minw = wr;
+    if (wg > maxw) maxw = wg;
+    if (wb > maxw) maxw = wb;
+    if (wg < minw) minw = wg;
+    if (wb < minw) minw = wb;
+
+    const uint32_t mean = (wr + wg + wb) / 3;
+    if (maxw - minw > (mean >> WB_NEUTRAL_SPREAD_SHIFT)) {
+        return;
+    }
+
+    // Step 3: chromatic balance, implied white = raw * max_clear / raw_clear
+    const uint16_t channels[3] = {raw.red, raw.green, raw.blue};
+    for (uint8_t i = 0; i < 3; i++) {
+        uint32_t target = (static_cast<uint32_t>(channels[i]) * max_ambient) / raw.ambient;
+        if (target > 65535UL) target = 65535UL;
+
+        const int32_t error = static_cast<int32_t>(target << 8) - static_cast<int32_t>(wbState[i + 1]);
+        applyBoundedStep(wbState[i + 1], error / (1L << wbTimeConstantShift), wbMaxStepShift);
+    }
+
+    // Step 4: clear reference tracks a high percentile of neutral samples
+    const uint32_t clearTarget = static_cast<uint32_t>(raw.ambient) << 8;
+    const int32_t clearStep = static_cast<int32_t>(wbState[0] >> wbTimeConstantShift) + 1;
+    if (clearTarget > wbState[0]) {
+        applyBoundedStep(wbState[0], clearStep, wbMaxStepShift);
+    } else if (clearTarget < wbState[0]) {
+        applyBoundedStep(wbState[0], -(clearStep >> WB_PERCENTILE_SHIFT) - 1, wbMaxStepShift);
+    }
+
+    // Step 5: publish (reference is now expressed at the current exposure)
+    const uint32_t maxCount = 65535UL << 8;
+    max_ambient = static_cast<uint16_t>((wbState[0] > maxCount ? maxCount : wbState[0]) >> 8);
+    max_red = static_cast<uint16_t>((wbState[1] > maxCount ? maxCount : wbState[1]) >> 8);
+    max_green = static_cast<uint16_t>((wbState[2] > maxCount ? maxCount : wbState[2]) >> 8);
+    max_blue = static_cast<uint16_t>((wbState[3] > maxCount ? maxCount : wbState[3]) >> 8);
+
+    calibration.maxAmbient = max_ambient;
+    calibration.maxRed = max_red;
+    calibration.maxGreen = max_green;
+    calibration.maxBlue = max_blue;
+    calibration.gain = currentGain;
+    calibration.atime = currentATime;
+    activeProfile = -1;
+}
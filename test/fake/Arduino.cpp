@@ -0,0 +1,43 @@
+/**
+ * @file Arduino.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the Arduino core: virtual time and pins
+ */
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "FakeBus.h"
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+unsigned long millis() {
+    return static_cast<uint32_t>(fake::bus().now() / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<uint32_t>(fake::bus().now());
+}
+
+void delay(unsigned long ms) {
+    fake::bus().advance(static_cast<uint64_t>(ms) * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    fake::bus().advance(us);
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    fake::bus().pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t, uint8_t) {
+}
+
+int digitalRead(uint8_t pin) {
+    return fake::bus().digitalRead(pin);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file Arduino.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the Arduino core used by the library tests
+ *
+ * Provides the subset of the Arduino API the library and the examples use.
+ * Time is virtual: delay() and delayMicroseconds() advance the clock of the
+ * fake bus instead of sleeping, so a test of several minutes of sensor time
+ * runs in milliseconds. micros() and millis() wrap at 32 bits as on the
+ * microcontrollers the library targets.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_ARDUINO_H
+#define MANIGLIO_APDS_LIBRARY_TEST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t *>(address))
+#define pgm_read_dword(address) (*reinterpret_cast<const uint32_t *>(address))
+#define pgm_read_float(address) (*reinterpret_cast<const float *>(address))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+/**
+ * @class String
+ * @brief Minimal Arduino String (construction and access only)
+ */
+class String {
+public:
+    String(const char *value = "") : text(value != nullptr ? value : "") {}
+
+    const char *c_str() const { return text.c_str(); }
+
+    unsigned int length() const { return static_cast<unsigned int>(text.size()); }
+
+    bool operator==(const char *other) const { return text == other; }
+
+private:
+    std::string text;
+};
+
+/**
+ * @class HardwareSerial
+ * @brief Serial port that discards output (examples only need it to compile)
+ */
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+
+    template<typename T>
+    size_t print(const T &, int = DEC) { return 0; }
+
+    template<typename T>
+    size_t println(const T &, int = DEC) { return 0; }
+
+    size_t println() { return 0; }
+
+    int available() { return 0; }
+
+    int read() { return -1; }
+
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_ARDUINO_H
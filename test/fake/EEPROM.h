@@ -0,0 +1,47 @@
+/**
+ * @file EEPROM.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the Arduino EEPROM library (RAM backed)
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_EEPROM_H
+#define MANIGLIO_APDS_LIBRARY_TEST_EEPROM_H
+
+#include <Arduino.h>
+
+/**
+ * @class EEPROMClass
+ * @brief 4 KB of emulated EEPROM with the get()/put() interface
+ */
+class EEPROMClass {
+public:
+    static const size_t SIZE = 4096; ///< Emulated capacity in bytes
+
+    void begin(size_t) {}
+
+    bool commit() { return true; }
+
+    template<typename T>
+    T &get(int address, T &value) {
+        if (address >= 0 && static_cast<size_t>(address) + sizeof(T) <= SIZE) {
+            memcpy(&value, data + address, sizeof(T));
+        }
+        return value;
+    }
+
+    template<typename T>
+    const T &put(int address, const T &value) {
+        if (address >= 0 && static_cast<size_t>(address) + sizeof(T) <= SIZE) {
+            memcpy(data + address, &value, sizeof(T));
+        }
+        return value;
+    }
+
+private:
+    uint8_t data[SIZE] = {};
+};
+
+extern EEPROMClass EEPROM;
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_EEPROM_H
@@ -0,0 +1,482 @@
+/**
+ * @file FakeBus.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Implementation of the simulated APDS9960 sensors and I2C bus
+ *
+ * The state machine is evaluated lazily: every register access first
+ * brings the sensor up to the current virtual time, latching the last
+ * integration that completed since the previous access. Cycles nobody
+ * looked at are skipped in one step, so hours of virtual time cost nothing.
+ */
+
+#include "FakeBus.h"
+#include <Arduino.h>
+#include <math.h>
+
+namespace fake {
+
+/// Full-scale count added per integration cycle
+static const uint32_t COUNTS_PER_CYCLE = 1025;
+
+/// Samples of a time-varying ambient level per microsecond of integration
+static const uint64_t LEVEL_SAMPLE_US = 50;
+
+/// Value of the ID register
+static const uint8_t DEVICE_ID = 0xAB;
+
+Bus &bus() {
+    static Bus instance;
+    return instance;
+}
+
+// ---------------------------------------------------------------- Sensor
+
+Sensor::Sensor()
+    : ambient{800.0, 300.0, 250.0, 200.0},
+      led{0.0, 0.0, 0.0, 0.0},
+      gainFactor{{1, 1, 1, 1}, {4, 4, 4, 4}, {16, 16, 16, 16}, {64, 64, 64, 64}},
+      noiseCounts(0.0),
+      registers{},
+      running(false),
+      cycleStartUs(0),
+      cycleWaitUs(0),
+      cycleIntegrationUs(0),
+      cycleGain(0),
+      integrations(0),
+      lastEndUs(0),
+      lastLedShare(0.0),
+      lastAmbientLevel(0.0),
+      latchedHigh(0),
+      ambientLevel(nullptr),
+      ambientContext(nullptr),
+      ledOnNow(false),
+      noiseState(0x2545F491u) {
+    powerOnReset();
+}
+
+void Sensor::setAmbientLevel(LevelFunction function, void *context) {
+    update();
+    ambientLevel = function;
+    ambientContext = context;
+}
+
+void Sensor::setLed(bool on) {
+    if (on == ledOnNow) {
+        return;
+    }
+    update();
+    ledOnNow = on;
+    ledToggles.push_back(bus().now());
+}
+
+void Sensor::powerOnReset() {
+    for (uint16_t i = 0; i < 256; i++) {
+        registers[i] = 0;
+    }
+    registers[ATIME] = 0xFF;
+    registers[WTIME] = 0xFF;
+    registers[CONFIG1] = 0x40;
+    registers[ID] = DEVICE_ID;
+    running = false;
+    integrations = 0;
+}
+
+uint8_t Sensor::readRegister(uint8_t reg) {
+    update();
+    if (reg >= CDATAL && reg <= BDATAH) {
+        registers[STATUS] &= static_cast<uint8_t>(~AVALID);
+        if (((reg - CDATAL) & 1) == 0) {
+            latchedHigh = registers[reg + 1]; // Reading the low byte latches the high byte
+            return registers[reg];
+        }
+        return latchedHigh;
+    }
+    return registers[reg];
+}
+
+void Sensor::writeRegister(uint8_t reg, uint8_t value) {
+    update();
+    if (reg == STATUS || reg == ID || (reg >= CDATAL && reg <= BDATAH)) {
+        return; // Read-only
+    }
+    registers[reg] = value;
+
+    if (reg == ENABLE) {
+        const bool wasRunning = running;
+        running = (value & PON) && (value & AEN);
+        if (running && !wasRunning) {
+            registers[STATUS] &= static_cast<uint8_t>(~AVALID);
+            startCycle(bus().now());
+        }
+    }
+}
+
+void Sensor::command(uint8_t reg) {
+    update();
+    if (reg == CICLEAR || reg == AICLEAR) {
+        registers[STATUS] &= static_cast<uint8_t>(~CPSAT);
+    }
+}
+
+uint8_t Sensor::peek(uint8_t reg) {
+    update();
+    return registers[reg];
+}
+
+uint32_t Sensor::getIntegrationCount() {
+    update();
+    return integrations;
+}
+
+uint64_t Sensor::getLastIntegrationEndUs() {
+    update();
+    return lastEndUs;
+}
+
+double Sensor::getLastLedShare() {
+    update();
+    return lastLedShare;
+}
+
+double Sensor::getLastAmbientLevel() {
+    update();
+    return lastAmbientLevel;
+}
+
+bool Sensor::isIntegrating() {
+    return running;
+}
+
+uint64_t Sensor::getIntegrationUs() {
+    return (256ULL - registers[ATIME]) * CYCLE_US;
+}
+
+uint64_t Sensor::getWaitUs() {
+    if (!(registers[ENABLE] & WEN)) {
+        return 0;
+    }
+    const uint64_t waitUs = (256ULL - registers[WTIME]) * CYCLE_US;
+    return (registers[CONFIG1] & WLONG) ? 12 * waitUs : waitUs;
+}
+
+/**
+ * Latch every integration that ended before now. After the first one the
+ * configuration is fixed (writes call update() first), so the cycles in
+ * between are counted without being evaluated.
+ */
+void Sensor::update() {
+    if (!running) {
+        return;
+    }
+    const uint64_t now = bus().now();
+    while (cycleStartUs + cycleWaitUs + cycleIntegrationUs <= now) {
+        const uint64_t endUs = cycleStartUs + cycleWaitUs + cycleIntegrationUs;
+        latch(endUs);
+        startCycle(endUs);
+
+        // Only the newest of the following completed integrations is observable
+        const uint64_t period = cycleWaitUs + cycleIntegrationUs;
+        const uint64_t completed = (now - cycleStartUs) / period;
+        if (completed > 1) {
+            integrations += static_cast<uint32_t>(completed - 1);
+            cycleStartUs += (completed - 1) * period;
+        }
+    }
+}
+
+void Sensor::startCycle(uint64_t startUs) {
+    cycleStartUs = startUs;
+    cycleIntegrationUs = getIntegrationUs();
+    cycleWaitUs = getWaitUs();
+    cycleGain = registers[CONTROL] & 0x03;
+}
+
+void Sensor::latch(uint64_t endUs) {
+    const uint64_t startUs = endUs - cycleIntegrationUs;
+    const double cycles = static_cast<double>(cycleIntegrationUs / CYCLE_US);
+    double fullScale = cycles * COUNTS_PER_CYCLE;
+    if (fullScale > 65535.0) {
+        fullScale = 65535.0;
+    }
+
+    lastLedShare = ledShare(startUs, endUs);
+    lastAmbientLevel = meanAmbientLevel(startUs, endUs);
+    const double base[4] = {ambient.clear * lastAmbientLevel + led.clear * lastLedShare,
+                            ambient.red * lastAmbientLevel + led.red * lastLedShare,
+                            ambient.green * lastAmbientLevel + led.green * lastLedShare,
+                            ambient.blue * lastAmbientLevel + led.blue * lastLedShare};
+
+    for (uint8_t channel = 0; channel < 4; channel++) {
+        double counts = base[channel] * gainFactor[cycleGain][channel] / 4.0 *
+                        cycles / static_cast<double>(REFERENCE_CYCLES);
+        if (noiseCounts > 0.0) {
+            counts += noise();
+        }
+        if (channel == 0 && counts >= fullScale) {
+            registers[STATUS] |= CPSAT;
+        }
+        counts = floor(counts + 0.5);
+        if (counts < 0.0) counts = 0.0;
+        if (counts > fullScale) counts = fullScale;
+
+        const uint16_t value = static_cast<uint16_t>(counts);
+        registers[CDATAL + 2 * channel] = static_cast<uint8_t>(value & 0xFF);
+        registers[CDATAL + 2 * channel + 1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    registers[STATUS] |= AVALID;
+    integrations++;
+    lastEndUs = endUs;
+}
+
+double Sensor::ledShare(uint64_t fromUs, uint64_t toUs) const {
+    // The LED starts off; every entry of ledToggles flips it
+    bool on = false;
+    uint64_t onUs = 0;
+    uint64_t cursor = fromUs;
+    for (size_t i = 0; i < ledToggles.size(); i++) {
+        const uint64_t t = ledToggles[i];
+        if (t <= fromUs) {
+            on = !on;
+            continue;
+        }
+        if (t >= toUs) {
+            break;
+        }
+        if (on) {
+            onUs += t - cursor;
+        }
+        cursor = t;
+        on = !on;
+    }
+    if (on) {
+        onUs += toUs - cursor;
+    }
+    return toUs > fromUs ? static_cast<double>(onUs) / static_cast<double>(toUs - fromUs) : 0.0;
+}
+
+double Sensor::meanAmbientLevel(uint64_t fromUs, uint64_t toUs) const {
+    if (ambientLevel == nullptr) {
+        return 1.0;
+    }
+    uint64_t samples = (toUs - fromUs) / LEVEL_SAMPLE_US;
+    if (samples < 32) {
+        samples = 32;
+    }
+    const double step = static_cast<double>(toUs - fromUs) / static_cast<double>(samples);
+    double sum = 0.0;
+    for (uint64_t i = 0; i < samples; i++) {
+        sum += ambientLevel(fromUs + static_cast<uint64_t>((static_cast<double>(i) + 0.5) * step), ambientContext);
+    }
+    return sum / static_cast<double>(samples);
+}
+
+/**
+ * Gaussian noise (Box-Muller on a xorshift32 generator): deterministic per
+ * sensor, so every test run sees the same sequence.
+ */
+double Sensor::noise() {
+    uint32_t x = noiseState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    const double u1 = (static_cast<double>(x) + 1.0) / 4294967297.0;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    const double u2 = static_cast<double>(x) / 4294967296.0;
+    noiseState = x;
+    return noiseCounts * sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+// ---------------------------------------------------------------- Bus
+
+Bus::Bus() {
+    reset();
+}
+
+void Bus::reset() {
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        sensors[i] = Sensor();
+        pointer[i] = 0;
+    }
+    sensorCount = 1;
+    selected = 0;
+    clockUs = 0;
+    byteUs = 90;
+    transactions = 0;
+    bytes = 0;
+    failed = 0;
+    failSkip = 0;
+    failCount = 0;
+    failCode = 2;
+    sdaPulsesNeeded = 0;
+    sclPulses = 0;
+    sdaPin = 21;
+    sclPin = 22;
+}
+
+void Bus::setSensorCount(uint8_t count) {
+    sensorCount = count < 1 ? 1 : (count > MAX_SENSORS ? MAX_SENSORS : count);
+}
+
+uint8_t Bus::getSensorCount() const {
+    return sensorCount;
+}
+
+Sensor &Bus::sensor(uint8_t channel) {
+    return sensors[channel < MAX_SENSORS ? channel : 0];
+}
+
+void Bus::selectChannel(uint8_t channel) {
+    selected = channel;
+}
+
+uint64_t Bus::now() const {
+    return clockUs;
+}
+
+void Bus::advance(uint64_t us) {
+    clockUs += us;
+}
+
+void Bus::failTransactions(uint32_t skip, uint32_t count, uint8_t code) {
+    failSkip = skip;
+    failCount = count;
+    failCode = code;
+}
+
+void Bus::holdSda(uint8_t pulses) {
+    sdaPulsesNeeded = pulses;
+}
+
+void Bus::brownOut() {
+    for (uint8_t i = 0; i < sensorCount; i++) {
+        sensors[i].powerOnReset();
+    }
+}
+
+uint32_t Bus::getTransactionCount() const {
+    return transactions;
+}
+
+uint32_t Bus::getByteCount() const {
+    return bytes;
+}
+
+uint32_t Bus::getFailedCount() const {
+    return failed;
+}
+
+uint32_t Bus::getSclPulses() const {
+    return sclPulses;
+}
+
+bool Bus::isSdaHeld() const {
+    return sdaPulsesNeeded > 0;
+}
+
+uint8_t Bus::injectedFault() {
+    if (sdaPulsesNeeded > 0) {
+        return 4;
+    }
+    if (failCount > 0) {
+        if (failSkip > 0) {
+            failSkip--;
+            return 0;
+        }
+        failCount--;
+        return failCode;
+    }
+    return 0;
+}
+
+Sensor *Bus::target(uint8_t address) {
+    if (address != SENSOR_ADDRESS || selected >= sensorCount) {
+        return nullptr;
+    }
+    return &sensors[selected];
+}
+
+uint8_t Bus::transmit(uint8_t address, const uint8_t *data, uint8_t length) {
+    transactions++;
+    clockUs += byteUs; // Address byte
+    bytes++;
+    const uint8_t fault = injectedFault();
+    if (fault != 0) {
+        failed++;
+        return fault;
+    }
+
+    if (address == MUX_ADDRESS) {
+        clockUs += static_cast<uint64_t>(length) * byteUs;
+        bytes += length;
+        if (length > 0) {
+            selected = MAX_SENSORS;
+            for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+                if (data[length - 1] & (1 << i)) {
+                    selected = i;
+                    break;
+                }
+            }
+        }
+        return 0;
+    }
+
+    Sensor *device = target(address);
+    if (device == nullptr) {
+        failed++;
+        return 2;
+    }
+    if (length == 0) {
+        return 0; // Address probe
+    }
+
+    clockUs += byteUs;
+    bytes++;
+    pointer[selected] = data[0];
+    if (length == 1 && data[0] >= 0xE4) {
+        device->command(data[0]);
+    }
+    for (uint8_t i = 1; i < length; i++) {
+        clockUs += byteUs;
+        bytes++;
+        device->writeRegister(pointer[selected]++, data[i]);
+    }
+    return 0;
+}
+
+uint8_t Bus::receive(uint8_t address, uint8_t *data, uint8_t length) {
+    transactions++;
+    clockUs += byteUs; // Address byte
+    bytes++;
+    const uint8_t fault = injectedFault();
+    Sensor *device = target(address);
+    if (fault != 0 || device == nullptr) {
+        failed++;
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        clockUs += byteUs;
+        bytes++;
+        data[i] = device->readRegister(pointer[selected]++);
+    }
+    return length;
+}
+
+void Bus::pinMode(uint8_t pin, uint8_t mode) {
+    if (pin == sclPin && mode == OUTPUT) {
+        sclPulses++;
+        if (sdaPulsesNeeded > 0) {
+            sdaPulsesNeeded--;
+        }
+    }
+}
+
+int Bus::digitalRead(uint8_t pin) const {
+    return (pin == sdaPin && sdaPulsesNeeded > 0) ? LOW : HIGH;
+}
+
+} // namespace fake
@@ -0,0 +1,252 @@
+/**
+ * @file FakeBus.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Simulated APDS9960 sensors on a simulated I2C bus, for host tests
+ *
+ * The model follows the datasheet closely where the library depends on it:
+ *
+ * - ENABLE: nothing runs without PON and AEN. Each ALS cycle is the wait
+ *   state (if WEN is set, (256 - WTIME) x 2.78 ms, x12 with WLONG) followed
+ *   by the integration ((256 - ATIME) x 2.78 ms). ATIME, WTIME and the gain
+ *   written during a cycle apply from the next one. Asserting AEN starts a
+ *   new cycle.
+ * - The color data registers latch at the end of every integration; AVALID
+ *   is set then and cleared by asserting AEN or by reading a data register.
+ *   CPSAT is set when the clear channel reaches full scale and cleared by
+ *   the CICLEAR command.
+ * - Counts are the light integrated over the actual integration window:
+ *   ambient light (optionally time varying, e.g. mains flicker), an
+ *   illumination LED switched by the test, per-gain per-channel gain
+ *   factors, optional noise, clipped at min(65535, 1025 x cycles).
+ * - A power-on reset (brown-out) restores the register defaults.
+ *
+ * The bus charges 9 clocks per byte to the virtual clock, routes address
+ * 0x39 to the sensor on the selected channel of a TCA9548A multiplexer at
+ * 0x70, and injects faults: failing transactions with a chosen Wire error
+ * code, and an SDA line held low until enough SCL pulses arrive on the
+ * recovery pins.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_FAKEBUS_H
+#define MANIGLIO_APDS_LIBRARY_TEST_FAKEBUS_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace fake {
+
+/// Length of one ALS integration cycle
+static const uint32_t CYCLE_US = 2780;
+
+/// Integration cycles of the reference exposure used for Light values (ATIME 219)
+static const uint32_t REFERENCE_CYCLES = 37;
+
+/// Sensor I2C address
+static const uint8_t SENSOR_ADDRESS = 0x39;
+
+/// TCA9548A multiplexer address
+static const uint8_t MUX_ADDRESS = 0x70;
+
+/**
+ * @struct Light
+ * @brief Light on the four photodiodes, in counts at AGAIN 4x and ATIME 219
+ */
+struct Light {
+    double clear;
+    double red;
+    double green;
+    double blue;
+};
+
+/**
+ * @brief Time-varying ambient level
+ * @param us Virtual time in microseconds
+ * @param context Pointer given to Sensor::setAmbientLevel()
+ * @return Multiplier of Sensor::ambient at that instant
+ */
+typedef double (*LevelFunction)(uint64_t us, void *context);
+
+/**
+ * @class Sensor
+ * @brief One simulated APDS9960 (registers, ALS state machine and optics)
+ */
+class Sensor {
+public:
+    // Registers
+    static const uint8_t ENABLE = 0x80;
+    static const uint8_t ATIME = 0x81;
+    static const uint8_t WTIME = 0x83;
+    static const uint8_t CONFIG1 = 0x8D;
+    static const uint8_t CONTROL = 0x8F;
+    static const uint8_t ID = 0x92;
+    static const uint8_t STATUS = 0x93;
+    static const uint8_t CDATAL = 0x94;
+    static const uint8_t BDATAH = 0x9B;
+    static const uint8_t CICLEAR = 0xE6;
+    static const uint8_t AICLEAR = 0xE7;
+
+    // Bits
+    static const uint8_t PON = 0x01;
+    static const uint8_t AEN = 0x02;
+    static const uint8_t WEN = 0x08;
+    static const uint8_t WLONG = 0x02;
+    static const uint8_t AVALID = 0x01;
+    static const uint8_t CPSAT = 0x80;
+
+    Sensor();
+
+    // Optics
+    Light ambient;               ///< Ambient light (multiplied by the ambient level)
+    Light led;                   ///< Light added while the LED is on
+    double gainFactor[4][4];     ///< [AGAIN][channel] sensitivity relative to 1x (nominal 1, 4, 16, 64)
+    double noiseCounts;          ///< Standard deviation of the count noise (0 = none)
+
+    /**
+     * @brief Make the ambient light vary over time
+     * @param function Level function (nullptr: constant 1)
+     * @param context Pointer handed back to the function
+     */
+    void setAmbientLevel(LevelFunction function, void *context = nullptr);
+
+    /**
+     * @brief Switch the illumination LED now
+     * @param on New LED state
+     */
+    void setLed(bool on);
+
+    /**
+     * @brief Reset every register to its power-on value (brown-out)
+     */
+    void powerOnReset();
+
+    // Bus side
+    uint8_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint8_t value);
+    void command(uint8_t reg);
+
+    // Inspection (no side effects)
+    uint8_t peek(uint8_t reg);
+    uint32_t getIntegrationCount();          ///< Integrations completed since power-on
+    uint64_t getLastIntegrationEndUs();      ///< Virtual time the data registers last latched
+    double getLastLedShare();                ///< Share of the last integration the LED was on
+    double getLastAmbientLevel();            ///< Mean ambient level over the last integration
+    bool isIntegrating();                    ///< PON and AEN set
+    uint64_t getIntegrationUs();             ///< Integration time of the running configuration
+    uint64_t getWaitUs();                    ///< Wait time of the running configuration (0 without WEN)
+
+private:
+    uint8_t registers[256];
+    bool running;                 ///< PON and AEN
+    uint64_t cycleStartUs;        ///< Start of the current cycle (wait state first)
+    uint64_t cycleWaitUs;         ///< Wait time of the current cycle
+    uint64_t cycleIntegrationUs;  ///< Integration time of the current cycle
+    uint8_t cycleGain;            ///< Gain of the current cycle
+    uint32_t integrations;
+    uint64_t lastEndUs;
+    double lastLedShare;
+    double lastAmbientLevel;
+    uint8_t latchedHigh;          ///< High byte latched by reading a low data byte
+    LevelFunction ambientLevel;
+    void *ambientContext;
+    std::vector<uint64_t> ledToggles; ///< Times the LED changed state, oldest first
+    bool ledOnNow;
+    uint32_t noiseState;
+
+    void update();
+    void startCycle(uint64_t startUs);
+    void latch(uint64_t endUs);
+    double ledShare(uint64_t fromUs, uint64_t toUs) const;
+    double meanAmbientLevel(uint64_t fromUs, uint64_t toUs) const;
+    double noise();
+};
+
+/**
+ * @class Bus
+ * @brief Virtual clock, I2C routing and fault injection shared by all sensors
+ */
+class Bus {
+public:
+    static const uint8_t MAX_SENSORS = 8;
+
+    Bus();
+
+    /**
+     * @brief Forget everything: one sensor on channel 0, time 0, no faults
+     */
+    void reset();
+
+    // Topology
+    void setSensorCount(uint8_t count);      ///< Sensors on mux channels 0..count-1
+    uint8_t getSensorCount() const;
+    Sensor &sensor(uint8_t channel = 0);
+    void selectChannel(uint8_t channel);     ///< Route 0x39 directly, as a mux write would
+
+    // Clock
+    uint64_t now() const;
+    void advance(uint64_t us);
+    uint32_t byteUs;                          ///< Bus time per byte (90 us = 100 kHz)
+
+    // Faults
+    /**
+     * @brief Make transactions fail
+     * @param skip Transactions that still succeed first
+     * @param count Transactions that fail after them
+     * @param code Wire error code returned (2 NACK address, 3 NACK data, 4 other, 5 timeout)
+     */
+    void failTransactions(uint32_t skip, uint32_t count, uint8_t code = 2);
+
+    /**
+     * @brief Hold SDA low (a slave stuck mid-byte) until enough SCL pulses arrive
+     * @param pulses SCL pulses on sclPin that release it
+     * @note While held, every transaction fails with code 4
+     */
+    void holdSda(uint8_t pulses);
+
+    /**
+     * @brief Brown-out of every sensor: registers back to power-on values
+     */
+    void brownOut();
+
+    uint8_t sdaPin;                           ///< Pin the recovery code must read as SDA
+    uint8_t sclPin;                           ///< Pin the recovery code must pulse as SCL
+    uint32_t getTransactionCount() const;     ///< Transactions started since reset()
+    uint32_t getByteCount() const;            ///< Address and data bytes on the wire since reset()
+    uint32_t getFailedCount() const;          ///< Transactions failed since reset()
+    uint32_t getSclPulses() const;            ///< Recovery pulses seen on sclPin
+    bool isSdaHeld() const;
+
+    // Wire side
+    uint8_t transmit(uint8_t address, const uint8_t *data, uint8_t length);
+    uint8_t receive(uint8_t address, uint8_t *data, uint8_t length);
+    void pinMode(uint8_t pin, uint8_t mode);
+    int digitalRead(uint8_t pin) const;
+
+private:
+    Sensor sensors[MAX_SENSORS];
+    uint8_t sensorCount;
+    uint8_t selected;
+    uint64_t clockUs;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t failed;
+    uint32_t failSkip;
+    uint32_t failCount;
+    uint8_t failCode;
+    uint8_t sdaPulsesNeeded;
+    uint32_t sclPulses;
+    uint8_t pointer[MAX_SENSORS];             ///< Register pointer of each sensor
+
+    uint8_t injectedFault();
+    Sensor *target(uint8_t address);
+};
+
+/**
+ * @brief The bus every fake Arduino function talks to
+ * @return Global bus
+ */
+Bus &bus();
+
+} // namespace fake
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_FAKEBUS_H
@@ -0,0 +1,168 @@
+/**
+ * @file SparkFun_APDS9960.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the SparkFun APDS9960 driver (ALS subset)
+ */
+
+#include "SparkFun_APDS9960.h"
+#include <Wire.h>
+
+SparkFun_APDS9960::SparkFun_APDS9960() {
+}
+
+bool SparkFun_APDS9960::init() {
+    Wire.begin();
+
+    uint8_t id;
+    if (!wireReadDataByte(APDS9960_ID, id)) {
+        return false;
+    }
+    if (id != APDS9960_ID_1 && id != APDS9960_ID_2) {
+        return false;
+    }
+    if (!setMode(ALL, 0)) {
+        return false;
+    }
+
+    return wireWriteDataByte(APDS9960_ATIME, DEFAULT_ATIME) &&
+           wireWriteDataByte(APDS9960_WTIME, DEFAULT_WTIME) &&
+           wireWriteDataByte(APDS9960_CONFIG1, DEFAULT_CONFIG1) &&
+           setLEDDrive(DEFAULT_LDRIVE) &&
+           setAmbientLightGain(DEFAULT_AGAIN);
+}
+
+uint8_t SparkFun_APDS9960::getMode() {
+    uint8_t enable;
+    if (!wireReadDataByte(APDS9960_ENABLE, enable)) {
+        return 0xFF;
+    }
+    return enable;
+}
+
+bool SparkFun_APDS9960::setMode(uint8_t mode, uint8_t enable) {
+    uint8_t value = getMode();
+    if (value == 0xFF) {
+        return false;
+    }
+
+    enable &= 0x01;
+    if (mode <= 6) {
+        if (enable) {
+            value |= (1 << mode);
+        } else {
+            value &= ~(1 << mode);
+        }
+    } else if (mode == ALL) {
+        value = enable ? 0x7F : 0x00;
+    }
+    return wireWriteDataByte(APDS9960_ENABLE, value);
+}
+
+bool SparkFun_APDS9960::enablePower() {
+    return setMode(POWER, 1);
+}
+
+bool SparkFun_APDS9960::disablePower() {
+    return setMode(POWER, 0);
+}
+
+bool SparkFun_APDS9960::enableLightSensor(bool interrupts) {
+    return setAmbientLightGain(DEFAULT_AGAIN) &&
+           setMode(AMBIENT_LIGHT_INT, interrupts ? 1 : 0) &&
+           enablePower() &&
+           setMode(AMBIENT_LIGHT, 1);
+}
+
+bool SparkFun_APDS9960::disableLightSensor() {
+    return setMode(AMBIENT_LIGHT_INT, 0) && setMode(AMBIENT_LIGHT, 0);
+}
+
+uint8_t SparkFun_APDS9960::getLEDDrive() {
+    uint8_t control;
+    if (!wireReadDataByte(APDS9960_CONTROL, control)) {
+        return 0xFF;
+    }
+    return (control >> 6) & 0x03;
+}
+
+bool SparkFun_APDS9960::setLEDDrive(uint8_t drive) {
+    uint8_t control;
+    if (!wireReadDataByte(APDS9960_CONTROL, control)) {
+        return false;
+    }
+    control = static_cast<uint8_t>((control & 0x3F) | ((drive & 0x03) << 6));
+    return wireWriteDataByte(APDS9960_CONTROL, control);
+}
+
+uint8_t SparkFun_APDS9960::getAmbientLightGain() {
+    uint8_t control;
+    if (!wireReadDataByte(APDS9960_CONTROL, control)) {
+        return 0xFF;
+    }
+    return control & 0x03;
+}
+
+bool SparkFun_APDS9960::setAmbientLightGain(uint8_t gain) {
+    uint8_t control;
+    if (!wireReadDataByte(APDS9960_CONTROL, control)) {
+        return false;
+    }
+    control = static_cast<uint8_t>((control & 0xFC) | (gain & 0x03));
+    return wireWriteDataByte(APDS9960_CONTROL, control);
+}
+
+bool SparkFun_APDS9960::readAmbientLight(uint16_t &val) {
+    return readLight(APDS9960_CDATAL, val);
+}
+
+bool SparkFun_APDS9960::readRedLight(uint16_t &val) {
+    return readLight(APDS9960_RDATAL, val);
+}
+
+bool SparkFun_APDS9960::readGreenLight(uint16_t &val) {
+    return readLight(APDS9960_GDATAL, val);
+}
+
+bool SparkFun_APDS9960::readBlueLight(uint16_t &val) {
+    return readLight(APDS9960_BDATAL, val);
+}
+
+bool SparkFun_APDS9960::readLight(uint8_t lowRegister, uint16_t &val) {
+    uint8_t low;
+    uint8_t high;
+    val = 0;
+    if (!wireReadDataByte(lowRegister, low)) {
+        return false;
+    }
+    if (!wireReadDataByte(lowRegister + 1, high)) {
+        return false;
+    }
+    val = static_cast<uint16_t>(low + (high << 8));
+    return true;
+}
+
+bool SparkFun_APDS9960::wireWriteDataByte(uint8_t reg, uint8_t val) {
+    Wire.beginTransmission(APDS9960_I2C_ADDR);
+    Wire.write(reg);
+    Wire.write(val);
+    return Wire.endTransmission() == 0;
+}
+
+/*
+ * Like the original, only a failed pointer write is reported: a read that
+ * returns no bytes leaves val untouched.
+ */
+bool SparkFun_APDS9960::wireReadDataByte(uint8_t reg, uint8_t &val) {
+    Wire.beginTransmission(APDS9960_I2C_ADDR);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0) {
+        return false;
+    }
+
+    Wire.requestFrom(APDS9960_I2C_ADDR, 1);
+    while (Wire.available()) {
+        val = Wire.read();
+    }
+    return true;
+}
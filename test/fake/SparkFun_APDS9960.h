@@ -0,0 +1,102 @@
+/**
+ * @file SparkFun_APDS9960.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the SparkFun APDS9960 driver (ALS subset)
+ *
+ * Only the functions this library calls are provided. They talk to the
+ * sensor through Wire exactly like the original driver: init() checks the
+ * ID and writes the same defaults, the enable functions read-modify-write
+ * ENABLE, and every readXLight() reads the low and high data bytes in two
+ * separate transactions.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_SPARKFUN_APDS9960_H
+#define MANIGLIO_APDS_LIBRARY_TEST_SPARKFUN_APDS9960_H
+
+#include <Arduino.h>
+
+#define APDS9960_I2C_ADDR 0x39
+
+/* Register addresses */
+#define APDS9960_ENABLE 0x80
+#define APDS9960_ATIME 0x81
+#define APDS9960_WTIME 0x83
+#define APDS9960_CONFIG1 0x8D
+#define APDS9960_CONTROL 0x8F
+#define APDS9960_ID 0x92
+#define APDS9960_CDATAL 0x94
+#define APDS9960_CDATAH 0x95
+#define APDS9960_RDATAL 0x96
+#define APDS9960_RDATAH 0x97
+#define APDS9960_GDATAL 0x98
+#define APDS9960_GDATAH 0x99
+#define APDS9960_BDATAL 0x9A
+#define APDS9960_BDATAH 0x9B
+
+/* Acceptable device IDs */
+#define APDS9960_ID_1 0xAB
+#define APDS9960_ID_2 0x9C
+
+/* Enable register bits */
+#define POWER 0
+#define AMBIENT_LIGHT 1
+#define PROXIMITY 2
+#define WAIT 3
+#define AMBIENT_LIGHT_INT 4
+#define PROXIMITY_INT 5
+#define GESTURE 6
+#define ALL 7
+
+/* LED drive values */
+#define LED_DRIVE_100MA 0
+#define LED_DRIVE_50MA 1
+#define LED_DRIVE_25MA 2
+#define LED_DRIVE_12_5MA 3
+
+/* ALS gain values */
+#define AGAIN_1X 0
+#define AGAIN_4X 1
+#define AGAIN_16X 2
+#define AGAIN_64X 3
+
+/* Defaults */
+#define DEFAULT_ATIME 219
+#define DEFAULT_WTIME 246
+#define DEFAULT_CONFIG1 0x60
+#define DEFAULT_LDRIVE LED_DRIVE_100MA
+#define DEFAULT_AGAIN AGAIN_4X
+
+/**
+ * @class SparkFun_APDS9960
+ * @brief Ambient light part of the SparkFun driver
+ */
+class SparkFun_APDS9960 {
+public:
+    SparkFun_APDS9960();
+    bool init();
+    uint8_t getMode();
+    bool setMode(uint8_t mode, uint8_t enable);
+
+    bool enablePower();
+    bool disablePower();
+    bool enableLightSensor(bool interrupts = false);
+    bool disableLightSensor();
+
+    uint8_t getLEDDrive();
+    bool setLEDDrive(uint8_t drive);
+    uint8_t getAmbientLightGain();
+    bool setAmbientLightGain(uint8_t gain);
+
+    bool readAmbientLight(uint16_t &val);
+    bool readRedLight(uint16_t &val);
+    bool readGreenLight(uint16_t &val);
+    bool readBlueLight(uint16_t &val);
+
+private:
+    bool readLight(uint8_t lowRegister, uint16_t &val);
+    bool wireWriteDataByte(uint8_t reg, uint8_t val);
+    bool wireReadDataByte(uint8_t reg, uint8_t &val);
+};
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_SPARKFUN_APDS9960_H
@@ -0,0 +1,66 @@
+/**
+ * @file Wire.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the Arduino Wire library, backed by the fake bus
+ */
+
+#include "Wire.h"
+#include "FakeBus.h"
+
+TwoWire Wire;
+
+void TwoWire::begin() {
+}
+
+void TwoWire::begin(int, int) {
+}
+
+void TwoWire::end() {
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txLength = 0;
+    txOverflow = false;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    if (txLength >= BUFFER_SIZE) {
+        txOverflow = true;
+        return 0;
+    }
+    txBuffer[txLength++] = value;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+    if (txOverflow) {
+        return 1;
+    }
+    return fake::bus().transmit(txAddress, txBuffer, txLength);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    if (quantity > BUFFER_SIZE) {
+        quantity = BUFFER_SIZE;
+    }
+    rxLength = fake::bus().receive(address, rxBuffer, quantity);
+    rxIndex = 0;
+    return rxLength;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity) {
+    return requestFrom(static_cast<uint8_t>(address), static_cast<uint8_t>(quantity));
+}
+
+int TwoWire::available() {
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read() {
+    if (rxIndex >= rxLength) {
+        return -1;
+    }
+    return rxBuffer[rxIndex++];
+}
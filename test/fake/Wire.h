@@ -0,0 +1,51 @@
+/**
+ * @file Wire.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Host replacement of the Arduino Wire library, backed by the fake bus
+ *
+ * Every transaction is handed to fake::Bus, which routes it to the
+ * simulated sensors, charges the bus time to the virtual clock and applies
+ * the injected faults. Return codes follow the Arduino convention
+ * (0 success, 2 address NACK, 3 data NACK, 4 other error, 5 timeout).
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_WIRE_H
+#define MANIGLIO_APDS_LIBRARY_TEST_WIRE_H
+
+#include <Arduino.h>
+
+/**
+ * @class TwoWire
+ * @brief I2C master interface of the Arduino core
+ */
+class TwoWire {
+public:
+    void begin();
+    void begin(int sda, int scl);
+    void end();
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    uint8_t requestFrom(int address, int quantity);
+    int available();
+    int read();
+
+private:
+    static const uint8_t BUFFER_SIZE = 32; ///< Same limit as the AVR core
+
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[BUFFER_SIZE] = {};
+    uint8_t txLength = 0;
+    bool txOverflow = false;
+    uint8_t rxBuffer[BUFFER_SIZE] = {};
+    uint8_t rxLength = 0;
+    uint8_t rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_WIRE_H
@@ -0,0 +1,90 @@
+/**
+ * @file TestHarness.h
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Minimal test framework for the host tests
+ *
+ * Tests are free functions declared with TEST_CASE(); they register
+ * themselves and run in declaration order. The fake bus is reset before
+ * every test, so each one starts at virtual time 0 with one sensor, default
+ * optics and no injected faults.
+ *
+ * - CHECK(condition) records a failure and continues.
+ * - CHECK_NEAR(actual, expected, tolerance) compares numbers.
+ * - REQUIRE(condition) records a failure and ends the test.
+ */
+
+#ifndef MANIGLIO_APDS_LIBRARY_TEST_TESTHARNESS_H
+#define MANIGLIO_APDS_LIBRARY_TEST_TESTHARNESS_H
+
+#include <stdio.h>
+#include <math.h>
+
+namespace test {
+
+typedef void (*TestFunction)();
+
+/**
+ * @struct TestCase
+ * @brief One registered test (singly linked, in registration order)
+ */
+struct TestCase {
+    const char *name;
+    TestFunction function;
+    TestCase *next;
+};
+
+/// Thrown by REQUIRE() to leave the current test
+struct Abort {
+};
+
+void registerTest(TestCase *testCase);
+void recordFailure(const char *file, int line, const char *expression);
+void recordNearFailure(const char *file, int line, const char *expression,
+                       double actual, double expected, double tolerance);
+
+/**
+ * @class Registrar
+ * @brief Registers a test at static initialization
+ */
+class Registrar {
+public:
+    Registrar(const char *name, TestFunction function) : testCase{name, function, nullptr} {
+        registerTest(&testCase);
+    }
+
+private:
+    TestCase testCase;
+};
+
+} // namespace test
+
+#define TEST_CASE(name)                                                    \
+    static void name();                                                    \
+    static test::Registrar name##Registrar(#name, name);                   \
+    static void name()
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) test::recordFailure(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                            \
+    do {                                                                   \
+        const double checkActual = static_cast<double>(actual);            \
+        const double checkExpected = static_cast<double>(expected);        \
+        const double checkTolerance = static_cast<double>(tolerance);      \
+        if (!(fabs(checkActual - checkExpected) <= checkTolerance))        \
+            test::recordNearFailure(__FILE__, __LINE__, #actual,           \
+                                    checkActual, checkExpected, checkTolerance); \
+    } while (0)
+
+#define REQUIRE(condition)                                                 \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            test::recordFailure(__FILE__, __LINE__, #condition);           \
+            throw test::Abort();                                           \
+        }                                                                  \
+    } while (0)
+
+#endif //MANIGLIO_APDS_LIBRARY_TEST_TESTHARNESS_H
@@ -0,0 +1,69 @@
+/**
+ * @file TestMain.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Runner of the registered host tests
+ *
+ * Usage: test_<name> [filter]. With a filter only the tests whose name
+ * contains it run. The exit code is the number of failed tests (capped).
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include <string.h>
+
+namespace test {
+
+static TestCase *firstTest = nullptr;
+static TestCase *lastTest = nullptr;
+static int failures = 0;
+
+void registerTest(TestCase *testCase) {
+    if (lastTest == nullptr) {
+        firstTest = testCase;
+    } else {
+        lastTest->next = testCase;
+    }
+    lastTest = testCase;
+}
+
+void recordFailure(const char *file, int line, const char *expression) {
+    printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+    failures++;
+}
+
+void recordNearFailure(const char *file, int line, const char *expression,
+                       double actual, double expected, double tolerance) {
+    printf("  %s:%d: %s = %.6g, expected %.6g +/- %.3g\n", file, line, expression,
+           actual, expected, tolerance);
+    failures++;
+}
+
+} // namespace test
+
+int main(int argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    int failed = 0;
+
+    for (test::TestCase *testCase = test::firstTest; testCase != nullptr; testCase = testCase->next) {
+        if (filter != nullptr && strstr(testCase->name, filter) == nullptr) {
+            continue;
+        }
+        fake::bus().reset();
+        const int before = test::failures;
+        try {
+            testCase->function();
+        } catch (const test::Abort &) {
+        }
+        run++;
+        const bool passed = test::failures == before;
+        if (!passed) {
+            failed++;
+        }
+        printf("%s %s\n", passed ? "PASS" : "FAIL", testCase->name);
+    }
+
+    printf("%d tests, %d failed\n", run, failed);
+    return failed > 100 ? 100 : failed;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file test_bus_bytes.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Partial channel reads and the bus byte counter
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static void setUpSensor(ADPS9960_ColorSensor &sensor) {
+    fake::bus().sensor().ambient = fake::Light{2000, 900, 700, 500};
+    REQUIRE(sensor.begin());
+    delay(200);
+}
+
+/// Bytes a read moves according to the library and on the wire
+struct ByteDelta {
+    uint32_t counted;
+    uint32_t wire;
+};
+
+template<typename Read>
+static ByteDelta measure(ADPS9960_ColorSensor &sensor, Read read) {
+    const uint32_t counted = sensor.getBusByteCount();
+    const uint32_t wire = fake::bus().getByteCount();
+    REQUIRE(read());
+    return ByteDelta{sensor.getBusByteCount() - counted, fake::bus().getByteCount() - wire};
+}
+
+TEST_CASE(burstSpansOnlyTheRequestedChannels) {
+    ADPS9960_ColorSensor sensor;
+    setUpSensor(sensor);
+    ADPS9960_ColorSensor::RawColor raw{};
+
+    const ByteDelta clear = measure(sensor, [&] {
+        return sensor.readChannels(raw, ADPS9960_ColorSensor::CHANNEL_CLEAR);
+    });
+    CHECK(clear.counted == 5); // Address + pointer, address + 2 data bytes
+    CHECK(clear.wire == 5);
+    CHECK_NEAR(raw.ambient, 2000, 1);
+    CHECK(raw.red == 0 && raw.green == 0 && raw.blue == 0);
+
+    const ByteDelta rgb = measure(sensor, [&] {
+        return sensor.readChannels(raw, ADPS9960_ColorSensor::CHANNEL_RGB);
+    });
+    CHECK(rgb.counted == 9);
+    CHECK(rgb.wire == 9);
+    CHECK(raw.ambient == 0);
+    CHECK_NEAR(raw.blue, 500, 1);
+
+    const ByteDelta all = measure(sensor, [&] { return sensor.readRawData(raw); });
+    CHECK(all.counted == 11);
+    CHECK(all.wire == 11);
+}
+
+TEST_CASE(counterMatchesTheWireAcrossReadPaths) {
+    ADPS9960_ColorSensor sensor;
+    setUpSensor(sensor);
+    sensor.resetBusByteCount();
+    CHECK(sensor.getBusByteCount() == 0);
+
+    const uint32_t wire = fake::bus().getByteCount();
+    ADPS9960_ColorSensor::ColorSample sample{};
+    ADPS9960_ColorSensor::RGB16 rgb{};
+    for (uint8_t i = 0; i < 4; i++) {
+        REQUIRE(sensor.readSample(sample));
+        REQUIRE(sensor.readRGB16(rgb));
+        delay(110);
+    }
+    sensor.setOversampling(4);
+    REQUIRE(sensor.readRGB16(rgb));
+
+    CHECK(sensor.getBusByteCount() == fake::bus().getByteCount() - wire);
+}
+
+TEST_CASE(emptyMaskReadsNothing) {
+    ADPS9960_ColorSensor sensor;
+    setUpSensor(sensor);
+    ADPS9960_ColorSensor::RawColor raw{};
+    const uint32_t wire = fake::bus().getByteCount();
+    CHECK(!sensor.readChannels(raw, 0));
+    CHECK(fake::bus().getByteCount() == wire);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_bus_recovery.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Fault injection against readRawData() and recoverBus()
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static const int8_t SDA_PIN = 21;
+static const int8_t SCL_PIN = 22;
+
+/// Light of the default fake sensor at the default exposure
+static void checkDefaultLight(const ADPS9960_ColorSensor::RawColor &raw) {
+    CHECK_NEAR(raw.ambient, 800, 1);
+    CHECK_NEAR(raw.red, 300, 1);
+    CHECK_NEAR(raw.green, 250, 1);
+    CHECK_NEAR(raw.blue, 200, 1);
+}
+
+TEST_CASE(beginReadsTheSensor) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200); // begin() returns before the first integration completes
+
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    checkDefaultLight(raw);
+    CHECK(sensor.getLastBusError() == ADPS9960_ColorSensor::BUS_OK);
+}
+
+TEST_CASE(failedReadWithoutRecoveryReportsTheCause) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    fake::bus().failTransactions(0, 1, 3);
+    ADPS9960_ColorSensor::RawColor raw{};
+    CHECK(!sensor.readRawData(raw));
+    CHECK(sensor.getLastBusError() == ADPS9960_ColorSensor::BUS_NACK_DATA);
+    CHECK(sensor.getRecoveryReport().busErrors == 0);
+
+    CHECK(sensor.readRawData(raw));
+    CHECK(sensor.getLastBusError() == ADPS9960_ColorSensor::BUS_OK);
+}
+
+TEST_CASE(transientNackIsRecovered) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(-1, -1);
+
+    fake::bus().failTransactions(0, 1, 2);
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    checkDefaultLight(raw);
+
+    const ADPS9960_ColorSensor::RecoveryReport &report = sensor.getRecoveryReport();
+    CHECK(report.busErrors == 1);
+    CHECK(report.recoveries == 1);
+    CHECK(report.failedRecoveries == 0);
+    CHECK(report.lastAttempts == 1);
+    CHECK(report.lastError == ADPS9960_ColorSensor::BUS_NACK_ADDRESS);
+    CHECK(report.reinitializations == 0);
+}
+
+TEST_CASE(timeoutIsClassified) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(-1, -1);
+
+    fake::bus().failTransactions(0, 1, 5);
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK(sensor.getRecoveryReport().lastError == ADPS9960_ColorSensor::BUS_TIMEOUT);
+}
+
+TEST_CASE(heldSdaIsReleasedByClockPulses) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(SDA_PIN, SCL_PIN);
+
+    fake::bus().holdSda(5);
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    checkDefaultLight(raw);
+
+    CHECK(!fake::bus().isSdaHeld());
+    CHECK(fake::bus().getSclPulses() == 5);
+    const ADPS9960_ColorSensor::RecoveryReport &report = sensor.getRecoveryReport();
+    CHECK(report.busClears == 1);
+    CHECK(report.lastError == ADPS9960_ColorSensor::BUS_ARBITRATION);
+    CHECK(report.recoveries == 1);
+}
+
+TEST_CASE(busClearStopsAtNinePulses) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(SDA_PIN, SCL_PIN, 1);
+
+    fake::bus().holdSda(200);
+    ADPS9960_ColorSensor::RawColor raw{};
+    CHECK(!sensor.readRawData(raw));
+    CHECK(fake::bus().getSclPulses() == ADPS9960_ColorSensor::BUS_CLEAR_PULSES);
+    CHECK(sensor.getRecoveryReport().failedRecoveries == 1);
+}
+
+TEST_CASE(brownOutRestoresTheExposureFromTheShadow) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(-1, -1);
+    REQUIRE(sensor.setGain(AGAIN_16X));
+    REQUIRE(sensor.setIntegrationTime(200));
+
+    fake::bus().brownOut();
+    CHECK(!fake::bus().sensor().isIntegrating());
+    REQUIRE(sensor.recoverBus());
+
+    fake::Sensor &device = fake::bus().sensor();
+    CHECK(device.isIntegrating());
+    CHECK(device.peek(fake::Sensor::ATIME) == 200);
+    CHECK((device.peek(fake::Sensor::CONTROL) & 0x03) == AGAIN_16X);
+    CHECK(sensor.getRecoveryReport().reinitializations == 1);
+
+    // 16x and 56 cycles against the 4x, 37 cycle reference
+    delay(400);
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK_NEAR(raw.red, 300.0 * 4 * 56 / 37, 2);
+}
+
+TEST_CASE(persistentFailureBacksOffAndGivesUp) {
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    sensor.enableBusRecovery(-1, -1, 4, 8);
+
+    fake::bus().failTransactions(0, 1000, 2);
+    const uint64_t startUs = fake::bus().now();
+    ADPS9960_ColorSensor::RawColor raw{};
+    CHECK(!sensor.readRawData(raw));
+    const uint64_t elapsedUs = fake::bus().now() - startUs;
+
+    const ADPS9960_ColorSensor::RecoveryReport &report = sensor.getRecoveryReport();
+    CHECK(report.failedRecoveries == 1);
+    CHECK(report.recoveries == 0);
+    CHECK(report.lastAttempts == 4);
+    // Delays of 1, 2 and 4 ms between the four attempts
+    CHECK(elapsedUs >= 7000);
+    CHECK(elapsedUs < 20000);
+    CHECK(report.lastRecoveryUs <= elapsedUs);
+}
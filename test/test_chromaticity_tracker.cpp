@@ -0,0 +1,104 @@
+/**
+ * @file test_chromaticity_tracker.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Alpha-beta tracking of moving targets
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ChromaticityTracker.h"
+
+typedef ADPS9960_ColorSensor::Chromaticity Chromaticity;
+
+static Chromaticity chroma(uint16_t r, uint16_t g, uint16_t b, uint16_t intensity) {
+    Chromaticity value{};
+    value.r = r;
+    value.g = g;
+    value.b = b;
+    value.intensity = intensity;
+    return value;
+}
+
+TEST_CASE(gainsFollowKalata) {
+    ChromaticityTracker tracker;
+    tracker.setNoise(10.0f, 10.0f); // lambda 1: r = 0.5
+    CHECK_NEAR(tracker.getAlpha(), 0.75, 0.001);
+    CHECK_NEAR(tracker.getBeta(), 0.5, 0.001);
+
+    tracker.setNoise(0.0f, 5.0f);
+    CHECK_NEAR(tracker.getAlpha(), 1.0, 0.0);
+    CHECK_NEAR(tracker.getBeta(), 0.0, 0.0);
+}
+
+TEST_CASE(rampIsTrackedWithoutLag) {
+    ChromaticityTracker tracker;
+    ChromaticityTracker ema;
+    tracker.setGains(0.5f, 0.1f);
+    ema.setGains(0.5f, 0.0f);
+
+    uint16_t r = 1000;
+    for (uint8_t i = 0; i < 60; i++, r += 20) {
+        tracker.update(chroma(r, 1365, 1365, 3000));
+        ema.update(chroma(r, 1365, 1365, 3000));
+    }
+    r -= 20; // Last value fed
+
+    Chromaticity estimate{};
+    tracker.getEstimate(estimate);
+    CHECK_NEAR(estimate.r, r, 1);
+    CHECK_NEAR(estimate.g, 1365, 0);
+    ema.getEstimate(estimate);
+    CHECK_NEAR(estimate.r, r - 20, 1); // (1 - alpha) / alpha = 1 sample behind
+
+    tracker.predict(estimate, 3);
+    CHECK_NEAR(estimate.r, r + 60, 1);
+}
+
+TEST_CASE(sampleFlagsGateTheUpdate) {
+    const uint8_t fresh = ADPS9960_ColorSensor::SAMPLE_FRESH;
+    ChromaticityTracker tracker;
+    tracker.setGains(0.5f, 0.1f);
+    for (uint16_t i = 0; i < 40; i++) {
+        tracker.update(chroma(1000 + 10 * i, 1365, 1365, 3000), fresh);
+    }
+    Chromaticity before{};
+    tracker.getEstimate(before);
+
+    // A repeated result is dropped
+    tracker.update(chroma(5000, 1365, 1365, 3000), 0);
+    Chromaticity estimate{};
+    tracker.getEstimate(estimate);
+    CHECK(estimate.r == before.r);
+
+    // A clipped sample coasts on the velocity
+    tracker.update(chroma(5000, 1365, 1365, 3000), fresh | ADPS9960_ColorSensor::SAMPLE_CLIPPED);
+    tracker.getEstimate(estimate);
+    CHECK_NEAR(estimate.r, before.r + 10, 1);
+
+    // Coasting stops after MAX_COAST_SAMPLES
+    for (uint8_t i = 0; i < 2 * ChromaticityTracker::MAX_COAST_SAMPLES; i++) {
+        tracker.coast();
+    }
+    tracker.getEstimate(estimate);
+    CHECK_NEAR(estimate.r, before.r + 10 * ChromaticityTracker::MAX_COAST_SAMPLES, 2);
+}
+
+TEST_CASE(noiseIsMeasuredOnAStillTarget) {
+    fake::Sensor &device = fake::bus().sensor();
+    device.ambient = fake::Light{2000, 900, 700, 500};
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+
+    ChromaticityTracker quiet;
+    REQUIRE(quiet.calibrateNoise(sensor, 5.0f, 8));
+    CHECK_NEAR(quiet.getMeasurementNoise(), 0.0, 0.0);
+    CHECK_NEAR(quiet.getAlpha(), 1.0, 0.0);
+
+    device.noiseCounts = 4.0;
+    ChromaticityTracker noisy;
+    REQUIRE(noisy.calibrateNoise(sensor, 5.0f, 24));
+    CHECK(noisy.getMeasurementNoise() > 2.0f);
+    CHECK(noisy.getAlpha() < 0.9f);
+}
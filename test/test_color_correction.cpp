@@ -0,0 +1,142 @@
+/**
+ * @file test_color_correction.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Correction LUT fit, interpolation and persistence of the LUT handle
+ */
+
+#include "TestHarness.h"
+#include "APDS9960_ColorSensor.h"
+#include <vector>
+
+typedef ADPS9960_ColorSensor::RGB16 RGB16;
+
+static const uint8_t GRID = 9;
+static const size_t LUT_LENGTH = GRID * GRID * GRID * 3;
+
+/// Smooth non-linear unit response with channel crosstalk
+static RGB16 distort(const RGB16 &truth) {
+    const double x[3] = {truth.r / 65535.0, truth.g / 65535.0, truth.b / 65535.0};
+    uint16_t out[3];
+    for (uint8_t c = 0; c < 3; c++) {
+        const double crosstalk = 0.5 * (x[(c + 1) % 3] + x[(c + 2) % 3]);
+        const double value = 0.85 * pow(x[c], 1.2) + 0.1 * crosstalk;
+        out[c] = static_cast<uint16_t>(lround(value * 65535.0));
+    }
+    return RGB16{out[0], out[1], out[2]};
+}
+
+static double distance(const RGB16 &a, const RGB16 &b) {
+    const double dr = static_cast<double>(a.r) - b.r;
+    const double dg = static_cast<double>(a.g) - b.g;
+    const double db = static_cast<double>(a.b) - b.b;
+    return sqrt(dr * dr + dg * dg + db * db);
+}
+
+/// Reference patches on a 6x6x6 grid and their distorted readings
+static void makePatches(std::vector<RGB16> &measured, std::vector<RGB16> &reference) {
+    for (uint8_t r = 0; r < 6; r++) {
+        for (uint8_t g = 0; g < 6; g++) {
+            for (uint8_t b = 0; b < 6; b++) {
+                const RGB16 truth = {static_cast<uint16_t>(r * 13107), static_cast<uint16_t>(g * 13107),
+                                     static_cast<uint16_t>(b * 13107)};
+                reference.push_back(truth);
+                measured.push_back(distort(truth));
+            }
+        }
+    }
+}
+
+TEST_CASE(fitWithoutErrorGivesTheIdentity) {
+    std::vector<RGB16> patches;
+    for (uint16_t i = 0; i < 20; i++) {
+        patches.push_back(RGB16{static_cast<uint16_t>(i * 3000), static_cast<uint16_t>(65535 - i * 3000),
+                                static_cast<uint16_t>(i * 1700)});
+    }
+    std::vector<uint16_t> lut(LUT_LENGTH);
+    REQUIRE(ADPS9960_ColorSensor::fitColorCorrectionLUT(patches.data(), patches.data(),
+                                                        static_cast<uint16_t>(patches.size()), GRID, lut.data()));
+
+    RGB16 color = {12345, 40000, 777};
+    ADPS9960_ColorSensor::applyColorCorrectionLUT(lut.data(), GRID, false, color);
+    CHECK_NEAR(color.r, 12345, 2);
+    CHECK_NEAR(color.g, 40000, 2);
+    CHECK_NEAR(color.b, 777, 2);
+}
+
+TEST_CASE(fittedLUTUndoesTheUnitResponse) {
+    std::vector<RGB16> measured, reference;
+    makePatches(measured, reference);
+    std::vector<uint16_t> lut(LUT_LENGTH);
+    REQUIRE(ADPS9960_ColorSensor::fitColorCorrectionLUT(measured.data(), reference.data(),
+                                                        static_cast<uint16_t>(measured.size()), GRID, lut.data()));
+
+    // Held-out colors between the patches
+    double before = 0.0;
+    double after = 0.0;
+    uint32_t seed = 12345;
+    const int trials = 500;
+    for (int i = 0; i < trials; i++) {
+        uint16_t channel[3];
+        for (uint8_t c = 0; c < 3; c++) {
+            seed = seed * 1103515245u + 12345u;
+            channel[c] = static_cast<uint16_t>(3000 + (seed >> 16) % 59000);
+        }
+        const RGB16 truth = {channel[0], channel[1], channel[2]};
+        RGB16 reading = distort(truth);
+        before += distance(reading, truth);
+        ADPS9960_ColorSensor::applyColorCorrectionLUT(lut.data(), GRID, false, reading);
+        after += distance(reading, truth);
+    }
+    printf("  mean error %.0f counts uncorrected, %.0f with the LUT\n", before / trials, after / trials);
+    CHECK(after < before / 4);
+}
+
+TEST_CASE(fitRejectsBadInput) {
+    std::vector<RGB16> patches(ADPS9960_ColorSensor::MIN_LUT_PATCHES - 1);
+    std::vector<uint16_t> lut(LUT_LENGTH, 7);
+    CHECK(!ADPS9960_ColorSensor::fitColorCorrectionLUT(patches.data(), patches.data(),
+                                                       static_cast<uint16_t>(patches.size()), GRID, lut.data()));
+    patches.resize(ADPS9960_ColorSensor::MIN_LUT_PATCHES);
+    CHECK(!ADPS9960_ColorSensor::fitColorCorrectionLUT(patches.data(), patches.data(),
+                                                       static_cast<uint16_t>(patches.size()), 1, lut.data()));
+    CHECK(!ADPS9960_ColorSensor::fitColorCorrectionLUT(patches.data(), nullptr,
+                                                       static_cast<uint16_t>(patches.size()), GRID, lut.data()));
+    CHECK(lut[0] == 7);
+}
+
+TEST_CASE(blobRecordsTheUnitLUT) {
+    std::vector<RGB16> measured, reference;
+    makePatches(measured, reference);
+    std::vector<uint16_t> unitLUT(LUT_LENGTH);
+    REQUIRE(ADPS9960_ColorSensor::fitColorCorrectionLUT(measured.data(), reference.data(),
+                                                        static_cast<uint16_t>(measured.size()), GRID, unitLUT.data()));
+    std::vector<uint16_t> otherLUT(unitLUT);
+    otherLUT[100] ^= 1;
+
+    ADPS9960_ColorSensor unit;
+    unit.setDefaultCalibration();
+    REQUIRE(unit.setColorCorrectionLUT(unitLUT.data(), GRID));
+    ADPS9960_ColorSensor::CalibrationBlob blob;
+    unit.exportCalibration(blob);
+    CHECK(blob.lutGridSize == GRID);
+    CHECK(blob.lutChecksum == ADPS9960_ColorSensor::getColorCorrectionLUTChecksum(unitLUT.data(), GRID));
+
+    // Restored on the same unit: only its own table is accepted
+    ADPS9960_ColorSensor restored;
+    REQUIRE(restored.importCalibration(blob));
+    CHECK(!restored.setColorCorrectionLUT(otherLUT.data(), GRID));
+    CHECK(restored.setColorCorrectionLUT(unitLUT.data(), GRID));
+
+    // A table set before the import that does not match is disabled
+    ADPS9960_ColorSensor stale;
+    REQUIRE(stale.setColorCorrectionLUT(otherLUT.data(), GRID));
+    REQUIRE(stale.importCalibration(blob));
+    ADPS9960_ColorSensor::CalibrationBlob reexported;
+    stale.exportCalibration(reexported);
+    CHECK(reexported.lutGridSize == 0);
+
+    // A corrupted handle is caught by the blob checksum
+    blob.lutChecksum ^= 0x0101;
+    CHECK(!restored.importCalibration(blob));
+}
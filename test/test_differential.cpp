@@ -0,0 +1,74 @@
+/**
+ * @file test_differential.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Differential LED capture against ambient light and the wait state
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static const fake::Light AMBIENT = {3000, 1200, 1000, 800};
+static const fake::Light LED = {1600, 700, 500, 400};
+
+static void switchLed(bool on, void *context) {
+    static_cast<fake::Sensor *>(context)->setLed(on);
+}
+
+static void setUpLed(ADPS9960_ColorSensor &sensor) {
+    fake::Sensor &device = fake::bus().sensor();
+    device.ambient = AMBIENT;
+    device.led = LED;
+    REQUIRE(sensor.begin());
+    delay(200);
+    sensor.setIllumination(switchLed, &device);
+    sensor.setDifferentialCapture(true);
+}
+
+static void checkLedOnly(ADPS9960_ColorSensor &sensor) {
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK_NEAR(raw.ambient, LED.clear, 2);
+    CHECK_NEAR(raw.red, LED.red, 2);
+    CHECK_NEAR(raw.green, LED.green, 2);
+    CHECK_NEAR(raw.blue, LED.blue, 2);
+
+    const ADPS9960_ColorSensor::DifferentialReport &pair = sensor.getDifferentialReport();
+    CHECK_NEAR(pair.ambient.ambient, AMBIENT.clear, 2);
+    CHECK_NEAR(pair.lit.ambient, AMBIENT.clear + LED.clear, 2);
+}
+
+TEST_CASE(ambientIsCancelledInBothOrders) {
+    ADPS9960_ColorSensor sensor;
+    setUpLed(sensor);
+    checkLedOnly(sensor); // LED first
+    checkLedOnly(sensor); // LED second
+}
+
+TEST_CASE(pairsAreReadAfterTheWaitState) {
+    ADPS9960_ColorSensor sensor;
+    setUpLed(sensor);
+    REQUIRE(sensor.setWaitTime(250000));
+    delay(800);
+
+    checkLedOnly(sensor);
+    checkLedOnly(sensor);
+
+    // The two integrations end one sample period apart
+    const ADPS9960_ColorSensor::DifferentialReport &pair = sensor.getDifferentialReport();
+    CHECK_NEAR(pair.skewUs, sensor.getSamplePeriodUs(), 2.0 * fake::CYCLE_US + 1000.0);
+}
+
+TEST_CASE(differentialWhiteNormalizesToFullScale) {
+    ADPS9960_ColorSensor sensor;
+    setUpLed(sensor);
+    REQUIRE(sensor.calibrateDifferential(4));
+
+    fake::bus().sensor().ambient = fake::Light{6000, 2400, 2000, 1600}; // Brighter room
+    ADPS9960_ColorSensor::RGB16 rgb{};
+    REQUIRE(sensor.readRGB16(rgb));
+    CHECK_NEAR(rgb.r, 65535, 200);
+    CHECK_NEAR(rgb.g, 65535, 200);
+    CHECK_NEAR(rgb.b, 65535, 200);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file test_energy.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Energy accounting against the sensor state and the library reads
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+/// Sensor supply charged over a stretch of idle time, in uJ
+static double idleSensorUj(ADPS9960_ColorSensor &sensor, unsigned long ms) {
+    const double before = sensor.getEnergyReport().sensorUj;
+    delay(ms);
+    return sensor.getEnergyReport().sensorUj - before;
+}
+
+TEST_CASE(runningSensorIsChargedByDutyCycle) {
+    fake::bus().sensor().ambient = fake::Light{2000, 900, 700, 500};
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    // Free running: 200 uA at 3.3 V for 10 s
+    CHECK_NEAR(idleSensorUj(sensor, 10000), 6600.0, 10.0);
+
+    // Integration 102.9 ms, wait 308.6 ms: (200 * 102.9 + 38 * 308.6) / 411.5 uA
+    REQUIRE(sensor.setWaitTime(3 * sensor.getIntegrationTimeUs()));
+    const double integrationMs = sensor.getIntegrationTimeUs() / 1000.0;
+    const double waitMs = sensor.getWaitTimeUs() / 1000.0;
+    const double expectedUa = (200.0 * integrationMs + 38.0 * waitMs) / (integrationMs + waitMs);
+    CHECK_NEAR(idleSensorUj(sensor, 10000), 3.3 * expectedUa * 10.0, 10.0);
+}
+
+TEST_CASE(stoppedAlsIsChargedAtTheIdleCurrent) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    // Another driver stops the ALS; the next ENABLE access shows it
+    device.writeRegister(fake::Sensor::ENABLE, fake::Sensor::PON);
+    REQUIRE(sensor.setWaitTime(0));
+    CHECK_NEAR(idleSensorUj(sensor, 10000), 3.3 * 38.0 * 10.0, 10.0);
+
+    // Powered down entirely
+    device.writeRegister(fake::Sensor::ENABLE, 0);
+    REQUIRE(sensor.setWaitTime(0));
+    CHECK_NEAR(idleSensorUj(sensor, 10000), 3.3 * 1.0 * 10.0, 1.0);
+}
+
+TEST_CASE(partialReadsChargeTheMcu) {
+    fake::bus().sensor().ambient = fake::Light{2000, 900, 700, 500};
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+
+    const ADPS9960_ColorSensor::EnergyReport before = sensor.getEnergyReport();
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readChannels(raw, ADPS9960_ColorSensor::CHANNEL_CLEAR));
+    const ADPS9960_ColorSensor::EnergyReport &after = sensor.getEnergyReport();
+
+    CHECK(after.mcuAwakeUs - before.mcuAwakeUs >= 5 * fake::bus().byteUs);
+    CHECK(after.busBytes - before.busBytes == 5);
+    CHECK(after.mcuUj > before.mcuUj);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file test_exposure.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Gain ratio measurement and rescaling of the white reference
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+/// Gain stages that differ per channel, as on real parts
+static const double GAIN_FACTORS[4][4] = {
+    {1.00, 1.00, 1.00, 1.00},
+    {4.10, 3.95, 4.00, 4.20},
+    {16.6, 15.7, 16.2, 16.9},
+    {67.0, 62.0, 65.0, 69.0},
+};
+
+static void setUpSensor(fake::Sensor &device) {
+    for (uint8_t gain = 0; gain < 4; gain++) {
+        for (uint8_t c = 0; c < 4; c++) {
+            device.gainFactor[gain][c] = GAIN_FACTORS[gain][c];
+        }
+    }
+    device.ambient = fake::Light{1800, 900, 800, 600};
+}
+
+TEST_CASE(gainRatiosAreMeasuredPerChannel) {
+    setUpSensor(fake::bus().sensor());
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    CHECK(sensor.calibrateGainRatios(4));
+    for (uint8_t gain = 1; gain < 4; gain++) {
+        for (uint8_t c = 0; c < 4; c++) {
+            CHECK_NEAR(sensor.getGainRatio(gain, c), GAIN_FACTORS[gain][c], 0.01 * GAIN_FACTORS[gain][c]);
+        }
+    }
+    CHECK(sensor.getGain() == AGAIN_4X);
+    CHECK((fake::bus().sensor().peek(fake::Sensor::CONTROL) & 0x03) == AGAIN_4X);
+}
+
+TEST_CASE(gainRatiosIgnoreTheWaitState) {
+    setUpSensor(fake::bus().sensor());
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.setWaitTime(500000));
+
+    CHECK(sensor.calibrateGainRatios(2));
+    for (uint8_t gain = 1; gain < 4; gain++) {
+        CHECK_NEAR(sensor.getGainRatio(gain, 0), GAIN_FACTORS[gain][0], 0.01 * GAIN_FACTORS[gain][0]);
+    }
+}
+
+TEST_CASE(weakChannelFollowsTheClearStep) {
+    fake::Sensor &device = fake::bus().sensor();
+    setUpSensor(device);
+    device.ambient.blue = 20; // 5 counts at 1x
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    CHECK(sensor.calibrateGainRatios(4));
+    // The 1x->4x step of blue is the clear one; the later steps are measured
+    const double blueAt4x = GAIN_FACTORS[1][0];
+    CHECK_NEAR(sensor.getGainRatio(1, 3), blueAt4x, 0.01 * blueAt4x);
+    const double blueAt16x = blueAt4x * GAIN_FACTORS[2][3] / GAIN_FACTORS[1][3];
+    CHECK_NEAR(sensor.getGainRatio(2, 3), blueAt16x, 0.02 * blueAt16x);
+}
+
+TEST_CASE(whiteReferenceFollowsEachChannelAcrossGains) {
+    setUpSensor(fake::bus().sensor());
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.calibrateGainRatios(4));
+    REQUIRE(sensor.calibrate(1));
+
+    // The white target read at another gain is still white on every channel
+    REQUIRE(sensor.setGain(AGAIN_16X));
+    delay(300);
+    ADPS9960_ColorSensor::RGB16 rgb{};
+    REQUIRE(sensor.readRGB16(rgb));
+    CHECK_NEAR(rgb.r, 65535, 400);
+    CHECK_NEAR(rgb.g, 65535, 400);
+    CHECK_NEAR(rgb.b, 65535, 400);
+}
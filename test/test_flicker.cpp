@@ -0,0 +1,87 @@
+/**
+ * @file test_flicker.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Mains flicker detection, synchronization and phase averaging
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+/// Lamp ripple: level 1 +/- FLICKER_DEPTH at twice the mains frequency
+static const double FLICKER_DEPTH = 0.3;
+
+static double flicker(uint64_t us, void *context) {
+    const double hz = *static_cast<const double *>(context);
+    return 1.0 + FLICKER_DEPTH * sin(6.283185307179586 * hz * static_cast<double>(us) * 1e-6);
+}
+
+static double flicker100 = 100.0;
+static double flicker120 = 120.0;
+
+static void setUpLamp(fake::Sensor &device, double *flickerHz) {
+    device.ambient = fake::Light{3000, 1400, 1200, 900};
+    device.setAmbientLevel(flickerHz != nullptr ? flicker : nullptr, flickerHz);
+}
+
+TEST_CASE(detectsTheMainsFrequency) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    const uint8_t atime = sensor.getIntegrationTime();
+
+    setUpLamp(device, &flicker100);
+    CHECK(sensor.detectMainsFrequency() == ADPS9960_ColorSensor::MAINS_50HZ);
+    setUpLamp(device, &flicker120);
+    CHECK(sensor.detectMainsFrequency() == ADPS9960_ColorSensor::MAINS_60HZ);
+    setUpLamp(device, nullptr);
+    CHECK(sensor.detectMainsFrequency() == ADPS9960_ColorSensor::MAINS_NONE);
+    CHECK(sensor.getIntegrationTime() == atime);
+}
+
+TEST_CASE(synchronizedIntegrationRejectsFlicker) {
+    fake::Sensor &device = fake::bus().sensor();
+    setUpLamp(device, &flicker100);
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+
+    REQUIRE(sensor.setIntegrationTime(256 - 20)); // 55.6 ms, 5.56 flicker periods
+    float unsynced = 0.0f;
+    REQUIRE(sensor.measureFlickerRipple(unsynced));
+
+    REQUIRE(sensor.enableFlickerRejection(ADPS9960_ColorSensor::MAINS_50HZ));
+    CHECK(sensor.getIntegrationTime() == 256 - 18);
+    float synced = 0.0f;
+    REQUIRE(sensor.measureFlickerRipple(synced));
+
+    CHECK(unsynced > 0.02f);
+    CHECK(synced < 0.005f);
+}
+
+TEST_CASE(phaseAveragingSteadiesUnsyncedReadings) {
+    fake::Sensor &device = fake::bus().sensor();
+    setUpLamp(device, &flicker100);
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.setIntegrationTime(256 - 20));
+    delay(200);
+
+    float spread[2];
+    for (uint8_t averaged = 0; averaged < 2; averaged++) {
+        sensor.setFlickerAveraging(averaged ? 4 : 0);
+        uint16_t low = 65535;
+        uint16_t high = 0;
+        for (uint8_t i = 0; i < 12; i++) {
+            ADPS9960_ColorSensor::RawColor raw{};
+            REQUIRE(sensor.readRawData(raw));
+            if (raw.ambient < low) low = raw.ambient;
+            if (raw.ambient > high) high = raw.ambient;
+            delay(37); // Unrelated to the flicker period
+        }
+        spread[averaged] = static_cast<float>(high - low) / static_cast<float>(high);
+    }
+
+    CHECK(spread[0] > 0.02f);
+    CHECK(spread[1] < spread[0] / 4.0f);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file test_hdr.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Multi-exposure HDR merge and the return to the current exposure
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+/// Glossy highlight on clear and red, dark blue (counts at 4x, ATIME 219)
+static const fake::Light SCENE = {20000, 12000, 3000, 50};
+
+static const ADPS9960_ColorSensor::ExposureSetting EXPOSURES[] = {
+    {AGAIN_1X, 219},
+    {AGAIN_16X, 219},
+};
+
+static void setUpHDR(ADPS9960_ColorSensor &sensor) {
+    fake::bus().sensor().ambient = SCENE;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.setHDRExposures(EXPOSURES, 2));
+    delay(200);
+}
+
+TEST_CASE(channelsComeFromTheMostSensitiveUnclippedExposure) {
+    ADPS9960_ColorSensor sensor;
+    setUpHDR(sensor);
+    CHECK_NEAR(sensor.getHDRDynamicRangeGain(), 16.0, 0.01);
+
+    ADPS9960_ColorSensor::HDRColor hdr{};
+    REQUIRE(sensor.readHDR(hdr));
+    CHECK(hdr.exposureUsed == 0x50); // C and R from 1x (index 0), G and B from 16x (index 1)
+    CHECK(hdr.saturatedMask == 0);
+    CHECK_NEAR(hdr.ambient / 256.0, 20000, 4);
+    CHECK_NEAR(hdr.red / 256.0, 12000, 4);
+    CHECK_NEAR(hdr.green / 256.0, 3000, 1);
+    CHECK_NEAR(hdr.blue / 256.0, 50, 0.25);
+
+    // Two integrations plus bus traffic, no extra fixed delay
+    const uint32_t integrationUs = 37UL * fake::CYCLE_US;
+    CHECK(hdr.acquisitionUs < 2 * (integrationUs + fake::CYCLE_US) + 10000UL);
+}
+
+TEST_CASE(nextReadingIsAtTheCurrentExposure) {
+    ADPS9960_ColorSensor sensor;
+    setUpHDR(sensor);
+
+    ADPS9960_ColorSensor::HDRColor hdr{};
+    REQUIRE(sensor.readHDR(hdr));
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK_NEAR(raw.ambient, 20000, 2);
+    CHECK_NEAR(raw.blue, 50, 1);
+
+    REQUIRE(sensor.readHDR(hdr));
+    ADPS9960_ColorSensor::RawColor part{};
+    REQUIRE(sensor.readChannels(part, ADPS9960_ColorSensor::CHANNEL_BLUE));
+    CHECK_NEAR(part.blue, 50, 1);
+
+    REQUIRE(sensor.readHDR(hdr));
+    ADPS9960_ColorSensor::ColorSample sample{};
+    REQUIRE(sensor.readSample(sample));
+    CHECK(sample.flags & ADPS9960_ColorSensor::SAMPLE_FRESH);
+    CHECK_NEAR(sample.blue, 50, 1);
+}
+
+TEST_CASE(failedRestoreIsRetriedBeforeTheNextRead) {
+    ADPS9960_ColorSensor sensor;
+    setUpHDR(sensor);
+
+    // Fail a transaction of the restore, which follows the two exposures
+    ADPS9960_ColorSensor::HDRColor hdr{};
+    const uint32_t before = fake::bus().getTransactionCount();
+    REQUIRE(sensor.readHDR(hdr));
+    const uint32_t perHDR = fake::bus().getTransactionCount() - before;
+    fake::bus().failTransactions(perHDR - 8, 1);
+    CHECK(!sensor.readHDR(hdr));
+    CHECK((fake::bus().sensor().peek(fake::Sensor::CONTROL) & 0x03) == AGAIN_16X);
+
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK(sensor.getGain() == AGAIN_4X);
+    CHECK((fake::bus().sensor().peek(fake::Sensor::CONTROL) & 0x03) == AGAIN_4X);
+    CHECK_NEAR(raw.blue, 50, 1);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file test_multi_sensor.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Synchronized capture of several sensors behind a multiplexer
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "Wire.h"
+#include "APDS9960_MultiSensor.h"
+
+static const uint8_t VIEWS = 3;
+
+static const fake::Light LIGHTS[VIEWS] = {
+    {2000, 900, 700, 500},
+    {1500, 400, 800, 400},
+    {1800, 500, 500, 900},
+};
+
+static bool selectChannel(uint8_t index, void *) {
+    Wire.beginTransmission(fake::MUX_ADDRESS);
+    Wire.write(static_cast<uint8_t>(1U << index));
+    return Wire.endTransmission() == 0;
+}
+
+/// Begins one sensor per multiplexer channel and registers them
+static void setUpViews(ADPS9960_ColorSensor *sensors, SynchronizedCapture &capture) {
+    fake::bus().setSensorCount(VIEWS);
+    for (uint8_t i = 0; i < VIEWS; i++) {
+        fake::bus().sensor(i).ambient = LIGHTS[i];
+        REQUIRE(selectChannel(i, nullptr));
+        REQUIRE(sensors[i].begin());
+        REQUIRE(capture.addSensor(sensors[i]));
+    }
+    capture.setBusSelect(selectChannel);
+    delay(200);
+}
+
+static void checkViews(const SynchronizedCapture::MultiViewSample &sample, double scale) {
+    for (uint8_t i = 0; i < VIEWS; i++) {
+        CHECK_NEAR(sample.views[i].raw.ambient, LIGHTS[i].clear * scale, 2);
+        CHECK_NEAR(sample.views[i].raw.red, LIGHTS[i].red * scale, 2);
+        CHECK_NEAR(sample.views[i].raw.blue, LIGHTS[i].blue * scale, 2);
+    }
+}
+
+TEST_CASE(viewsStartTogetherAndReadTheirOwnSensor) {
+    ADPS9960_ColorSensor sensors[VIEWS];
+    SynchronizedCapture capture;
+    setUpViews(sensors, capture);
+
+    SynchronizedCapture::MultiViewSample sample{};
+    REQUIRE(capture.capture(sample));
+    CHECK(sample.validMask == 0x07);
+    checkViews(sample, 1.0);
+
+    // Starts a few bus transactions apart, ends within one integration of each other
+    CHECK(sample.skewUs < 2000UL);
+    const uint64_t firstEnd = fake::bus().sensor(0).getLastIntegrationEndUs();
+    for (uint8_t i = 1; i < VIEWS; i++) {
+        const uint64_t end = fake::bus().sensor(i).getLastIntegrationEndUs();
+        CHECK_NEAR(static_cast<double>(end - firstEnd), 0.0, static_cast<double>(sample.skewUs) + 1.0);
+    }
+    CHECK(sample.cycleUs < sensors[0].getIntegrationTimeUs() + 4 * fake::CYCLE_US + 5000UL);
+}
+
+TEST_CASE(waitStateIsCoveredBeforeEachRead) {
+    ADPS9960_ColorSensor sensors[VIEWS];
+    SynchronizedCapture capture;
+    setUpViews(sensors, capture);
+    for (uint8_t i = 0; i < VIEWS; i++) {
+        REQUIRE(selectChannel(i, nullptr));
+        REQUIRE(sensors[i].setWaitTime(300000));
+    }
+    delay(1000);
+
+    SynchronizedCapture::MultiViewSample sample{};
+    REQUIRE(capture.capture(sample));
+    checkViews(sample, 1.0);
+
+    // A brighter part arrives; every view must integrate it
+    for (uint8_t i = 0; i < VIEWS; i++) {
+        fake::bus().sensor(i).ambient = fake::Light{LIGHTS[i].clear * 1.5, LIGHTS[i].red * 1.5,
+                                                    LIGHTS[i].green * 1.5, LIGHTS[i].blue * 1.5};
+    }
+    REQUIRE(capture.capture(sample));
+    checkViews(sample, 1.5);
+}
+
+TEST_CASE(moreThanOneSensorNeedsAMultiplexer) {
+    ADPS9960_ColorSensor sensors[VIEWS];
+    SynchronizedCapture capture;
+    setUpViews(sensors, capture);
+    capture.setBusSelect(nullptr);
+
+    SynchronizedCapture::MultiViewSample sample{};
+    CHECK(!capture.capture(sample));
+    CHECK(sample.validMask == 0);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_profiles.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Illuminant profiles: white reference and transfer matrix per profile
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static const ADPS9960_ColorSensor::TransferMatrix WARM = {{4300, -150, -50, -100, 4200, -4, 0, -80, 4176}};
+static const ADPS9960_ColorSensor::TransferMatrix COOL = {{3900, 120, 76, 60, 4000, 36, -40, 90, 4046}};
+
+static bool sameMatrix(const ADPS9960_ColorSensor::TransferMatrix &a,
+                       const ADPS9960_ColorSensor::TransferMatrix &b) {
+    return memcmp(a.m, b.m, sizeof(a.m)) == 0;
+}
+
+/// Calibrates under the current light and stores it with a matrix
+static int8_t saveUnder(ADPS9960_ColorSensor &sensor, const char *name,
+                        const ADPS9960_ColorSensor::TransferMatrix *matrix) {
+    if (!sensor.calibrate(1, false)) {
+        return -1;
+    }
+    if (matrix != nullptr) {
+        sensor.setTransferMatrix(*matrix);
+    } else {
+        sensor.clearTransferMatrix();
+    }
+    return sensor.saveProfile(name, false);
+}
+
+TEST_CASE(selectingAProfileRestoresItsMatrix) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+
+    device.ambient = fake::Light{3000, 1500, 1000, 500};
+    REQUIRE(saveUnder(sensor, "WARM", &WARM) == 0);
+    device.ambient = fake::Light{3000, 700, 1000, 1300};
+    REQUIRE(saveUnder(sensor, "COOL", &COOL) == 1);
+    REQUIRE(saveUnder(sensor, "PLAIN", nullptr) == 2);
+
+    CHECK(sensor.selectProfile("WARM"));
+    CHECK(sensor.hasTransferMatrix());
+    CHECK(sameMatrix(sensor.getTransferMatrix(), WARM));
+
+    CHECK(sensor.selectProfile("PLAIN"));
+    CHECK(!sensor.hasTransferMatrix());
+
+    CHECK(sensor.selectProfile("COOL"));
+    CHECK(sensor.hasTransferMatrix());
+    CHECK(sameMatrix(sensor.getTransferMatrix(), COOL));
+}
+
+TEST_CASE(profileMatricesSurviveExportAndImport) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor::CalibrationBlob blob{};
+    {
+        ADPS9960_ColorSensor sensor;
+        REQUIRE(sensor.begin());
+        delay(200);
+        device.ambient = fake::Light{3000, 1500, 1000, 500};
+        REQUIRE(saveUnder(sensor, "WARM", &WARM) == 0);
+        device.ambient = fake::Light{3000, 700, 1000, 1300};
+        REQUIRE(saveUnder(sensor, "COOL", &COOL) == 1);
+        sensor.exportCalibration(blob);
+    }
+
+    ADPS9960_ColorSensor restored;
+    REQUIRE(restored.begin());
+    REQUIRE(restored.importCalibration(blob));
+    CHECK(sameMatrix(restored.getTransferMatrix(), COOL));
+    CHECK(restored.selectProfile("WARM"));
+    CHECK(sameMatrix(restored.getTransferMatrix(), WARM));
+}
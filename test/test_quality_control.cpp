@@ -0,0 +1,154 @@
+/**
+ * @file test_quality_control.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Simulated production runs against a golden sample
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_QualityControl.h"
+#include <math.h>
+
+typedef ADPS9960_ColorSensor::OKLab OKLab;
+
+static const OKLab NOMINAL = {0.62f, 0.05f, 0.03f};
+static const float PART_SIGMA[3] = {0.004f, 0.002f, 0.002f}; ///< Part-to-part spread of good parts
+static const float SENSOR_SIGMA = 0.0003f;                   ///< Reading noise of one part
+
+/// Deterministic normal deviates (xorshift32 and Box-Muller)
+class Normal {
+public:
+    explicit Normal(uint32_t seed) : state(seed) {}
+
+    float next() {
+        const float u1 = (static_cast<float>(step() >> 8) + 1.0f) / 16777217.0f;
+        const float u2 = static_cast<float>(step() >> 8) / 16777216.0f;
+        return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    }
+
+private:
+    uint32_t state;
+
+    uint32_t step() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+/// One good part around center, as the sensor reads it
+static OKLab goodPart(Normal &noise, const OKLab &center, const float *partSigma) {
+    OKLab lab;
+    lab.L = center.L + partSigma[0] * noise.next() + SENSOR_SIGMA * noise.next();
+    lab.a = center.a + partSigma[1] * noise.next() + SENSOR_SIGMA * noise.next();
+    lab.b = center.b + partSigma[2] * noise.next() + SENSOR_SIGMA * noise.next();
+    return lab;
+}
+
+/// Inspects count parts around center; returns the alarms raised, restarting the charts after each one
+static int run(ColorQualityControl &qc, Normal &noise, const OKLab &center, const float *partSigma,
+               int count, uint8_t alarmMask, int *firstAlarm = nullptr) {
+    int alarms = 0;
+    for (int i = 0; i < count; i++) {
+        ColorQualityControl::Inspection result;
+        if (qc.inspectLab(goodPart(noise, center, partSigma), result) & alarmMask) {
+            if (alarms == 0 && firstAlarm != nullptr) {
+                *firstAlarm = i;
+            }
+            alarms++;
+            qc.resetCharts(); // as after a process correction
+        }
+    }
+    return alarms;
+}
+
+static void teachGoodParts(ColorQualityControl &qc, Normal &noise, int parts) {
+    for (int i = 0; i < parts; i++) {
+        qc.addGoldenLab(goodPart(noise, NOMINAL, PART_SIGMA));
+    }
+    REQUIRE(qc.finishGolden());
+}
+
+TEST_CASE(notReadyWithoutGolden) {
+    ADPS9960_ColorSensor sensor;
+    ColorQualityControl qc(sensor);
+    Normal noise(1);
+
+    ColorQualityControl::Inspection result;
+    CHECK(qc.inspectLab(NOMINAL, result) == ColorQualityControl::QC_NOT_READY);
+    for (uint8_t i = 0; i < ColorQualityControl::MIN_GOLDEN_SAMPLES - 1; i++) {
+        qc.addGoldenLab(goodPart(noise, NOMINAL, PART_SIGMA));
+    }
+    CHECK(!qc.finishGolden());
+    qc.addGoldenLab(goodPart(noise, NOMINAL, PART_SIGMA));
+    CHECK(qc.finishGolden());
+    CHECK(qc.getGolden().samples == ColorQualityControl::MIN_GOLDEN_SAMPLES);
+}
+
+TEST_CASE(goodPartsStayInControl) {
+    ADPS9960_ColorSensor sensor;
+    ColorQualityControl qc(sensor);
+    Normal noise(2);
+    teachGoodParts(qc, noise, 60);
+
+    const ColorQualityControl::Golden &golden = qc.getGolden();
+    CHECK_NEAR(golden.mean.L, NOMINAL.L, 0.002);
+    CHECK_NEAR(golden.sigma[0], PART_SIGMA[0], 0.0012);
+    CHECK_NEAR(golden.sigma[1], PART_SIGMA[1], 0.0006);
+
+    // 3-sigma of the chi(3) distance: about one good part in 220
+    const int outliers = run(qc, noise, NOMINAL, PART_SIGMA, 400, ColorQualityControl::QC_OUTLIER);
+    CHECK(outliers <= 8);
+    qc.resetCharts();
+    const int charted = run(qc, noise, NOMINAL, PART_SIGMA, 400,
+                            ColorQualityControl::QC_EWMA_SHIFT | ColorQualityControl::QC_CUSUM_DRIFT);
+    CHECK(charted <= 12); // in-control run length shortened by the sigmas estimated from 60 parts
+}
+
+TEST_CASE(sustainedShiftIsCaughtBeforeSinglePartsFail) {
+    ADPS9960_ColorSensor sensor;
+    ColorQualityControl qc(sensor);
+    Normal noise(3);
+    teachGoodParts(qc, noise, 60);
+    qc.setTolerance(0.02f);
+
+    // Parts drift by 1.5 sigma towards red: single parts stay within tolerance
+    OKLab shifted = NOMINAL;
+    shifted.a += 1.5f * PART_SIGMA[1];
+    int firstAlarm = -1;
+    const int charted = run(qc, noise, shifted, PART_SIGMA, 60,
+                            ColorQualityControl::QC_EWMA_SHIFT | ColorQualityControl::QC_CUSUM_DRIFT, &firstAlarm);
+    CHECK(charted > 0);
+    CHECK(firstAlarm >= 0 && firstAlarm < 40);
+
+    OKLab drift;
+    qc.getDrift(drift);
+    CHECK_NEAR(drift.a, 1.5 * PART_SIGMA[1], PART_SIGMA[1]);
+
+    qc.resetCharts();
+    CHECK(run(qc, noise, shifted, PART_SIGMA, 60, ColorQualityControl::QC_OUT_OF_TOLERANCE) == 0);
+}
+
+TEST_CASE(singlePartGoldenNeedsProcessSigma) {
+    ADPS9960_ColorSensor sensor;
+    ColorQualityControl qc(sensor);
+    Normal noise(4);
+    static const float NO_SPREAD[3] = {0.0f, 0.0f, 0.0f};
+    static const float SPREAD[3] = {0.003f, 0.003f, 0.003f};
+
+    // Repeated readings of one part only see the sensor noise
+    for (int i = 0; i < 30; i++) {
+        qc.addGoldenLab(goodPart(noise, NOMINAL, NO_SPREAD));
+    }
+    REQUIRE(qc.finishGolden());
+    CHECK(qc.getGolden().sigma[1] < 0.001f);
+
+    const int falseOutliers = run(qc, noise, NOMINAL, SPREAD, 200, ColorQualityControl::QC_OUTLIER);
+    CHECK(falseOutliers > 150); // nearly every good part is rejected
+
+    qc.setProcessSigma(0.003f);
+    const int outliers = run(qc, noise, NOMINAL, SPREAD, 200, ColorQualityControl::QC_OUTLIER);
+    CHECK(outliers <= 5);
+}
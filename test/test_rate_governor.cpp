@@ -0,0 +1,86 @@
+/**
+ * @file test_rate_governor.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Adaptive sample rate and timed reads under the wait state
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_RateGovernor.h"
+
+static const fake::Light GRAY = {2000, 700, 700, 700};
+static const fake::Light RED = {2000, 1400, 350, 350};
+
+/// One governed step: read, update, program the wait time, sleep the period
+static uint32_t step(ADPS9960_ColorSensor &sensor, SampleRateGovernor &governor) {
+    ADPS9960_ColorSensor::ColorSample sample{};
+    REQUIRE(sensor.readSample(sample));
+    const uint32_t periodUs = governor.update(sample);
+    REQUIRE(governor.apply(sensor));
+    delay(periodUs / 1000);
+    return periodUs;
+}
+
+TEST_CASE(rateBacksOffAndJumpsOnChange) {
+    fake::Sensor &device = fake::bus().sensor();
+    device.ambient = GRAY;
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+
+    SampleRateGovernor governor;
+    governor.setRateLimits(1.0f, 8.0f);
+    governor.setBackoff(2);
+
+    uint32_t periodUs = 0;
+    for (uint8_t i = 0; i < 12; i++) {
+        periodUs = step(sensor, governor);
+    }
+    CHECK(periodUs == 1000000UL);
+    CHECK(!governor.isActive());
+    CHECK_NEAR(sensor.getSamplePeriodUs(), 1000000.0, 6 * fake::CYCLE_US); // WLONG steps of 33.4 ms
+
+    device.ambient = RED;
+    delay(1100);
+    periodUs = step(sensor, governor);
+    CHECK(periodUs == 125000UL);
+    CHECK(governor.isActive());
+    CHECK(governor.getEventCount() == 1);
+    CHECK_NEAR(sensor.getSamplePeriodUs(), 125000.0, fake::CYCLE_US);
+}
+
+TEST_CASE(repeatedSamplesDoNotCount) {
+    fake::bus().sensor().ambient = GRAY;
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+
+    SampleRateGovernor governor;
+    ADPS9960_ColorSensor::ColorSample sample{};
+    REQUIRE(sensor.readSample(sample));
+    governor.update(sample);
+    REQUIRE(sensor.readSample(sample)); // Same integration
+    CHECK(!(sample.flags & ADPS9960_ColorSensor::SAMPLE_FRESH));
+    governor.update(sample);
+    CHECK(governor.getSampleCount() == 1);
+}
+
+TEST_CASE(flickerAveragingReadsAfterTheWaitState) {
+    fake::Sensor &device = fake::bus().sensor();
+    device.ambient = GRAY;
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.setWaitTime(500000));
+    delay(800);
+    sensor.setFlickerAveraging(3);
+
+    ADPS9960_ColorSensor::RawColor raw{};
+    REQUIRE(sensor.readRawData(raw));
+    CHECK_NEAR(raw.red, GRAY.red, 1);
+
+    device.ambient = RED; // Every phase must integrate the new scene
+    REQUIRE(sensor.readRawData(raw));
+    CHECK_NEAR(raw.red, RED.red, 1);
+    CHECK_NEAR(raw.blue, RED.blue, 1);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file test_srgb.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief sRGB lookup tables against the powf() formulas, plus a speed comparison
+ */
+
+#include "TestHarness.h"
+#include "APDS9960_ColorSensor.h"
+#include <chrono>
+
+static float encodeSRGB(float linear) {
+    return linear <= 0.0031308f ? 12.92f * linear : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+static float decodeSRGB(float encoded) {
+    return encoded <= 0.04045f ? encoded / 12.92f : powf((encoded + 0.055f) / 1.055f, 2.4f);
+}
+
+TEST_CASE(forwardTableIsWithinOneCodeOfPowf) {
+    int maxError = 0;
+    for (uint32_t linear = 0; linear <= 65535; linear++) {
+        const long exact = lroundf(encodeSRGB(static_cast<float>(linear) / 65535.0f) * 255.0f);
+        const int error = abs(static_cast<int>(exact) - linearToSRGB(static_cast<uint16_t>(linear)));
+        if (error > maxError) {
+            maxError = error;
+        }
+    }
+    CHECK(maxError <= 1);
+}
+
+TEST_CASE(forwardTableIsMonotonic) {
+    uint8_t previous = 0;
+    bool monotonic = true;
+    for (uint32_t linear = 0; linear <= 65535; linear++) {
+        const uint8_t encoded = linearToSRGB(static_cast<uint16_t>(linear));
+        monotonic = monotonic && encoded >= previous;
+        previous = encoded;
+    }
+    CHECK(monotonic);
+    CHECK(linearToSRGB(0) == 0);
+    CHECK(linearToSRGB(65535) == 255);
+}
+
+TEST_CASE(inverseTableMatchesPowfAndRoundTrips) {
+    for (uint16_t encoded = 0; encoded < 256; encoded++) {
+        const float exact = decodeSRGB(static_cast<float>(encoded) / 255.0f) * 65535.0f;
+        CHECK_NEAR(sRGBToLinear(static_cast<uint8_t>(encoded)), exact, 1.0);
+        CHECK(linearToSRGB(sRGBToLinear(static_cast<uint8_t>(encoded))) == encoded);
+    }
+}
+
+/**
+ * Informational only: host timings say little about an MCU without an FPU,
+ * where powf() costs far more, but the table must not be slower here either.
+ */
+TEST_CASE(tableIsFasterThanPowf) {
+    const uint32_t rounds = 64;
+    volatile uint32_t sink = 0;
+
+    const std::chrono::steady_clock::time_point tableStart = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t linear = 0; linear <= 65535; linear += 7) {
+            sink = sink + linearToSRGB(static_cast<uint16_t>(linear + round));
+        }
+    }
+    const std::chrono::steady_clock::time_point powfStart = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t linear = 0; linear <= 65535; linear += 7) {
+            const float value = static_cast<float>(static_cast<uint16_t>(linear + round)) / 65535.0f;
+            sink = sink + static_cast<uint32_t>(encodeSRGB(value) * 255.0f + 0.5f);
+        }
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    const double tableNs = std::chrono::duration<double, std::nano>(powfStart - tableStart).count();
+    const double powfNs = std::chrono::duration<double, std::nano>(end - powfStart).count();
+    printf("  linearToSRGB: %.2f ns/call, powf: %.2f ns/call\n",
+           tableNs / (rounds * 9363.0), powfNs / (rounds * 9363.0));
+    CHECK(tableNs < powfNs);
+}
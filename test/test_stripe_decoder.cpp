@@ -0,0 +1,194 @@
+/**
+ * @file test_stripe_decoder.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Replay of recorded stripe codes through the band segmentation
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_StripeDecoder.h"
+
+static const uint32_t SAMPLE_US = 2780;
+
+static const StandardColor R = StandardColor::RED;
+static const StandardColor G = StandardColor::GREEN;
+static const StandardColor B = StandardColor::BLUE;
+static const StandardColor K = StandardColor::BLACK;
+static const StandardColor U = StandardColor::UNKNOWN;
+
+/// Feeds a recording one class per integration; returns the index that completed a sequence, or -1
+static int replay(StripeDecoder &decoder, const StandardColor *symbols, size_t count, uint32_t &timeUs) {
+    int completedAt = -1;
+    for (size_t i = 0; i < count; i++) {
+        if (decoder.updateSymbol(symbols[i], timeUs) && completedAt < 0) {
+            completedAt = static_cast<int>(i);
+        }
+        timeUs += SAMPLE_US;
+    }
+    return completedAt;
+}
+
+TEST_CASE(cleanCodeCompletesAfterBackground) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    const StandardColor code[] = {K, K, R, R, R, G, G, G, B, B, B, K, K, K, K, K, K, K, K};
+    uint32_t timeUs = 1000;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) == 18); // 8th background sample
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    REQUIRE(sequence.length == 3);
+    CHECK(sequence.bands[0].symbol == R);
+    CHECK(sequence.bands[1].symbol == G);
+    CHECK(sequence.bands[2].symbol == B);
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK(sequence.bands[i].samples == 3);
+        CHECK(sequence.bands[i].confidence == 255);
+        CHECK(sequence.bands[i].startUs == 1000 + (2 + 3 * i) * SAMPLE_US);
+        CHECK(sequence.bands[i].durationUs == 2 * SAMPLE_US);
+    }
+    CHECK(!sequence.truncated);
+    CHECK_NEAR(sequence.confidence, 1.0, 0.0);
+    CHECK(sequence.startUs == 1000 + 2 * SAMPLE_US);
+    CHECK(sequence.durationUs == 8 * SAMPLE_US);
+}
+
+TEST_CASE(singleSampleGlitchIsAbsorbed) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    const StandardColor code[] = {R, R, R, G, R, R, R, K, K, K, K, K, K, K, K};
+    uint32_t timeUs = 0;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) == 14);
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    REQUIRE(sequence.length == 1);
+    CHECK(sequence.bands[0].symbol == R);
+    CHECK(sequence.bands[0].samples == 7);
+    CHECK(sequence.bands[0].confidence == 6 * 255 / 7); // the glitch counts against the band
+    CHECK_NEAR(sequence.confidence, (6.0 * 255 / 7) / 255.0, 0.01);
+}
+
+TEST_CASE(shortBandIsDroppedAndNeighboursMerge) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    decoder.setSegmentation(3, 1, 4);
+    // Two green samples are narrower than the 3-sample minimum: dropped, and the red bands around them join
+    const StandardColor code[] = {R, R, R, R, G, G, R, R, R, R, K, K, K, K};
+    uint32_t timeUs = 0;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) == 13);
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    REQUIRE(sequence.length == 1);
+    CHECK(sequence.bands[0].symbol == R);
+    CHECK(sequence.bands[0].samples == 8);
+    CHECK(sequence.bands[0].durationUs == 9 * SAMPLE_US);
+}
+
+TEST_CASE(keptBackgroundSeparatesRepeatedBands) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    decoder.setSegmentation(3, 1, 4);
+    // Three background samples are a band but do not end the sequence: R, gap, R is two bands
+    const StandardColor code[] = {R, R, R, R, K, K, K, R, R, R, R, K, K, K, K};
+    uint32_t timeUs = 0;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) == 14);
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    REQUIRE(sequence.length == 2);
+    CHECK(sequence.bands[0].symbol == R);
+    CHECK(sequence.bands[1].symbol == R);
+    CHECK(sequence.bands[1].startUs == 7 * SAMPLE_US);
+}
+
+TEST_CASE(unknownCountsAsBackground) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    const StandardColor code[] = {B, B, B, U, U, U, U, U, U, U, U};
+    uint32_t timeUs = 0;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) == 10);
+    REQUIRE(decoder.getSequence().length == 1);
+    CHECK(decoder.getSequence().bands[0].symbol == B);
+}
+
+TEST_CASE(flushCompletesWhenThePartLeaves) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    const StandardColor code[] = {R, R, R, G, G, G};
+    uint32_t timeUs = 0;
+
+    CHECK(replay(decoder, code, sizeof(code) / sizeof(code[0]), timeUs) < 0);
+    CHECK(decoder.flush());
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    REQUIRE(sequence.length == 2);
+    CHECK(sequence.bands[0].symbol == R);
+    CHECK(sequence.bands[1].symbol == G);
+    CHECK(!decoder.flush()); // nothing left
+}
+
+TEST_CASE(longCodeIsTruncated) {
+    ADPS9960_ColorSensor sensor;
+    StripeDecoder decoder(sensor);
+    uint32_t timeUs = 0;
+    bool completed = false;
+    for (uint8_t band = 0; band < StripeDecoder::MAX_BANDS + 2; band++) {
+        const StandardColor symbol = (band % 2) ? G : R;
+        const StandardColor pair[] = {symbol, symbol};
+        completed |= replay(decoder, pair, 2, timeUs) >= 0;
+    }
+    CHECK(!completed);
+    CHECK(decoder.flush());
+
+    const StripeDecoder::Sequence &sequence = decoder.getSequence();
+    CHECK(sequence.length == StripeDecoder::MAX_BANDS);
+    CHECK(sequence.truncated);
+}
+
+TEST_CASE(recordedSamplesAreClassifiedAndFiltered) {
+    fake::Sensor &device = fake::bus().sensor();
+    device.ambient = fake::Light{4000, 2000, 2200, 1800};
+    ADPS9960_ColorSensor sensor;
+    REQUIRE(sensor.begin());
+    delay(200);
+    REQUIRE(sensor.calibrate(1, false)); // the white reference classifies the recording
+
+    StripeDecoder decoder(sensor);
+    decoder.setSegmentation(2, 2, 3);
+
+    ADPS9960_ColorSensor::ColorSample red{};
+    red.ambient = 2200;
+    red.red = 1800;
+    red.green = 250;
+    red.blue = 200;
+    red.flags = ADPS9960_ColorSensor::SAMPLE_FRESH;
+    ADPS9960_ColorSensor::ColorSample dark{};
+    dark.ambient = 4;
+    dark.red = 1;
+    dark.green = 1;
+    dark.blue = 1;
+    dark.flags = ADPS9960_ColorSensor::SAMPLE_FRESH;
+    ADPS9960_ColorSensor::ColorSample stale = red;
+    stale.flags = 0;
+    ADPS9960_ColorSensor::ColorSample clipped = dark;
+    clipped.flags |= ADPS9960_ColorSensor::SAMPLE_CLIPPED;
+
+    const ADPS9960_ColorSensor::ColorSample recording[] = {dark, red, red, red, stale, clipped, dark, dark, dark};
+    int completedAt = -1;
+    for (size_t i = 0; i < sizeof(recording) / sizeof(recording[0]); i++) {
+        ADPS9960_ColorSensor::ColorSample sample = recording[i];
+        sample.timestampUs = static_cast<uint32_t>(i * SAMPLE_US);
+        if (decoder.update(sample) && completedAt < 0) {
+            completedAt = static_cast<int>(i);
+        }
+    }
+
+    CHECK(completedAt == 8); // the stale and clipped samples are skipped, not counted as background
+    REQUIRE(decoder.getSequence().length == 1);
+    CHECK(decoder.getSequence().bands[0].symbol == R);
+    CHECK(decoder.getSequence().bands[0].samples == 3);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file test_transfer.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Measurement of fleet transfer targets
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static const fake::Light WHITE = {4000, 2000, 2200, 1800};
+
+/// Calibrates on white, then shows a dark target between two counts
+static void setUpDarkTarget(ADPS9960_ColorSensor &sensor, fake::Sensor &device) {
+    device.ambient = WHITE;
+    REQUIRE(sensor.begin());
+    delay(200);
+    REQUIRE(sensor.calibrate(1, false));
+
+    device.ambient = fake::Light{24.0, 10.5, 6.25, 7.75};
+    device.noiseCounts = 0.6;
+}
+
+TEST_CASE(oversampledTargetsKeepSubCountResolution) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor sensor;
+    setUpDarkTarget(sensor, device);
+    sensor.setOversampling(64);
+
+    ADPS9960_ColorSensor::RGB16 measured{};
+    REQUIRE(sensor.measureTransferTarget(measured, 2));
+
+    const ADPS9960_ColorSensor::CalibrationData &white = sensor.getCalibrationData();
+    const double perCountR = 65535.0 / white.maxRed;
+    const double perCountG = 65535.0 / white.maxGreen;
+    const double perCountB = 65535.0 / white.maxBlue;
+    // Rounding each average to counts would be up to 0.5 count off
+    CHECK_NEAR(measured.r, 10.5 * perCountR, 0.15 * perCountR);
+    CHECK_NEAR(measured.g, 6.25 * perCountG, 0.15 * perCountG);
+    CHECK_NEAR(measured.b, 7.75 * perCountB, 0.15 * perCountB);
+}
+
+TEST_CASE(plainTargetsAverageFreshReadings) {
+    fake::Sensor &device = fake::bus().sensor();
+    ADPS9960_ColorSensor sensor;
+    setUpDarkTarget(sensor, device);
+
+    const uint32_t before = device.getIntegrationCount();
+    ADPS9960_ColorSensor::RGB16 measured{};
+    REQUIRE(sensor.measureTransferTarget(measured, 8));
+    CHECK(device.getIntegrationCount() - before >= 7);
+
+    const double perCountR = 65535.0 / sensor.getCalibrationData().maxRed;
+    CHECK_NEAR(measured.r, 10.5 * perCountR, 0.5 * perCountR);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file test_white_balance.cpp
+ * @author Federico Maniglio
+ * @date 2025-12-05
+ * @brief Replay of a production line under a drifting illuminant through adaptive white balance
+ *
+ * The line alternates white parts and saturated red parts while the lamp
+ * drifts (red +20 %, blue -10 %). Every sample is one fresh integration of
+ * the fake sensor.
+ */
+
+#include "TestHarness.h"
+#include "FakeBus.h"
+#include "APDS9960_ColorSensor.h"
+
+static const int LINE_SAMPLES = 4000;
+static const fake::Light WHITE = {900, 450, 360, 270};
+static const fake::Light RED_PART = {500, 450, 80, 60};
+
+/// White part under the lamp after a share (0-1) of the drift
+static fake::Light driftedWhite(double share) {
+    return fake::Light{WHITE.clear, WHITE.red * (1.0 + 0.2 * share), WHITE.green, WHITE.blue * (1.0 - 0.1 * share)};
+}
+
+static void readScene(ADPS9960_ColorSensor &sensor, const fake::Light &light) {
+    fake::bus().sensor().ambient = light;
+    delay(sensor.getIntegrationTimeUs() / 1000 + 1);
+    ADPS9960_ColorSensor::RawColor raw{};
+    sensor.readRawData(raw);
+}
+
+static void calibrateOnWhite(ADPS9960_ColorSensor &sensor) {
+    fake::bus().sensor().ambient = WHITE;
+    REQUIRE(sensor.begin());
+    REQUIRE(sensor.calibrate(1));
+}
+
+/// Replay the drifting line; returns the largest deviation from neutral of a gray part afterwards
+static double replayLine(ADPS9960_ColorSensor &sensor) {
+    for (int i = 0; i < LINE_SAMPLES; i++) {
+        const double share = static_cast<double>(i) / LINE_SAMPLES;
+        readScene(sensor, (i % 2) ? driftedWhite(share) : RED_PART);
+    }
+
+    // An 80 % gray under the drifted lamp (below white, so nothing clamps)
+    const fake::Light white = driftedWhite(1.0);
+    fake::bus().sensor().ambient = fake::Light{0.8 * white.clear, 0.8 * white.red, 0.8 * white.green, 0.8 * white.blue};
+    delay(sensor.getIntegrationTimeUs() / 1000 + 1);
+    ADPS9960_ColorSensor::RGB16 rgb{};
+    sensor.readRGB16(rgb);
+    const double green = rgb.g;
+    const double redError = fabs(rgb.r - green) / green;
+    const double blueError = fabs(rgb.b - green) / green;
+    return redError > blueError ? redError : blueError;
+}
+
+TEST_CASE(adaptiveWhiteBalanceFollowsTheLampDrift) {
+    ADPS9960_ColorSensor fixed;
+    calibrateOnWhite(fixed);
+    const double fixedError = replayLine(fixed);
+
+    fake::bus().reset();
+    ADPS9960_ColorSensor adaptive;
+    calibrateOnWhite(adaptive);
+    adaptive.enableAdaptiveWhiteBalance(true);
+    const double adaptiveError = replayLine(adaptive);
+
+    printf("  gray off neutral after the drift: %.3f fixed, %.3f adaptive\n", fixedError, adaptiveError);
+    CHECK(fixedError > 0.15);
+    CHECK(adaptiveError < 0.04);
+    CHECK(adaptive.getActiveProfile() == -1);
+}
+
+TEST_CASE(coloredPartsDoNotMoveTheWhitePoint) {
+    ADPS9960_ColorSensor sensor;
+    calibrateOnWhite(sensor);
+    sensor.enableAdaptiveWhiteBalance(true);
+    const ADPS9960_ColorSensor::CalibrationData before = sensor.getCalibrationData();
+
+    for (int i = 0; i < 1000; i++) {
+        readScene(sensor, RED_PART);
+    }
+    const ADPS9960_ColorSensor::CalibrationData &after = sensor.getCalibrationData();
+    CHECK(after.maxRed == before.maxRed);
+    CHECK(after.maxGreen == before.maxGreen);
+    CHECK(after.maxBlue == before.maxBlue);
+    CHECK(after.maxAmbient == before.maxAmbient);
+}
+
+TEST_CASE(frozenWhiteBalanceHoldsTheReference) {
+    ADPS9960_ColorSensor sensor;
+    calibrateOnWhite(sensor);
+    sensor.enableAdaptiveWhiteBalance(true);
+    sensor.freezeWhiteBalance(true);
+    const ADPS9960_ColorSensor::CalibrationData before = sensor.getCalibrationData();
+
+    // A drift small enough to pass as neutral
+    for (int i = 0; i < 1000; i++) {
+        readScene(sensor, driftedWhite(0.3));
+    }
+    CHECK(sensor.getCalibrationData().maxRed == before.maxRed);
+    CHECK(sensor.getCalibrationData().maxBlue == before.maxBlue);
+
+    sensor.freezeWhiteBalance(false);
+    for (int i = 0; i < 1000; i++) {
+        readScene(sensor, driftedWhite(0.3));
+    }
+    CHECK(sensor.getCalibrationData().maxRed > before.maxRed);
+    CHECK(sensor.getCalibrationData().maxBlue < before.maxBlue);
+}